@@ -20,6 +20,7 @@ SOURCES += Collision/Shapes/b2Shape.cpp \
     Common/b2Settings.cpp \
     Common/b2Math.cpp \
     Common/b2BlockAllocator.cpp \
+    Common/b2Timer.cpp \
     Dynamics/Contacts/b2PolyContact.cpp \
     Dynamics/Contacts/b2PolyAndCircleContact.cpp \
     Dynamics/Contacts/b2ContactSolver.cpp \
@@ -50,6 +51,7 @@ HEADERS += Box2D.h \
     Common/b2Settings.h \
     Common/b2Math.h \
     Common/b2BlockAllocator.h \
+    Common/b2Timer.h \
     Dynamics/Contacts/b2PolyContact.h \
     Dynamics/Contacts/b2PolyAndCircleContact.h \
     Dynamics/Contacts/b2NullContact.h \
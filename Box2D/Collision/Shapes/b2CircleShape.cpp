@@ -27,6 +27,11 @@ b2CircleShape::b2CircleShape(const b2ShapeDef* def)
 	m_type = e_circleShape;
 	m_localPosition = circleDef->localPosition;
 	m_radius = circleDef->radius;
+
+	m_localBox.center = m_localPosition;
+	m_localBox.R.SetIdentity();
+	m_localBox.extents.SetZero();
+	m_localBox.radius = m_radius;
 }
 
 void b2CircleShape::UpdateSweepRadius(const b2Vec2& center)
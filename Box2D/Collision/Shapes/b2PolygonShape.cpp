@@ -202,6 +202,11 @@ b2PolygonShape::b2PolygonShape(const b2ShapeDef* def)
 	// Compute the oriented bounding box.
 	ComputeOBB(&m_obb, m_vertices, m_vertexCount);
 
+	m_localBox.center = m_obb.center;
+	m_localBox.R = m_obb.R;
+	m_localBox.extents = m_obb.extents;
+	m_localBox.radius = 0.0f;
+
 	// Create core polygon shape by shifting edges inward.
 	// Also compute the min/max radius for CCD.
 	for (int32 i = 0; i < m_vertexCount; ++i)
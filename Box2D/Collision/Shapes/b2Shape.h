@@ -190,6 +190,9 @@ public:
 	/// Get the coefficient of restitution.
 	float32 GetRestitution() const;
 
+	/// Get the bounding box in body coordinates, used by b2ComputeSweptAABBs.
+	const b2LocalBox& GetLocalBox() const;
+
 protected:
 
 	friend class b2Body;
@@ -215,6 +218,9 @@ protected:
 	// Sweep radius relative to the parent body's center of mass.
 	float32 m_sweepRadius;
 
+	// Local bounds, set up by the derived shape.
+	b2LocalBox m_localBox;
+
 	float32 m_density;
 	float32 m_friction;
 	float32 m_restitution;
@@ -267,6 +273,11 @@ inline b2Shape* b2Shape::GetNext()
 	return m_next;
 }
 
+inline const b2LocalBox& b2Shape::GetLocalBox() const
+{
+	return m_localBox;
+}
+
 inline float32 b2Shape::GetSweepRadius() const
 {
 	return m_sweepRadius;
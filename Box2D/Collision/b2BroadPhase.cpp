@@ -40,6 +40,11 @@ struct b2BoundValues
 	uint16 upperValues[2];
 };
 
+static bool BoundLess(const b2Bound& b1, const b2Bound& b2)
+{
+	return b1.value < b2.value;
+}
+
 static int32 BinarySearch(b2Bound* bounds, int32 count, uint16 value)
 {
 	int32 low = 0;
@@ -321,6 +326,145 @@ uint16 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
 	return proxyId;
 }
 
+void b2BroadPhase::CreateProxies(const b2AABB* aabbs, void** userData, int32 count, uint16* proxyIds)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	b2Assert(0 < count && m_proxyCount + count <= b2_maxProxies);
+
+	bool added[b2_maxProxies];
+	memset(added, 0, sizeof(added));
+
+	int32 newCount = 2 * count;
+	b2Bound* newBounds = (b2Bound*)b2Alloc(newCount * sizeof(b2Bound));
+	uint16* values = (uint16*)b2Alloc(4 * count * sizeof(uint16));
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Assert(m_freeProxy != b2_nullProxy);
+
+		uint16 proxyId = m_freeProxy;
+		b2Proxy* proxy = m_proxyPool + proxyId;
+		m_freeProxy = proxy->GetNext();
+
+		proxy->overlapCount = 0;
+		proxy->userData = userData[i];
+
+		added[proxyId] = true;
+		proxyIds[i] = proxyId;
+
+		// Lower values in [0, 1], upper values in [2, 3].
+		ComputeBounds(values + 4 * i, values + 4 * i + 2, aabbs[i]);
+	}
+
+	int32 boundCount = 2 * m_proxyCount;
+	int32 totalCount = boundCount + newCount;
+
+	for (int32 axis = 0; axis < 2; ++axis)
+	{
+		b2Bound* bounds = m_bounds[axis];
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			b2Bound& lower = newBounds[2 * i];
+			lower.value = values[4 * i + axis];
+			lower.proxyId = proxyIds[i];
+
+			b2Bound& upper = newBounds[2 * i + 1];
+			upper.value = values[4 * i + 2 + axis];
+			upper.proxyId = proxyIds[i];
+		}
+
+		std::sort(newBounds, newBounds + newCount, BoundLess);
+
+		// Merge from the back so the existing bounds are moved only once.
+		int32 i = boundCount - 1;
+		int32 j = newCount - 1;
+		int32 k = totalCount - 1;
+		while (j >= 0)
+		{
+			if (i >= 0 && bounds[i].value > newBounds[j].value)
+			{
+				bounds[k--] = bounds[i--];
+			}
+			else
+			{
+				bounds[k--] = newBounds[j--];
+			}
+		}
+
+		// Recompute the stabbing counts and the bound indices.
+		int32 open = 0;
+		for (int32 index = 0; index < totalCount; ++index)
+		{
+			b2Bound& bound = bounds[index];
+			b2Proxy* proxy = m_proxyPool + bound.proxyId;
+
+			if (bound.IsLower())
+			{
+				++open;
+				proxy->lowerBounds[axis] = (uint16)index;
+			}
+			else
+			{
+				--open;
+				proxy->upperBounds[axis] = (uint16)index;
+			}
+
+			bound.stabbingCount = (uint16)open;
+		}
+
+		b2Assert(open == 0);
+	}
+
+	m_proxyCount += count;
+
+	// Query for the new pairs. Each query also finds the proxy itself, pairs
+	// within the batch are added once.
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 proxyId = proxyIds[i];
+
+		for (int32 axis = 0; axis < 2; ++axis)
+		{
+			int32 lowerIndex, upperIndex;
+			Query(&lowerIndex, &upperIndex, values[4 * i + axis], values[4 * i + 2 + axis],
+				m_bounds[axis], totalCount, axis);
+		}
+
+		b2Assert(m_queryResultCount < b2_maxProxies);
+
+		for (int32 j = 0; j < m_queryResultCount; ++j)
+		{
+			int32 otherId = m_queryResults[j];
+			b2Assert(m_proxyPool[otherId].IsValid());
+
+			if (otherId == proxyId || (added[otherId] && otherId < proxyId))
+			{
+				continue;
+			}
+
+			m_pairManager.AddBufferedPair(proxyId, otherId);
+		}
+
+		m_queryResultCount = 0;
+		IncrementTimeStamp();
+	}
+
+	m_pairManager.Commit();
+
+	b2Free(values);
+	b2Free(newBounds);
+
+	if (s_validate)
+	{
+		Validate();
+	}
+}
+
 void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
 	b2Assert(0 < m_proxyCount && m_proxyCount <= b2_maxProxies);
@@ -397,6 +541,124 @@ void b2BroadPhase::DestroyProxy(int32 proxyId)
 	}
 }
 
+void b2BroadPhase::DestroyProxies(const uint16* proxyIds, int32 count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	b2Assert(0 < count && count <= m_proxyCount);
+
+	bool removed[b2_maxProxies];
+	memset(removed, 0, sizeof(removed));
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Assert(m_proxyPool[proxyIds[i]].IsValid());
+		removed[proxyIds[i]] = true;
+	}
+
+	int32 boundCount = 2 * m_proxyCount;
+
+	// Query for pairs to be removed while the bounds are still intact. Each
+	// query also finds the proxy itself, pairs within the batch are removed
+	// once.
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 proxyId = proxyIds[i];
+		b2Proxy* proxy = m_proxyPool + proxyId;
+
+		for (int32 axis = 0; axis < 2; ++axis)
+		{
+			b2Bound* bounds = m_bounds[axis];
+			int32 lowerIndex, upperIndex;
+			Query(&lowerIndex, &upperIndex, bounds[proxy->lowerBounds[axis]].value,
+				bounds[proxy->upperBounds[axis]].value, bounds, boundCount, axis);
+		}
+
+		b2Assert(m_queryResultCount < b2_maxProxies);
+
+		for (int32 j = 0; j < m_queryResultCount; ++j)
+		{
+			int32 otherId = m_queryResults[j];
+			b2Assert(m_proxyPool[otherId].IsValid());
+
+			if (otherId == proxyId || (removed[otherId] && otherId < proxyId))
+			{
+				continue;
+			}
+
+			m_pairManager.RemoveBufferedPair(proxyId, otherId);
+		}
+
+		m_queryResultCount = 0;
+		IncrementTimeStamp();
+	}
+
+	m_pairManager.Commit();
+
+	// Compact the bound arrays. A removed proxy stabbed every bound between
+	// its lower and upper bound.
+	for (int32 axis = 0; axis < 2; ++axis)
+	{
+		b2Bound* bounds = m_bounds[axis];
+		int32 open = 0;
+		int32 index = 0;
+
+		for (int32 i = 0; i < boundCount; ++i)
+		{
+			const b2Bound& bound = bounds[i];
+
+			if (removed[bound.proxyId])
+			{
+				open += bound.IsLower() ? 1 : -1;
+				continue;
+			}
+
+			bounds[index] = bound;
+			bounds[index].stabbingCount = (uint16)(bound.stabbingCount - open);
+
+			b2Proxy* proxy = m_proxyPool + bound.proxyId;
+			if (bound.IsLower())
+			{
+				proxy->lowerBounds[axis] = (uint16)index;
+			}
+			else
+			{
+				proxy->upperBounds[axis] = (uint16)index;
+			}
+
+			++index;
+		}
+
+		b2Assert(open == 0);
+		b2Assert(index == boundCount - 2 * count);
+	}
+
+	// Return the proxies to the pool.
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Proxy* proxy = m_proxyPool + proxyIds[i];
+
+		proxy->userData = NULL;
+		proxy->overlapCount = b2_invalid;
+		proxy->lowerBounds[0] = b2_invalid;
+		proxy->lowerBounds[1] = b2_invalid;
+		proxy->upperBounds[0] = b2_invalid;
+		proxy->upperBounds[1] = b2_invalid;
+
+		proxy->SetNext(m_freeProxy);
+		m_freeProxy = proxyIds[i];
+		--m_proxyCount;
+	}
+
+	if (s_validate)
+	{
+		Validate();
+	}
+}
+
 void b2BroadPhase::MoveProxy(int32 proxyId, const b2AABB& aabb)
 {
 	if (proxyId == b2_nullProxy || b2_maxProxies <= proxyId)
@@ -79,6 +79,15 @@ public:
 	uint16 CreateProxy(const b2AABB& aabb, void* userData);
 	void DestroyProxy(int32 proxyId);
 
+	// Destroy many proxies at once. The bound arrays are compacted in a
+	// single pass instead of once per proxy.
+	void DestroyProxies(const uint16* proxyIds, int32 count);
+
+	// Create many proxies at once. The new bounds are sorted and merged into
+	// the bound arrays in a single pass instead of being inserted one by one.
+	// The new proxy ids are written to proxyIds.
+	void CreateProxies(const b2AABB* aabbs, void** userData, int32 count, uint16* proxyIds);
+
 	// Call MoveProxy as many times as you like, then when you are done
 	// call Commit to finalized the proxy pairs (for your time step).
 	void MoveProxy(int32 proxyId, const b2AABB& aabb);
@@ -113,17 +113,21 @@ void b2CollidePolygons(b2Manifold* manifold,
 					   const b2PolygonShape* polygon2, const b2XForm& xf2);
 
 /// Compute the distance between two shapes and the closest points.
+/// @param iterations if not NULL, the GJK iterations used are added to it.
 /// @return the distance between the shapes or zero if they are overlapped/touching.
 float32 b2Distance(b2Vec2* x1, b2Vec2* x2,
 				   const b2Shape* shape1, const b2XForm& xf1,
-				   const b2Shape* shape2, const b2XForm& xf2);
+				   const b2Shape* shape2, const b2XForm& xf2,
+				   int32* iterations = NULL);
 
 /// Compute the time when two shapes begin to touch or touch at a closer distance.
 /// @warning the sweeps must have the same time interval.
 /// @return the fraction between [0,1] in which the shapes first touch.
 /// fraction=0 means the shapes begin touching/overlapped, and fraction=1 means the shapes don't touch.
+/// @param iterations if not NULL, the GJK iterations of all distance queries are added to it.
 float32 b2TimeOfImpact(const b2Shape* shape1, const b2Sweep& sweep1,
-					   const b2Shape* shape2, const b2Sweep& sweep2);
+					   const b2Shape* shape2, const b2Sweep& sweep2,
+					   int32* iterations = NULL);
 
 
 // ---------------- Inline Functions ------------------------------------------
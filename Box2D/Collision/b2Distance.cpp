@@ -166,7 +166,8 @@ static bool InPoints(const b2Vec2& w, const b2Vec2* points, int32 pointCount)
 template <typename T1, typename T2>
 float32 DistanceGeneric(b2Vec2* x1, b2Vec2* x2,
 				   const T1* shape1, const b2XForm& xf1,
-				   const T2* shape2, const b2XForm& xf2)
+				   const T2* shape2, const b2XForm& xf2,
+				   int32* iterations)
 {
 	b2Vec2 p1s[3], p2s[3];
 	b2Vec2 points[3];
@@ -194,6 +195,10 @@ float32 DistanceGeneric(b2Vec2* x1, b2Vec2* x2,
 				*x2 = w2;
 			}
 			g_GJK_Iterations = iter;
+			if (iterations)
+			{
+				*iterations += iter;
+			}
 			return b2Sqrt(vSqr);
 		}
 
@@ -227,6 +232,10 @@ float32 DistanceGeneric(b2Vec2* x1, b2Vec2* x2,
 		if (pointCount == 3)
 		{
 			g_GJK_Iterations = iter;
+			if (iterations)
+			{
+				*iterations += iter;
+			}
 			return 0.0f;
 		}
 
@@ -243,6 +252,10 @@ float32 DistanceGeneric(b2Vec2* x1, b2Vec2* x2,
 #endif
 		{
 			g_GJK_Iterations = iter;
+			if (iterations)
+			{
+				*iterations += iter;
+			}
 			v = *x2 - *x1;
 			vSqr = b2Dot(v, v);
 			return b2Sqrt(vSqr);
@@ -250,6 +263,10 @@ float32 DistanceGeneric(b2Vec2* x1, b2Vec2* x2,
 	}
 
 	g_GJK_Iterations = maxIterations;
+	if (iterations)
+	{
+		*iterations += maxIterations;
+	}
 	return b2Sqrt(vSqr);
 }
 
@@ -308,12 +325,13 @@ struct Point
 static float32 DistancePC(
 	b2Vec2* x1, b2Vec2* x2,
 	const b2PolygonShape* polygon, const b2XForm& xf1,
-	const b2CircleShape* circle, const b2XForm& xf2)
+	const b2CircleShape* circle, const b2XForm& xf2,
+	int32* iterations)
 {
 	Point point;
 	point.p = b2Mul(xf2, circle->GetLocalPosition());
 
-	float32 distance = DistanceGeneric(x1, x2, polygon, xf1, &point, b2XForm_identity);
+	float32 distance = DistanceGeneric(x1, x2, polygon, xf1, &point, b2XForm_identity, iterations);
 
 	float32 r = circle->GetRadius() - b2_toiSlop;
 
@@ -335,7 +353,8 @@ static float32 DistancePC(
 
 float32 b2Distance(b2Vec2* x1, b2Vec2* x2,
 				   const b2Shape* shape1, const b2XForm& xf1,
-				   const b2Shape* shape2, const b2XForm& xf2)
+				   const b2Shape* shape2, const b2XForm& xf2,
+				   int32* iterations)
 {
 	b2ShapeType type1 = shape1->GetType();
 	b2ShapeType type2 = shape2->GetType();
@@ -347,17 +366,17 @@ float32 b2Distance(b2Vec2* x1, b2Vec2* x2,
 	
 	if (type1 == e_polygonShape && type2 == e_circleShape)
 	{
-		return DistancePC(x1, x2, (b2PolygonShape*)shape1, xf1, (b2CircleShape*)shape2, xf2);
+		return DistancePC(x1, x2, (b2PolygonShape*)shape1, xf1, (b2CircleShape*)shape2, xf2, iterations);
 	}
 
 	if (type1 == e_circleShape && type2 == e_polygonShape)
 	{
-		return DistancePC(x2, x1, (b2PolygonShape*)shape2, xf2, (b2CircleShape*)shape1, xf1);
+		return DistancePC(x2, x1, (b2PolygonShape*)shape2, xf2, (b2CircleShape*)shape1, xf1, iterations);
 	}
 
 	if (type1 == e_polygonShape && type2 == e_polygonShape)
 	{
-		return DistanceGeneric(x1, x2, (b2PolygonShape*)shape1, xf1, (b2PolygonShape*)shape2, xf2);
+		return DistanceGeneric(x1, x2, (b2PolygonShape*)shape1, xf1, (b2PolygonShape*)shape2, xf2, iterations);
 	}
 
 	return 0.0f;
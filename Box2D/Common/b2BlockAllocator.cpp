@@ -40,7 +40,35 @@ int32 b2BlockAllocator::s_blockSizes[b2_blockSizes] =
 	640,	// 13
 };
 uint8 b2BlockAllocator::s_blockSizeLookup[b2_maxBlockSize + 1];
-bool b2BlockAllocator::s_blockSizeLookupInitialized;
+
+// Fills s_blockSizeLookup during static initialization, before any thread
+// can construct an allocator.
+struct b2BlockSizeLookupInit
+{
+	b2BlockSizeLookupInit()
+	{
+		uint8* lookup = b2BlockAllocator::s_blockSizeLookup;
+		const int32* blockSizes = b2BlockAllocator::s_blockSizes;
+
+		int32 j = 0;
+		lookup[0] = 0;
+		for (int32 i = 1; i <= b2_maxBlockSize; ++i)
+		{
+			b2Assert(j < b2_blockSizes);
+			if (i <= blockSizes[j])
+			{
+				lookup[i] = (uint8)j;
+			}
+			else
+			{
+				++j;
+				lookup[i] = (uint8)j;
+			}
+		}
+	}
+};
+
+static b2BlockSizeLookupInit s_blockSizeLookupInit;
 
 struct b2Chunk
 {
@@ -64,25 +92,8 @@ b2BlockAllocator::b2BlockAllocator()
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
 
-	if (s_blockSizeLookupInitialized == false)
-	{
-		int32 j = 0;
-		for (int32 i = 1; i <= b2_maxBlockSize; ++i)
-		{
-			b2Assert(j < b2_blockSizes);
-			if (i <= s_blockSizes[j])
-			{
-				s_blockSizeLookup[i] = (uint8)j;
-			}
-			else
-			{
-				++j;
-				s_blockSizeLookup[i] = (uint8)j;
-			}
-		}
-
-		s_blockSizeLookupInitialized = true;
-	}
+	memset(m_chunkCounts, 0, sizeof(m_chunkCounts));
+	memset(m_freeCounts, 0, sizeof(m_freeCounts));
 }
 
 b2BlockAllocator::~b2BlockAllocator()
@@ -109,6 +120,7 @@ void* b2BlockAllocator::Allocate(int32 size)
 	{
 		b2Block* block = m_freeLists[index];
 		m_freeLists[index] = block->next;
+		--m_freeCounts[index];
 		return block;
 	}
 	else
@@ -144,6 +156,9 @@ void* b2BlockAllocator::Allocate(int32 size)
 		m_freeLists[index] = chunk->blocks->next;
 		++m_chunkCount;
 
+		++m_chunkCounts[index];
+		m_freeCounts[index] += blockCount - 1;
+
 		return chunk->blocks;
 	}
 }
@@ -190,6 +205,7 @@ void b2BlockAllocator::Free(void* p, int32 size)
 	b2Block* block = (b2Block*)p;
 	block->next = m_freeLists[index];
 	m_freeLists[index] = block;
+	++m_freeCounts[index];
 }
 
 void b2BlockAllocator::Clear()
@@ -203,4 +219,34 @@ void b2BlockAllocator::Clear()
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 
 	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_chunkCounts, 0, sizeof(m_chunkCounts));
+	memset(m_freeCounts, 0, sizeof(m_freeCounts));
+}
+
+void b2BlockAllocator::GetStats(b2BlockAllocatorStats* stats) const
+{
+	stats->chunkBytes = m_chunkCount * b2_chunkSize;
+	stats->usedBytes = 0;
+
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		int32 blockSize = s_blockSizes[i];
+		int32 blockCount = m_chunkCounts[i] * (b2_chunkSize / blockSize);
+
+		stats->blockSize[i] = blockSize;
+		stats->chunkCount[i] = m_chunkCounts[i];
+		stats->usedBlocks[i] = blockCount - m_freeCounts[i];
+		stats->freeBlocks[i] = m_freeCounts[i];
+
+		stats->usedBytes += stats->usedBlocks[i] * blockSize;
+	}
+
+	if (stats->chunkBytes > 0)
+	{
+		stats->fragmentation = 1.0f - float32(stats->usedBytes) / float32(stats->chunkBytes);
+	}
+	else
+	{
+		stats->fragmentation = 0.0f;
+	}
 }
@@ -28,10 +28,28 @@ const int32 b2_chunkArrayIncrement = 128;
 
 struct b2Block;
 struct b2Chunk;
+struct b2BlockSizeLookupInit;
+
+/// Memory usage of a block allocator, per size class and in total.
+struct b2BlockAllocatorStats
+{
+	int32 blockSize[b2_blockSizes];		///< size of the blocks of each class
+	int32 chunkCount[b2_blockSizes];	///< chunks carved into blocks of each class
+	int32 usedBlocks[b2_blockSizes];	///< blocks handed out
+	int32 freeBlocks[b2_blockSizes];	///< blocks on the free lists
+
+	int32 chunkBytes;					///< total chunk memory
+	int32 usedBytes;					///< memory in blocks handed out
+
+	/// Share of the chunk memory not handed out (free blocks and chunk tails), 0..1
+	float32 fragmentation;
+};
 
 // This is a small object allocator used for allocating small
 // objects that persist for more than one time step.
 // See: http://www.codeproject.com/useritems/Small_Block_Allocator.asp
+//
+// An allocator is not locked, it must only be used by one thread at a time.
 class b2BlockAllocator
 {
 public:
@@ -41,19 +59,27 @@ public:
 	void* Allocate(int32 size);
 	void Free(void* p, int32 size);
 
+	/// Release all chunks.
 	void Clear();
 
+	/// Get the memory usage of this allocator.
+	void GetStats(b2BlockAllocatorStats* stats) const;
+
 private:
 
+	friend struct b2BlockSizeLookupInit;
+
 	b2Chunk* m_chunks;
 	int32 m_chunkCount;
 	int32 m_chunkSpace;
 
 	b2Block* m_freeLists[b2_blockSizes];
 
+	int32 m_chunkCounts[b2_blockSizes];
+	int32 m_freeCounts[b2_blockSizes];
+
 	static int32 s_blockSizes[b2_blockSizes];
 	static uint8 s_blockSizeLookup[b2_maxBlockSize + 1];
-	static bool s_blockSizeLookupInitialized;
 };
 
 #endif
@@ -18,6 +18,10 @@
 
 #include "b2Math.h"
 
+#ifdef B2_USE_SSE
+#include <xmmintrin.h>
+#endif
+
 const b2Vec2 b2Vec2_zero(0.0f, 0.0f);
 const b2Mat22 b2Mat22_identity(1.0f, 0.0f, 0.0f, 1.0f);
 const b2XForm b2XForm_identity(b2Vec2_zero, b2Mat22_identity);
@@ -52,3 +56,99 @@ void b2Sweep::Advance(float32 t)
 		t0 = t;
 	}
 }
+
+void b2MulBatch(const b2XForm& T, const b2Vec2* v, b2Vec2* out, int32 count)
+{
+	int32 i = 0;
+
+#ifdef B2_USE_SSE
+	// Two points per register: [x0 y0 x1 y1]
+	__m128 p = _mm_setr_ps(T.position.x, T.position.y, T.position.x, T.position.y);
+	__m128 c1 = _mm_setr_ps(T.R.col1.x, T.R.col1.y, T.R.col1.x, T.R.col1.y);
+	__m128 c2 = _mm_setr_ps(T.R.col2.x, T.R.col2.y, T.R.col2.x, T.R.col2.y);
+
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128 xy = _mm_loadu_ps(&v[i].x);
+		__m128 xx = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(2, 2, 0, 0));
+		__m128 yy = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(3, 3, 1, 1));
+		__m128 r = _mm_add_ps(p, _mm_add_ps(_mm_mul_ps(c1, xx), _mm_mul_ps(c2, yy)));
+		_mm_storeu_ps(&out[i].x, r);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		out[i] = b2Mul(T, v[i]);
+	}
+}
+
+#ifdef B2_USE_SSE
+
+static inline __m128 b2LoadPair(const b2Vec2& a, const b2Vec2& b)
+{
+	__m128 r = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&a.x);
+	return _mm_loadh_pi(r, (const __m64*)&b.x);
+}
+
+void b2ComputeSweptAABBs(const b2LocalBox* boxes, const b2XForm* xf1, const b2XForm* xf2,
+						 b2Vec2* lower, b2Vec2* upper, int32 count)
+{
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		const b2LocalBox& box = boxes[i];
+
+		// Both transforms side by side: [xf1 | xf2]
+		__m128 p = b2LoadPair(xf1[i].position, xf2[i].position);
+		__m128 r1 = b2LoadPair(xf1[i].R.col1, xf2[i].R.col1);
+		__m128 r2 = b2LoadPair(xf1[i].R.col2, xf2[i].R.col2);
+
+		// World box axes, M = xf.R * box.R
+		__m128 m1 = _mm_add_ps(_mm_mul_ps(r1, _mm_set1_ps(box.R.col1.x)), _mm_mul_ps(r2, _mm_set1_ps(box.R.col1.y)));
+		__m128 m2 = _mm_add_ps(_mm_mul_ps(r1, _mm_set1_ps(box.R.col2.x)), _mm_mul_ps(r2, _mm_set1_ps(box.R.col2.y)));
+
+		// Half-widths, h = |M| * extents + radius
+		__m128 h = _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, m1), _mm_set1_ps(box.extents.x)),
+							  _mm_mul_ps(_mm_andnot_ps(signMask, m2), _mm_set1_ps(box.extents.y)));
+		h = _mm_add_ps(h, _mm_set1_ps(box.radius));
+
+		// Center, c = xf.position + xf.R * box.center
+		__m128 c = _mm_add_ps(p, _mm_add_ps(_mm_mul_ps(r1, _mm_set1_ps(box.center.x)), _mm_mul_ps(r2, _mm_set1_ps(box.center.y))));
+
+		// Merge the two halves
+		__m128 lo = _mm_sub_ps(c, h);
+		__m128 hi = _mm_add_ps(c, h);
+		lo = _mm_min_ps(lo, _mm_movehl_ps(lo, lo));
+		hi = _mm_max_ps(hi, _mm_movehl_ps(hi, hi));
+
+		_mm_storel_pi((__m64*)&lower[i].x, lo);
+		_mm_storel_pi((__m64*)&upper[i].x, hi);
+	}
+}
+
+#else
+
+void b2ComputeSweptAABBs(const b2LocalBox* boxes, const b2XForm* xf1, const b2XForm* xf2,
+						 b2Vec2* lower, b2Vec2* upper, int32 count)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		const b2LocalBox& box = boxes[i];
+		b2Vec2 r(box.radius, box.radius);
+
+		b2Mat22 R1 = b2Mul(xf1[i].R, box.R);
+		b2Vec2 h1 = b2Mul(b2Abs(R1), box.extents) + r;
+		b2Vec2 c1 = xf1[i].position + b2Mul(xf1[i].R, box.center);
+
+		b2Mat22 R2 = b2Mul(xf2[i].R, box.R);
+		b2Vec2 h2 = b2Mul(b2Abs(R2), box.extents) + r;
+		b2Vec2 c2 = xf2[i].position + b2Mul(xf2[i].R, box.center);
+
+		lower[i] = b2Min(c1 - h1, c2 - h2);
+		upper[i] = b2Max(c1 + h1, c2 + h2);
+	}
+}
+
+#endif
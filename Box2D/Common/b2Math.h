@@ -633,4 +633,22 @@ inline bool b2IsPowerOfTwo(uint32 x)
 	return result;
 }
 
+/// An oriented box in body coordinates, grown by a radius. This is the bounding
+/// volume the batched kernels work on. A circle is a box with zero extents.
+struct b2LocalBox
+{
+	b2Vec2 center;		///< box center
+	b2Mat22 R;			///< box orientation
+	b2Vec2 extents;		///< half-widths along the box axes
+	float32 radius;		///< added to the extents in every direction
+};
+
+/// Transform a set of points, out[i] = b2Mul(T, v[i]). The arrays may alias.
+void b2MulBatch(const b2XForm& T, const b2Vec2* v, b2Vec2* out, int32 count);
+
+/// Compute the world AABB of each box swept from xf1[i] to xf2[i]. This gives
+/// the same bounds as b2Shape::ComputeSweptAABB, for many shapes at once.
+void b2ComputeSweptAABBs(const b2LocalBox* boxes, const b2XForm* xf1, const b2XForm* xf2,
+						 b2Vec2* lower, b2Vec2* upper, int32 count);
+
 #endif
@@ -64,6 +64,13 @@ typedef float float32;
 
 #endif
 
+/// The batched kernels in b2Math use SSE when the compiler targets it and
+/// float32 is a float. Define B2_NO_SIMD to force the scalar code.
+#if !defined(TARGET_FLOAT32_IS_FIXED) && !defined(B2_NO_SIMD) && \
+	(defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define B2_USE_SSE
+#endif
+
 const float32 b2_pi = 3.14159265359f;
 
 /// @file
@@ -73,7 +80,7 @@ const float32 b2_pi = 3.14159265359f;
 // Collision
 const int32 b2_maxManifoldPoints = 2;
 const int32 b2_maxPolygonVertices = 8;
-const int32 b2_maxProxies = 512;				// this must be a power of two
+const int32 b2_maxProxies = 4096;				// this must be a power of two, at most 4096 (uint16 pair ids)
 const int32 b2_maxPairs = 8 * b2_maxProxies;	// this must be a power of two
 
 // Dynamics
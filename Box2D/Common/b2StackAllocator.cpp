@@ -18,39 +18,96 @@
 
 #include "b2StackAllocator.h"
 #include "b2Math.h"
+#include <string.h>
 
 b2StackAllocator::b2StackAllocator()
 {
-	m_index = 0;
+	m_segmentCount = 0;
+	m_segment = 0;
 	m_allocation = 0;
 	m_maxAllocation = 0;
+	m_growCount = 0;
+
+	m_entryCapacity = b2_maxStackEntries;
+	m_entries = (b2StackEntry*)b2Alloc(m_entryCapacity * sizeof(b2StackEntry));
 	m_entryCount = 0;
+
+	AddSegment(b2_stackSize);
 }
 
 b2StackAllocator::~b2StackAllocator()
 {
-	b2Assert(m_index == 0);
+	b2Assert(m_allocation == 0);
 	b2Assert(m_entryCount == 0);
+
+	for (int32 i = 0; i < m_segmentCount; ++i)
+	{
+		b2Free(m_segments[i].data);
+	}
+
+	b2Free(m_entries);
 }
 
 void* b2StackAllocator::Allocate(int32 size)
 {
-	b2Assert(m_entryCount < b2_maxStackEntries);
-
-	b2StackEntry* entry = m_entries + m_entryCount;
-	entry->size = size;
-	if (m_index + size > b2_stackSize)
+	if (m_entryCount == m_entryCapacity)
 	{
-		entry->data = (char*)b2Alloc(size);
-		entry->usedMalloc = true;
+		b2StackEntry* oldEntries = m_entries;
+		m_entryCapacity *= 2;
+		m_entries = (b2StackEntry*)b2Alloc(m_entryCapacity * sizeof(b2StackEntry));
+		memcpy(m_entries, oldEntries, m_entryCount * sizeof(b2StackEntry));
+		b2Free(oldEntries);
 	}
-	else
+
+	b2StackSegment* segment = m_segments + m_segment;
+	if (segment->index + size > segment->size)
 	{
-		entry->data = m_data + m_index;
-		entry->usedMalloc = false;
-		m_index += size;
+		// Move on to the next segment. Segments past the current one are
+		// always empty, so a segment that is too small can be replaced.
+		++m_segment;
+		while (m_segment < m_segmentCount && m_segments[m_segment].size < size)
+		{
+			b2Free(m_segments[m_segment].data);
+			--m_segmentCount;
+			for (int32 i = m_segment; i < m_segmentCount; ++i)
+			{
+				m_segments[i] = m_segments[i + 1];
+			}
+		}
+
+		if (m_segment == b2_maxStackSegments)
+		{
+			// The segment table is full, this block bypasses the segments.
+			--m_segment;
+			++m_growCount;
+
+			b2StackEntry* entry = m_entries + m_entryCount;
+			entry->data = (char*)b2Alloc(size);
+			entry->size = size;
+			entry->segment = -1;
+
+			m_allocation += size;
+			m_maxAllocation = b2Max(m_maxAllocation, m_allocation);
+			++m_entryCount;
+
+			return entry->data;
+		}
+
+		if (m_segment == m_segmentCount)
+		{
+			AddSegment(b2Max(size, 2 * segment->size));
+			++m_growCount;
+		}
+
+		segment = m_segments + m_segment;
 	}
 
+	b2StackEntry* entry = m_entries + m_entryCount;
+	entry->data = segment->data + segment->index;
+	entry->size = size;
+	entry->segment = m_segment;
+	segment->index += size;
+
 	m_allocation += size;
 	m_maxAllocation = b2Max(m_maxAllocation, m_allocation);
 	++m_entryCount;
@@ -63,21 +120,63 @@ void b2StackAllocator::Free(void* p)
 	b2Assert(m_entryCount > 0);
 	b2StackEntry* entry = m_entries + m_entryCount - 1;
 	b2Assert(p == entry->data);
-	if (entry->usedMalloc)
+
+	if (entry->segment == -1)
 	{
-		b2Free(p);
+		b2Free(entry->data);
 	}
 	else
 	{
-		m_index -= entry->size;
+		m_segments[entry->segment].index -= entry->size;
+		m_segment = entry->segment;
 	}
+
 	m_allocation -= entry->size;
 	--m_entryCount;
 
+	// Nothing is allocated, merge the segments while it's cheap.
+	if (m_entryCount == 0 && m_segmentCount > 1)
+	{
+		Compact();
+	}
+
 	p = NULL;
 }
 
-int32 b2StackAllocator::GetMaxAllocation() const
+int32 b2StackAllocator::GetCapacity() const
+{
+	int32 capacity = 0;
+	for (int32 i = 0; i < m_segmentCount; ++i)
+	{
+		capacity += m_segments[i].size;
+	}
+	return capacity;
+}
+
+void b2StackAllocator::AddSegment(int32 size)
 {
-	return m_maxAllocation;
+	b2Assert(m_segmentCount < b2_maxStackSegments);
+
+	b2StackSegment* segment = m_segments + m_segmentCount;
+	segment->data = (char*)b2Alloc(size);
+	segment->size = size;
+	segment->index = 0;
+	++m_segmentCount;
+}
+
+void b2StackAllocator::Compact()
+{
+	b2Assert(m_allocation == 0);
+
+	for (int32 i = 0; i < m_segmentCount; ++i)
+	{
+		b2Free(m_segments[i].data);
+	}
+
+	m_segmentCount = 0;
+	m_segment = 0;
+
+	// The high-water mark fits a single segment of that size, leave some
+	// room so a slowly growing world doesn't grow the stack every step.
+	AddSegment(b2Max(m_maxAllocation + m_maxAllocation / 4, b2_stackSize));
 }
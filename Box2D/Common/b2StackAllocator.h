@@ -21,19 +21,36 @@
 
 #include "b2Settings.h"
 
-const int32 b2_stackSize = 100 * 1024;	// 100k
-const int32 b2_maxStackEntries = 32;
+const int32 b2_stackSize = 100 * 1024;	// 100k, size of the first segment
+const int32 b2_maxStackEntries = 32;	// initial entry capacity, grows as needed
+const int32 b2_maxStackSegments = 16;	// each segment is at least twice the size of the previous one
 
 struct b2StackEntry
 {
 	char* data;
 	int32 size;
-	bool usedMalloc;
+	int32 segment;	// -1 if the block came straight from b2Alloc
+};
+
+struct b2StackSegment
+{
+	char* data;
+	int32 size;
+	int32 index;
 };
 
 // This is a stack allocator used for fast per step allocations.
 // You must nest allocate/free pairs. The code will assert
 // if you try to interleave multiple allocate/free pairs.
+//
+// Memory comes from a list of segments. When the current segment is full
+// a larger one is added, and once the stack is empty again all segments are
+// merged into a single one sized to the high-water mark (plus some slack). After a few steps
+// the allocator stops calling b2Alloc altogether. If all b2_maxStackSegments
+// are in use, further blocks come from b2Alloc until the stack empties again.
+//
+// An allocator has no shared state, so it is safe to use one per thread
+// (e.g. one per solver thread), but never one from several threads at once.
 class b2StackAllocator
 {
 public:
@@ -43,18 +60,42 @@ public:
 	void* Allocate(int32 size);
 	void Free(void* p);
 
+	/// Get the largest number of bytes allocated at the same time.
 	int32 GetMaxAllocation() const;
 
+	/// Get the number of bytes held by all segments.
+	int32 GetCapacity() const;
+
+	/// Get the number of times the allocator ran out of room and had
+	/// to call b2Alloc for a new segment or a block.
+	int32 GetGrowCount() const;
+
 private:
 
-	char m_data[b2_stackSize];
-	int32 m_index;
+	void AddSegment(int32 size);
+	void Compact();
+
+	b2StackSegment m_segments[b2_maxStackSegments];
+	int32 m_segmentCount;
+	int32 m_segment;
 
 	int32 m_allocation;
 	int32 m_maxAllocation;
+	int32 m_growCount;
 
-	b2StackEntry m_entries[b2_maxStackEntries];
+	b2StackEntry* m_entries;
 	int32 m_entryCount;
+	int32 m_entryCapacity;
 };
 
+inline int32 b2StackAllocator::GetMaxAllocation() const
+{
+	return m_maxAllocation;
+}
+
+inline int32 b2StackAllocator::GetGrowCount() const
+{
+	return m_growCount;
+}
+
 #endif
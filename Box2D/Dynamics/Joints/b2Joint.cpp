@@ -131,4 +131,5 @@ b2Joint::b2Joint(const b2JointDef* def)
 	m_collideConnected = def->collideConnected;
 	m_islandFlag = false;
 	m_userData = def->userData;
+	m_stamp = 0;
 }
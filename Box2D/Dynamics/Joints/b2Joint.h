@@ -134,6 +134,9 @@ public:
 	/// Set the user data pointer.
 	void SetUserData(void* data);
 
+	/// Get whether the attached bodies collide with each other.
+	bool GetCollideConnected() const;
+
 	//--------------- Internals Below -------------------
 protected:
 	friend class b2World;
@@ -167,6 +170,9 @@ protected:
 	bool m_collideConnected;
 
 	void* m_userData;
+
+	// Unique within the world, tells a reused block apart (see b2World::SaveState).
+	uint32 m_stamp;
 };
 
 inline void b2Jacobian::SetZero()
@@ -216,4 +222,9 @@ inline void b2Joint::SetUserData(void* data)
 	m_userData = data;
 }
 
+inline bool b2Joint::GetCollideConnected() const
+{
+	return m_collideConnected;
+}
+
 #endif
@@ -102,6 +102,9 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_userData = bd->userData;
 
+	m_movedIndex = -1;
+	m_stamp = 0;
+
 	m_shapeList = NULL;
 	m_shapeCount = 0;
 }
@@ -128,8 +131,19 @@ b2Shape* b2Body::CreateShape(b2ShapeDef* def)
 
 	s->m_body = this;
 
-	// Add the shape to the world's broad-phase.
-	s->CreateProxy(m_world->m_broadPhase, m_xf);
+	// Add the shape to the world's broad-phase, now or in b2World::EndCreate.
+	if (IsActive() == false)
+	{
+		// SetActive(true) adds it.
+	}
+	else if (m_world->m_createDepth > 0)
+	{
+		m_world->AddNewShape(s);
+	}
+	else
+	{
+		s->CreateProxy(m_world->m_broadPhase, m_xf);
+	}
 
 	// Compute the sweep radius for CCD.
 	s->UpdateSweepRadius(m_sweep.localCenter);
@@ -317,6 +331,17 @@ bool b2Body::SetXForm(const b2Vec2& position, float32 angle)
 		return true;
 	}
 
+	if (IsActive() == false)
+	{
+		// No proxies to move, SetActive(true) creates them here.
+		m_xf.R.Set(angle);
+		m_xf.position = position;
+
+		m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+		m_sweep.a0 = m_sweep.a = angle;
+		return true;
+	}
+
 	if (IsFrozen())
 	{
 		return false;
@@ -328,6 +353,8 @@ bool b2Body::SetXForm(const b2Vec2& position, float32 angle)
 	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
 	m_sweep.a0 = m_sweep.a = angle;
 
+	m_world->AddMovedBody(this);
+
 	bool freeze = false;
 	for (b2Shape* s = m_shapeList; s; s = s->m_next)
 	{
@@ -377,13 +404,7 @@ bool b2Body::SynchronizeShapes()
 
 	if (inRange == false)
 	{
-		m_flags |= e_frozenFlag;
-		m_linearVelocity.SetZero();
-		m_angularVelocity = 0.0f;
-		for (b2Shape* s = m_shapeList; s; s = s->m_next)
-		{
-			s->DestroyProxy(m_world->m_broadPhase);
-		}
+		Freeze();
 
 		// Failure
 		return false;
@@ -392,3 +413,72 @@ bool b2Body::SynchronizeShapes()
 	// Success
 	return true;
 }
+
+void b2Body::SetActive(bool flag)
+{
+	b2Assert(m_world->m_lock == false);
+	if (m_world->m_lock == true || flag == IsActive())
+	{
+		return;
+	}
+
+	if (flag)
+	{
+		m_flags &= ~(e_inactiveFlag | e_frozenFlag);
+
+		if (m_world->m_createDepth > 0)
+		{
+			for (b2Shape* s = m_shapeList; s; s = s->m_next)
+			{
+				m_world->AddNewShape(s);
+			}
+		}
+		else
+		{
+			bool inRange = true;
+			for (b2Shape* s = m_shapeList; s; s = s->m_next)
+			{
+				s->CreateProxy(m_world->m_broadPhase, m_xf);
+				inRange = inRange && s->m_proxyId != b2_nullProxy;
+			}
+
+			if (inRange == false)
+			{
+				Freeze();
+			}
+		}
+
+		m_world->AddMovedBody(this);
+		WakeUp();
+	}
+	else
+	{
+		b2Assert(m_jointList == NULL);
+
+		// A frozen body has already left the broad-phase.
+		for (b2Shape* s = m_shapeList; s; s = s->m_next)
+		{
+			s->DestroyProxy(m_world->m_broadPhase);
+		}
+
+		m_flags |= e_inactiveFlag;
+		m_flags &= ~e_frozenFlag;
+		m_linearVelocity.SetZero();
+		m_angularVelocity = 0.0f;
+		m_force.SetZero();
+		m_torque = 0.0f;
+
+		m_world->RemoveMovedBody(this);
+	}
+}
+
+void b2Body::Freeze()
+{
+	m_flags |= e_frozenFlag;
+	m_linearVelocity.SetZero();
+	m_angularVelocity = 0.0f;
+	for (b2Shape* s = m_shapeList; s; s = s->m_next)
+	{
+		s->DestroyProxy(m_world->m_broadPhase);
+	}
+}
@@ -250,6 +250,15 @@ public:
 	/// This also sets the velocity to zero.
 	void PutToSleep();
 
+	/// Deactivate or reactivate this body. An inactive body keeps its shapes
+	/// and mass but has no broad-phase proxies, no contacts and is skipped by
+	/// the solver. Reactivating clears the frozen state and adds the shapes
+	/// back at the current transform. Don't deactivate a body with joints.
+	void SetActive(bool flag);
+
+	/// Is this body active (in the broad-phase and the solver)?
+	bool IsActive() const;
+
 	/// Get the list of all shapes attached to this body.
 	b2Shape* GetShapeList();
 
@@ -291,6 +300,7 @@ private:
 		e_allowSleepFlag	= 0x0010,
 		e_bulletFlag		= 0x0020,
 		e_fixedRotationFlag	= 0x0040,
+		e_inactiveFlag		= 0x0080,
 	};
 
 	// m_type
@@ -306,6 +316,9 @@ private:
 
 	bool SynchronizeShapes();
 
+	// Freeze an out of range body, its shapes leave the broad-phase.
+	void Freeze();
+
 	void SynchronizeTransform();
 
 	// This is used to prevent connected bodies from colliding.
@@ -345,6 +358,12 @@ private:
 
 	float32 m_sleepTime;
 
+	// Slot in the world's moved list, -1 when not listed.
+	int32 m_movedIndex;
+
+	// Unique within the world, tells a reused block apart (see SaveState).
+	uint32 m_stamp;
+
 	void* m_userData;
 };
 
@@ -470,6 +489,11 @@ inline bool b2Body::IsSleeping() const
 	return (m_flags & e_sleepFlag) == e_sleepFlag;
 }
 
+inline bool b2Body::IsActive() const
+{
+	return (m_flags & e_inactiveFlag) == 0;
+}
+
 inline void b2Body::AllowSleeping(bool flag)
 {
 	if (flag)
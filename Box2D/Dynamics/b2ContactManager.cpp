@@ -40,12 +40,14 @@ void* b2ContactManager::PairAdded(void* proxyUserData1, void* proxyUserData2)
 		return &m_nullContact;
 	}
 
-	if (body2->IsConnected(body1))
+	// Check the filter (category/mask bits) before walking the joint list,
+	// most rejected pairs are cheaper to reject here.
+	if (m_world->m_contactFilter != NULL && m_world->m_contactFilter->ShouldCollide(shape1, shape2) == false)
 	{
 		return &m_nullContact;
 	}
 
-	if (m_world->m_contactFilter != NULL && m_world->m_contactFilter->ShouldCollide(shape1, shape2) == false)
+	if (body2->IsConnected(body1))
 	{
 		return &m_nullContact;
 	}
@@ -19,13 +19,76 @@
 #include "b2World.h"
 #include "b2Body.h"
 #include "b2Island.h"
+#include "Joints/b2DistanceJoint.h"
+#include "Joints/b2GearJoint.h"
+#include "Joints/b2MouseJoint.h"
+#include "Joints/b2PrismaticJoint.h"
 #include "Joints/b2PulleyJoint.h"
+#include "Joints/b2RevoluteJoint.h"
 #include "Contacts/b2Contact.h"
 #include "Contacts/b2ContactSolver.h"
 #include "../Collision/b2Collision.h"
 #include "../Collision/Shapes/b2CircleShape.h"
 #include "../Collision/Shapes/b2PolygonShape.h"
+#include "../Common/b2Timer.h"
 #include <new>
+#include <string.h>
+#include <stdlib.h>
+
+void b2Profile::SetZero()
+{
+	step = 0.0f;
+	collide = 0.0f;
+	islands = 0.0f;
+	solve = 0.0f;
+	synchronize = 0.0f;
+	commit = 0.0f;
+	solveTOI = 0.0f;
+
+	pairCount = 0;
+	contactCount = 0;
+	islandCount = 0;
+	maxIslandSize = 0;
+	gjkIterations = 0;
+	toiEvents = 0;
+	bodyCount = 0;
+	sleepingBodies = 0;
+
+	stackMaxAllocation = 0;
+	stackCapacity = 0;
+	stackGrowCount = 0;
+
+	blockChunkBytes = 0;
+	blockUsedBytes = 0;
+}
+
+void b2Profile::Accumulate(const b2Profile& profile)
+{
+	step += profile.step;
+	collide += profile.collide;
+	islands += profile.islands;
+	solve += profile.solve;
+	synchronize += profile.synchronize;
+	commit += profile.commit;
+	solveTOI += profile.solveTOI;
+
+	gjkIterations += profile.gjkIterations;
+	toiEvents += profile.toiEvents;
+
+	pairCount = profile.pairCount;
+	contactCount = profile.contactCount;
+	islandCount = profile.islandCount;
+	maxIslandSize = b2Max(maxIslandSize, profile.maxIslandSize);
+	bodyCount = profile.bodyCount;
+	sleepingBodies = profile.sleepingBodies;
+
+	stackMaxAllocation = profile.stackMaxAllocation;
+	stackCapacity = profile.stackCapacity;
+	stackGrowCount = profile.stackGrowCount;
+
+	blockChunkBytes = profile.blockChunkBytes;
+	blockUsedBytes = profile.blockUsedBytes;
+}
 
 b2World::b2World(const b2AABB& worldAABB, const b2Vec2& gravity, bool doSleep)
 {
@@ -42,10 +105,12 @@ b2World::b2World(const b2AABB& worldAABB, const b2Vec2& gravity, bool doSleep)
 	m_bodyCount = 0;
 	m_contactCount = 0;
 	m_jointCount = 0;
+	m_stampCount = 0;
 
 	m_positionCorrection = true;
 	m_warmStarting = true;
 	m_continuousPhysics = true;
+	m_batchSynchronize = true;
 
 	m_allowSleep = doSleep;
 	m_gravity = gravity;
@@ -54,6 +119,17 @@ b2World::b2World(const b2AABB& worldAABB, const b2Vec2& gravity, bool doSleep)
 
 	m_inv_dt0 = 0.0f;
 
+	m_profile.SetZero();
+
+	m_movedBodies = NULL;
+	m_movedCount = 0;
+	m_movedCapacity = 0;
+
+	m_newShapes = NULL;
+	m_newShapeCount = 0;
+	m_newShapeCapacity = 0;
+	m_createDepth = 0;
+
 	m_contactManager.m_world = this;
 	void* mem = b2Alloc(sizeof(b2BroadPhase));
 	m_broadPhase = new (mem) b2BroadPhase(worldAABB, &m_contactManager);
@@ -64,9 +140,71 @@ b2World::b2World(const b2AABB& worldAABB, const b2Vec2& gravity, bool doSleep)
 
 b2World::~b2World()
 {
-	DestroyBody(m_groundBody);
+	// Everything left lives in the block allocator, which frees its
+	// chunks wholesale. Nothing to unlink one by one.
 	m_broadPhase->~b2BroadPhase();
 	b2Free(m_broadPhase);
+
+	if (m_movedBodies)
+	{
+		b2Free(m_movedBodies);
+	}
+
+	if (m_newShapes)
+	{
+		b2Free(m_newShapes);
+	}
+}
+
+void b2World::DestroyAll()
+{
+	b2Assert(m_lock == false);
+	if (m_lock == true)
+	{
+		return;
+	}
+
+	// Only walk the graph if somebody has to be told.
+	if (m_destructionListener)
+	{
+		for (b2Joint* j = m_jointList; j; j = j->m_next)
+		{
+			m_destructionListener->SayGoodbye(j);
+		}
+
+		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		{
+			for (b2Shape* s = b->m_shapeList; s; s = s->m_next)
+			{
+				m_destructionListener->SayGoodbye(s);
+			}
+		}
+	}
+
+	// Bodies, shapes, joints and contacts have trivial destructors, so the
+	// proxies and pairs are dropped by rebuilding the broad-phase and the
+	// objects themselves by releasing the allocator chunks.
+	b2AABB worldAABB = m_broadPhase->m_worldAABB;
+	m_broadPhase->~b2BroadPhase();
+	new (m_broadPhase) b2BroadPhase(worldAABB, &m_contactManager);
+
+	m_blockAllocator.Clear();
+
+	m_movedCount = 0;
+	m_newShapeCount = 0;
+
+	m_bodyList = NULL;
+	m_contactList = NULL;
+	m_jointList = NULL;
+
+	m_bodyCount = 0;
+	m_contactCount = 0;
+	m_jointCount = 0;
+
+	m_inv_dt0 = 0.0f;
+
+	b2BodyDef bd;
+	m_groundBody = CreateBody(&bd);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -104,6 +242,7 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 
 	void* mem = m_blockAllocator.Allocate(sizeof(b2Body));
 	b2Body* b = new (mem) b2Body(def, this);
+	b->m_stamp = ++m_stampCount;
 
 	// Add to world doubly linked list.
 	b->m_prev = NULL;
@@ -115,13 +254,16 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	// Its first transform has to be picked up too.
+	AddMovedBody(b);
+
 	return b;
 }
 
 void b2World::DestroyBody(b2Body* b)
 {
 	b2Assert(m_bodyCount > 0);
-	b2Assert(m_lock == false);
+	b2Assert(m_lock == false && m_createDepth == 0);
 	if (m_lock == true)
 	{
 		return;
@@ -175,16 +317,234 @@ void b2World::DestroyBody(b2Body* b)
 		m_bodyList = b->m_next;
 	}
 
+	RemoveMovedBody(b);
+
 	--m_bodyCount;
 	b->~b2Body();
 	m_blockAllocator.Free(b, sizeof(b2Body));
 }
 
+void b2World::DestroyBodies(b2Body** bodies, int32 count)
+{
+	b2Assert(count <= m_bodyCount);
+	b2Assert(m_lock == false && m_createDepth == 0);
+	if (m_lock == true)
+	{
+		return;
+	}
+
+	// Delete the attached joints, they may connect bodies of the batch.
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2JointEdge* jn = bodies[i]->m_jointList;
+		while (jn)
+		{
+			b2JointEdge* jn0 = jn;
+			jn = jn->next;
+
+			if (m_destructionListener)
+			{
+				m_destructionListener->SayGoodbye(jn0->joint);
+			}
+
+			DestroyJoint(jn0->joint);
+		}
+	}
+
+	// Destroy all proxies at once. This removes the pairs and so the
+	// contacts of all shapes in the batch.
+	int32 capacity = b2Max(m_broadPhase->m_proxyCount, 1);
+	uint16* proxyIds = (uint16*)m_stackAllocator.Allocate(capacity * sizeof(uint16));
+	int32 proxyCount = 0;
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		for (b2Shape* s = bodies[i]->m_shapeList; s; s = s->m_next)
+		{
+			if (s->m_proxyId != b2_nullProxy)
+			{
+				b2Assert(proxyCount < capacity);
+				proxyIds[proxyCount++] = s->m_proxyId;
+			}
+		}
+	}
+
+	m_broadPhase->DestroyProxies(proxyIds, proxyCount);
+	m_stackAllocator.Free(proxyIds);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* b = bodies[i];
+
+		// Delete the attached shapes.
+		b2Shape* s = b->m_shapeList;
+		while (s)
+		{
+			b2Shape* s0 = s;
+			s = s->m_next;
+
+			if (m_destructionListener)
+			{
+				m_destructionListener->SayGoodbye(s0);
+			}
+
+			s0->m_proxyId = b2_nullProxy;
+			b2Shape::Destroy(s0, &m_blockAllocator);
+		}
+
+		// Remove world body list.
+		if (b->m_prev)
+		{
+			b->m_prev->m_next = b->m_next;
+		}
+
+		if (b->m_next)
+		{
+			b->m_next->m_prev = b->m_prev;
+		}
+
+		if (b == m_bodyList)
+		{
+			m_bodyList = b->m_next;
+		}
+
+		RemoveMovedBody(b);
+
+		--m_bodyCount;
+		b->~b2Body();
+		m_blockAllocator.Free(b, sizeof(b2Body));
+	}
+}
+
+void b2World::AddMovedBody(b2Body* b)
+{
+	if (b->m_movedIndex != -1)
+	{
+		return;
+	}
+
+	if (m_movedCount == m_movedCapacity)
+	{
+		int32 capacity = b2Max(2 * m_movedCapacity, 64);
+		b2Body** bodies = (b2Body**)b2Alloc(capacity * sizeof(b2Body*));
+
+		if (m_movedBodies)
+		{
+			memcpy(bodies, m_movedBodies, m_movedCount * sizeof(b2Body*));
+			b2Free(m_movedBodies);
+		}
+
+		m_movedBodies = bodies;
+		m_movedCapacity = capacity;
+	}
+
+	b->m_movedIndex = m_movedCount;
+	m_movedBodies[m_movedCount++] = b;
+}
+
+void b2World::RemoveMovedBody(b2Body* b)
+{
+	int32 index = b->m_movedIndex;
+	if (index == -1)
+	{
+		return;
+	}
+
+	// Swap the last one into the hole.
+	b2Body* last = m_movedBodies[--m_movedCount];
+	m_movedBodies[index] = last;
+	last->m_movedIndex = index;
+
+	b->m_movedIndex = -1;
+}
+
+void b2World::AddNewShape(b2Shape* s)
+{
+	if (m_newShapeCount == m_newShapeCapacity)
+	{
+		int32 capacity = b2Max(2 * m_newShapeCapacity, 64);
+		b2Shape** shapes = (b2Shape**)b2Alloc(capacity * sizeof(b2Shape*));
+
+		if (m_newShapes)
+		{
+			memcpy(shapes, m_newShapes, m_newShapeCount * sizeof(b2Shape*));
+			b2Free(m_newShapes);
+		}
+
+		m_newShapes = shapes;
+		m_newShapeCapacity = capacity;
+	}
+
+	m_newShapes[m_newShapeCount++] = s;
+}
+
+void b2World::BeginCreate()
+{
+	b2Assert(m_lock == false);
+	++m_createDepth;
+}
+
+void b2World::EndCreate()
+{
+	b2Assert(m_createDepth > 0);
+
+	if (--m_createDepth > 0 || m_newShapeCount == 0)
+	{
+		return;
+	}
+
+	b2AABB* aabbs = (b2AABB*)b2Alloc(m_newShapeCount * sizeof(b2AABB));
+	void** userData = (void**)b2Alloc(m_newShapeCount * sizeof(void*));
+	uint16* proxyIds = (uint16*)b2Alloc(m_newShapeCount * sizeof(uint16));
+	int32 count = 0;
+
+	for (int32 i = 0; i < m_newShapeCount; ++i)
+	{
+		b2Shape* s = m_newShapes[i];
+		s->ComputeAABB(aabbs + count, s->m_body->m_xf);
+
+		// Like b2Shape::CreateProxy, a shape outside the world box gets no proxy.
+		bool inRange = m_broadPhase->InRange(aabbs[count]);
+		b2Assert(inRange);
+
+		if (inRange)
+		{
+			m_newShapes[count] = s;
+			userData[count] = s;
+			++count;
+		}
+	}
+
+	m_broadPhase->CreateProxies(aabbs, userData, count, proxyIds);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		m_newShapes[i]->m_proxyId = proxyIds[i];
+	}
+
+	m_newShapeCount = 0;
+
+	b2Free(proxyIds);
+	b2Free(userData);
+	b2Free(aabbs);
+}
+
+void b2World::ClearMovedBodies()
+{
+	for (int32 i = 0; i < m_movedCount; ++i)
+	{
+		m_movedBodies[i]->m_movedIndex = -1;
+	}
+
+	m_movedCount = 0;
+}
+
 b2Joint* b2World::CreateJoint(const b2JointDef* def)
 {
 	b2Assert(m_lock == false);
 
 	b2Joint* j = b2Joint::Create(def, &m_blockAllocator);
+	j->m_stamp = ++m_stampCount;
 
 	// Connect to the world list.
 	j->m_prev = NULL;
@@ -337,12 +697,17 @@ void b2World::Solve(const b2TimeStep& step)
 		j->m_islandFlag = false;
 	}
 
+	b2Timer timer;
+	float32 solveTime = 0.0f;
+	int32 islandCount = 0;
+	int32 maxIslandSize = 0;
+
 	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
 	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
 	{
-		if (seed->m_flags & (b2Body::e_islandFlag | b2Body::e_sleepFlag | b2Body::e_frozenFlag))
+		if (seed->m_flags & (b2Body::e_islandFlag | b2Body::e_sleepFlag | b2Body::e_frozenFlag | b2Body::e_inactiveFlag))
 		{
 			continue;
 		}
@@ -429,7 +794,12 @@ void b2World::Solve(const b2TimeStep& step)
 			}
 		}
 
+		++islandCount;
+		maxIslandSize = b2Max(maxIslandSize, island.m_bodyCount);
+
+		b2Timer solveTimer;
 		island.Solve(step, m_gravity, m_positionCorrection, m_allowSleep);
+		solveTime += solveTimer.GetMilliseconds();
 		m_positionIterationCount = b2Max(m_positionIterationCount, island.m_positionIterationCount);
 
 		// Post solve cleanup.
@@ -441,16 +811,36 @@ void b2World::Solve(const b2TimeStep& step)
 			{
 				b->m_flags &= ~b2Body::e_islandFlag;
 			}
+			else
+			{
+				AddMovedBody(b);
+			}
 		}
 	}
 
 	m_stackAllocator.Free(stack);
 
+	m_profile.islands = timer.GetMilliseconds() - solveTime;
+	m_profile.solve = solveTime;
+	m_profile.islandCount = islandCount;
+	m_profile.maxIslandSize = maxIslandSize;
+
+	timer.Reset();
+
 	// Synchronize shapes, check for out of range bodies.
-	for (b2Body* b = m_bodyList; b; b = b->GetNext())
+	int32 sleepingBodies = 0;
+	if (m_batchSynchronize)
 	{
-		if (b->m_flags & (b2Body::e_sleepFlag | b2Body::e_frozenFlag))
+		sleepingBodies = SynchronizeShapes();
+	}
+	else for (b2Body* b = m_bodyList; b; b = b->GetNext())
+	{
+		if (b->m_flags & (b2Body::e_sleepFlag | b2Body::e_frozenFlag | b2Body::e_inactiveFlag))
 		{
+			if (b->m_flags & b2Body::e_sleepFlag)
+			{
+				++sleepingBodies;
+			}
 			continue;
 		}
 
@@ -471,9 +861,136 @@ void b2World::Solve(const b2TimeStep& step)
 		}
 	}
 
+	m_profile.synchronize = timer.GetMilliseconds();
+	m_profile.sleepingBodies = sleepingBodies;
+
+	timer.Reset();
+
 	// Commit shape proxy movements to the broad-phase so that new contacts are created.
 	// Also, some contacts can be destroyed.
 	m_broadPhase->Commit();
+
+	m_profile.commit = timer.GetMilliseconds();
+}
+
+// Same as calling b2Body::SynchronizeShapes on every awake body, but the swept
+// AABBs of all shapes are computed by one b2ComputeSweptAABBs call before the
+// proxies are moved. Returns the number of sleeping bodies.
+int32 b2World::SynchronizeShapes()
+{
+	int32 sleepingBodies = 0;
+	int32 capacity = b2Max(m_broadPhase->m_proxyCount, 1);
+
+	b2Shape** shapes = (b2Shape**)m_stackAllocator.Allocate(capacity * sizeof(b2Shape*));
+	b2LocalBox* boxes = (b2LocalBox*)m_stackAllocator.Allocate(capacity * sizeof(b2LocalBox));
+	b2XForm* xf1 = (b2XForm*)m_stackAllocator.Allocate(capacity * sizeof(b2XForm));
+	b2XForm* xf2 = (b2XForm*)m_stackAllocator.Allocate(capacity * sizeof(b2XForm));
+	b2Vec2* lower = (b2Vec2*)m_stackAllocator.Allocate(2 * capacity * sizeof(b2Vec2));
+	b2Vec2* upper = lower + capacity;
+
+	// Gather the shapes of all awake bodies.
+	int32 count = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if (b->m_flags & (b2Body::e_sleepFlag | b2Body::e_frozenFlag | b2Body::e_inactiveFlag))
+		{
+			if (b->m_flags & b2Body::e_sleepFlag)
+			{
+				++sleepingBodies;
+			}
+			continue;
+		}
+
+		if (b->IsStatic())
+		{
+			continue;
+		}
+
+		// A shape without a proxy freezes the body, leave that to the body.
+		bool hasProxies = true;
+		for (b2Shape* s = b->m_shapeList; s; s = s->m_next)
+		{
+			if (s->m_proxyId == b2_nullProxy)
+			{
+				hasProxies = false;
+				break;
+			}
+		}
+
+		if (hasProxies == false)
+		{
+			bool inRange = b->SynchronizeShapes();
+
+			if (inRange == false && m_boundaryListener != NULL)
+			{
+				m_boundaryListener->Violation(b);
+			}
+			continue;
+		}
+
+		b2XForm xf;
+		xf.R.Set(b->m_sweep.a0);
+		xf.position = b->m_sweep.c0 - b2Mul(xf.R, b->m_sweep.localCenter);
+
+		for (b2Shape* s = b->m_shapeList; s; s = s->m_next)
+		{
+			b2Assert(count < capacity);
+			shapes[count] = s;
+			boxes[count] = s->m_localBox;
+			xf1[count] = xf;
+			xf2[count] = b->m_xf;
+			++count;
+		}
+	}
+
+	b2ComputeSweptAABBs(boxes, xf1, xf2, lower, upper, count);
+
+	// Move the proxies, one body at a time.
+	for (int32 i = 0; i < count; )
+	{
+		b2Body* b = shapes[i]->m_body;
+
+		int32 j = i;
+		bool inRange = true;
+		for (; j < count && shapes[j]->m_body == b; ++j)
+		{
+			b2AABB aabb;
+			aabb.lowerBound = lower[j];
+			aabb.upperBound = upper[j];
+			inRange = inRange && m_broadPhase->InRange(aabb);
+		}
+
+		if (inRange)
+		{
+			for (int32 k = i; k < j; ++k)
+			{
+				b2AABB aabb;
+				aabb.lowerBound = lower[k];
+				aabb.upperBound = upper[k];
+				m_broadPhase->MoveProxy(shapes[k]->m_proxyId, aabb);
+			}
+		}
+		else
+		{
+			b->Freeze();
+
+			// Did the body's shapes leave the world?
+			if (m_boundaryListener != NULL)
+			{
+				m_boundaryListener->Violation(b);
+			}
+		}
+
+		i = j;
+	}
+
+	m_stackAllocator.Free(lower);
+	m_stackAllocator.Free(xf2);
+	m_stackAllocator.Free(xf1);
+	m_stackAllocator.Free(boxes);
+	m_stackAllocator.Free(shapes);
+
+	return sleepingBodies;
 }
 
 // Find TOI contacts and solve them.
@@ -548,7 +1065,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 				b2Assert(t0 < 1.0f);
 
 				// Compute the time of impact.
-				toi = b2TimeOfImpact(c->m_shape1, b1->m_sweep, c->m_shape2, b2->m_sweep);
+				toi = b2TimeOfImpact(c->m_shape1, b1->m_sweep, c->m_shape2, b2->m_sweep, &m_profile.gjkIterations);
 
 				b2Assert(0.0f <= toi && toi <= 1.0f);
 
@@ -576,6 +1093,8 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			break;
 		}
 
+		++m_profile.toiEvents;
+
 		// Advance the bodies to the TOI.
 		b2Shape* s1 = minContact->GetShape1();
 		b2Shape* s2 = minContact->GetShape2();
@@ -686,6 +1205,11 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			b2Body* b = island.m_bodies[i];
 			b->m_flags &= ~b2Body::e_islandFlag;
 
+			if (b->IsStatic() == false)
+			{
+				AddMovedBody(b);
+			}
+
 			if (b->m_flags & (b2Body::e_sleepFlag | b2Body::e_frozenFlag))
 			{
 				continue;
@@ -732,8 +1256,12 @@ void b2World::SolveTOI(const b2TimeStep& step)
 
 void b2World::Step(float32 dt, int32 iterations)
 {
+	b2Assert(m_createDepth == 0);
 	m_lock = true;
 
+	b2Timer stepTimer;
+	m_profile.SetZero();
+
 	b2TimeStep step;
 	step.dt = dt;
 	step.maxIterations	= iterations;
@@ -752,7 +1280,11 @@ void b2World::Step(float32 dt, int32 iterations)
 	step.warmStarting = m_warmStarting;
 	
 	// Update contacts.
-	m_contactManager.Collide();
+	{
+		b2Timer timer;
+		m_contactManager.Collide();
+		m_profile.collide = timer.GetMilliseconds();
+	}
 
 	// Integrate velocities, solve velocity constraints, and integrate positions.
 	if (step.dt > 0.0f)
@@ -763,9 +1295,24 @@ void b2World::Step(float32 dt, int32 iterations)
 	// Handle TOI events.
 	if (m_continuousPhysics && step.dt > 0.0f)
 	{
+		b2Timer timer;
 		SolveTOI(step);
+		m_profile.solveTOI = timer.GetMilliseconds();
 	}
 
+	m_profile.pairCount = GetPairCount();
+	m_profile.contactCount = m_contactCount;
+	m_profile.bodyCount = m_bodyCount;
+	m_profile.stackMaxAllocation = m_stackAllocator.GetMaxAllocation();
+	m_profile.stackCapacity = m_stackAllocator.GetCapacity();
+	m_profile.stackGrowCount = m_stackAllocator.GetGrowCount();
+
+	b2BlockAllocatorStats blockStats;
+	m_blockAllocator.GetStats(&blockStats);
+	m_profile.blockChunkBytes = blockStats.chunkBytes;
+	m_profile.blockUsedBytes = blockStats.usedBytes;
+	m_profile.step = stepTimer.GetMilliseconds();
+
 	// Draw debug information.
 	DrawDebugData();
 
@@ -820,20 +1367,14 @@ void b2World::DrawShape(b2Shape* shape, const b2XForm& xf, const b2Color& color,
 			b2Assert(vertexCount <= b2_maxPolygonVertices);
 			b2Vec2 vertices[b2_maxPolygonVertices];
 
-			for (int32 i = 0; i < vertexCount; ++i)
-			{
-				vertices[i] = b2Mul(xf, localVertices[i]);
-			}
+			b2MulBatch(xf, localVertices, vertices, vertexCount);
 
 			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
 
 			if (core)
 			{
 				const b2Vec2* localCoreVertices = poly->GetCoreVertices();
-				for (int32 i = 0; i < vertexCount; ++i)
-				{
-					vertices[i] = b2Mul(xf, localCoreVertices[i]);
-				}
+				b2MulBatch(xf, localCoreVertices, vertices, vertexCount);
 				m_debugDraw->DrawPolygon(vertices, vertexCount, coreColor);
 			}
 		}
@@ -901,6 +1442,11 @@ void b2World::DrawDebugData()
 
 		for (b2Body* b = m_bodyList; b; b = b->GetNext())
 		{
+			if (b->IsActive() == false)
+			{
+				continue;
+			}
+
 			const b2XForm& xf = b->GetXForm();
 			for (b2Shape* s = b->GetShapeList(); s; s = s->GetNext())
 			{
@@ -1066,3 +1612,338 @@ int32 b2World::GetPairCount() const
 {
 	return m_broadPhase->m_pairManager.m_pairCount;
 }
+
+// Flat layout used by SaveState/LoadState:
+// header, bodies (world list order), joints (world list order, variable size),
+// touching contacts (sorted by shape pair).
+struct b2StateHeader
+{
+	int32 size;
+	int32 bodyCount;
+	int32 jointCount;
+	int32 contactCount;
+	float32 inv_dt0;
+};
+
+// Bodies and joints are matched by stamp, the allocator hands out the
+// memory of destroyed ones again.
+struct b2BodyState
+{
+	uint32 stamp;
+	b2XForm xf;
+	b2Sweep sweep;
+	b2Vec2 linearVelocity;
+	float32 angularVelocity;
+	b2Vec2 force;
+	float32 torque;
+	float32 sleepTime;
+	uint16 flags;
+};
+
+struct b2JointState
+{
+	uint32 stamp;
+	int32 size;
+};
+
+struct b2ContactState
+{
+	const b2Shape* shape1;
+	const b2Shape* shape2;
+	b2Manifold manifold;
+	float32 toi;
+};
+
+static int32 b2GetJointSize(b2JointType type)
+{
+	switch (type)
+	{
+	case e_distanceJoint:
+		return sizeof(b2DistanceJoint);
+
+	case e_mouseJoint:
+		return sizeof(b2MouseJoint);
+
+	case e_prismaticJoint:
+		return sizeof(b2PrismaticJoint);
+
+	case e_revoluteJoint:
+		return sizeof(b2RevoluteJoint);
+
+	case e_pulleyJoint:
+		return sizeof(b2PulleyJoint);
+
+	case e_gearJoint:
+		return sizeof(b2GearJoint);
+
+	default:
+		b2Assert(false);
+		return 0;
+	}
+}
+
+// Keep joint records pointer aligned.
+static int32 b2AlignState(int32 size)
+{
+	const int32 align = sizeof(void*) > sizeof(float32) ? sizeof(void*) : sizeof(float32);
+	return (size + align - 1) & ~(align - 1);
+}
+
+static int b2CompareContactStates(const void* a, const void* b)
+{
+	const b2ContactState* c1 = (const b2ContactState*)a;
+	const b2ContactState* c2 = (const b2ContactState*)b;
+
+	if (c1->shape1 != c2->shape1)
+	{
+		return c1->shape1 < c2->shape1 ? -1 : 1;
+	}
+
+	if (c1->shape2 != c2->shape2)
+	{
+		return c1->shape2 < c2->shape2 ? -1 : 1;
+	}
+
+	return 0;
+}
+
+int32 b2World::GetStateSize() const
+{
+	int32 size = sizeof(b2StateHeader) + m_bodyCount * sizeof(b2BodyState);
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		size += sizeof(b2JointState) + b2AlignState(b2GetJointSize(j->m_type));
+	}
+
+	for (b2Contact* c = m_contactList; c; c = c->m_next)
+	{
+		if (c->m_manifoldCount > 0)
+		{
+			size += sizeof(b2ContactState);
+		}
+	}
+
+	return size;
+}
+
+int32 b2World::SaveState(void* buffer) const
+{
+	b2Assert(buffer != NULL);
+
+	char* data = (char*)buffer;
+	b2StateHeader* header = (b2StateHeader*)data;
+	data += sizeof(b2StateHeader);
+
+	header->bodyCount = m_bodyCount;
+	header->jointCount = m_jointCount;
+	header->contactCount = 0;
+	header->inv_dt0 = m_inv_dt0;
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b2BodyState* state = (b2BodyState*)data;
+		data += sizeof(b2BodyState);
+
+		state->stamp = b->m_stamp;
+		state->xf = b->m_xf;
+		state->sweep = b->m_sweep;
+		state->linearVelocity = b->m_linearVelocity;
+		state->angularVelocity = b->m_angularVelocity;
+		state->force = b->m_force;
+		state->torque = b->m_torque;
+		state->sleepTime = b->m_sleepTime;
+		state->flags = b->m_flags;
+	}
+
+	// Joints are copied whole, the links are put back on load.
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		b2JointState* state = (b2JointState*)data;
+		data += sizeof(b2JointState);
+
+		state->stamp = j->m_stamp;
+		state->size = b2GetJointSize(j->m_type);
+
+		memcpy(data, j, state->size);
+		data += b2AlignState(state->size);
+	}
+
+	// Only touching contacts carry warm starting impulses.
+	b2ContactState* contacts = (b2ContactState*)data;
+	for (b2Contact* c = m_contactList; c; c = c->m_next)
+	{
+		if (c->m_manifoldCount == 0)
+		{
+			continue;
+		}
+
+		b2ContactState* state = contacts + header->contactCount;
+		state->shape1 = c->m_shape1;
+		state->shape2 = c->m_shape2;
+		state->manifold = *c->GetManifolds();
+		state->toi = c->m_toi;
+		++header->contactCount;
+	}
+
+	qsort(contacts, header->contactCount, sizeof(b2ContactState), b2CompareContactStates);
+	data += header->contactCount * sizeof(b2ContactState);
+
+	header->size = (int32)(data - (char*)buffer);
+	return header->size;
+}
+
+bool b2World::LoadState(const void* buffer, int32 size)
+{
+	b2Assert(m_lock == false);
+	if (m_lock == true || buffer == NULL || size < (int32)sizeof(b2StateHeader))
+	{
+		return false;
+	}
+
+	const char* data = (const char*)buffer;
+	const b2StateHeader* header = (const b2StateHeader*)data;
+
+	if (header->size != size || header->bodyCount != m_bodyCount || header->jointCount != m_jointCount)
+	{
+		return false;
+	}
+
+	// Validate before touching anything.
+	const b2BodyState* bodies = (const b2BodyState*)(data + sizeof(b2StateHeader));
+	int32 i = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next, ++i)
+	{
+		if (bodies[i].stamp != b->m_stamp)
+		{
+			return false;
+		}
+	}
+
+	const char* joints = (const char*)(bodies + m_bodyCount);
+	data = joints;
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		const b2JointState* state = (const b2JointState*)data;
+		if (state->stamp != j->m_stamp || state->size != b2GetJointSize(j->m_type))
+		{
+			return false;
+		}
+
+		data += sizeof(b2JointState) + b2AlignState(state->size);
+	}
+
+	const b2ContactState* contacts = (const b2ContactState*)data;
+	const int32 contactCount = header->contactCount;
+
+	// Bodies
+	i = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next, ++i)
+	{
+		const b2BodyState* state = bodies + i;
+
+		// Frozen and inactive bodies both have their shapes out of the broad-phase.
+		const uint16 noProxyFlags = b2Body::e_frozenFlag | b2Body::e_inactiveFlag;
+		bool wasFrozen = (b->m_flags & noProxyFlags) != 0;
+		bool isFrozen = (state->flags & noProxyFlags) != 0;
+
+		b->m_xf = state->xf;
+		b->m_sweep = state->sweep;
+		b->m_linearVelocity = state->linearVelocity;
+		b->m_angularVelocity = state->angularVelocity;
+		b->m_force = state->force;
+		b->m_torque = state->torque;
+		b->m_sleepTime = state->sleepTime;
+		b->m_flags = state->flags & ~b2Body::e_islandFlag;
+
+		if (wasFrozen == isFrozen)
+		{
+			continue;
+		}
+
+		for (b2Shape* s = b->m_shapeList; s; s = s->m_next)
+		{
+			if (isFrozen)
+			{
+				s->DestroyProxy(m_broadPhase);
+			}
+			else
+			{
+				s->CreateProxy(m_broadPhase, b->m_xf);
+			}
+		}
+	}
+
+	// Joints
+	data = joints;
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		const b2JointState* state = (const b2JointState*)data;
+		data += sizeof(b2JointState);
+
+		b2Joint* prev = j->m_prev;
+		b2Joint* next = j->m_next;
+		b2JointEdge node1 = j->m_node1;
+		b2JointEdge node2 = j->m_node2;
+		void* userData = j->m_userData;
+
+		memcpy((void*)j, data, state->size);
+		data += b2AlignState(state->size);
+
+		j->m_prev = prev;
+		j->m_next = next;
+		j->m_node1 = node1;
+		j->m_node2 = node2;
+		j->m_userData = userData;
+		j->m_islandFlag = false;
+	}
+
+	// Move the proxies to the restored transforms. The listener is muted so
+	// pairs coming and going here don't show up as contact events.
+	b2ContactListener* listener = m_contactListener;
+	m_contactListener = NULL;
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if (b->IsFrozen() || b->IsActive() == false || b->IsStatic())
+		{
+			continue;
+		}
+
+		for (b2Shape* s = b->m_shapeList; s; s = s->m_next)
+		{
+			s->Synchronize(m_broadPhase, b->m_xf, b->m_xf);
+		}
+
+		AddMovedBody(b);
+	}
+
+	m_broadPhase->Commit();
+	m_contactListener = listener;
+
+	// Warm starting
+	for (b2Contact* c = m_contactList; c; c = c->m_next)
+	{
+		b2ContactState key;
+		key.shape1 = c->m_shape1;
+		key.shape2 = c->m_shape2;
+
+		const b2ContactState* state = (const b2ContactState*)
+			bsearch(&key, contacts, contactCount, sizeof(b2ContactState), b2CompareContactStates);
+
+		c->m_flags &= ~(b2Contact::e_islandFlag | b2Contact::e_toiFlag);
+
+		if (state == NULL)
+		{
+			c->m_manifoldCount = 0;
+			continue;
+		}
+
+		*c->GetManifolds() = state->manifold;
+		c->m_manifoldCount = 1;
+		c->m_toi = state->toi;
+	}
+
+	m_inv_dt0 = header->inv_dt0;
+	return true;
+}
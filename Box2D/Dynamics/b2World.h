@@ -45,6 +45,44 @@ struct b2TimeStep
 	bool positionCorrection;
 };
 
+/// Per-phase timings (in milliseconds) and work counters of a time step.
+/// Timings and event counters (gjkIterations, toiEvents) cover the whole step,
+/// the remaining counters describe the world state at the end of the step.
+struct b2Profile
+{
+	/// Set all timings and counters to zero.
+	void SetZero();
+
+	/// Add the timings and event counters of another profile to this one and
+	/// take over its state counters, keeping the largest island seen. Use this
+	/// to merge several steps of a frame.
+	void Accumulate(const b2Profile& profile);
+
+	float32 step;
+	float32 collide;
+	float32 islands;
+	float32 solve;
+	float32 synchronize;
+	float32 commit;
+	float32 solveTOI;
+
+	int32 pairCount;
+	int32 contactCount;
+	int32 islandCount;
+	int32 maxIslandSize;
+	int32 gjkIterations;
+	int32 toiEvents;
+	int32 bodyCount;
+	int32 sleepingBodies;
+
+	int32 stackMaxAllocation;
+	int32 stackCapacity;
+	int32 stackGrowCount;
+
+	int32 blockChunkBytes;
+	int32 blockUsedBytes;
+};
+
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
 /// management facilities.
@@ -89,6 +127,11 @@ public:
 	/// @warning This function is locked during callbacks.
 	void DestroyBody(b2Body* body);
 
+	/// Destroy a batch of bodies. Same as calling DestroyBody on each of them,
+	/// but the broad-phase proxies of all their shapes are removed in one go.
+	/// @warning This function is locked during callbacks.
+	void DestroyBodies(b2Body** bodies, int32 count);
+
 	/// Create a joint to constrain bodies together. No reference to the definition
 	/// is retained. This may cause the connected bodies to cease colliding.
 	/// @warning This function is locked during callbacks.
@@ -98,6 +141,15 @@ public:
 	/// @warning This function is locked during callbacks.
 	void DestroyJoint(b2Joint* joint);
 
+	/// Destroy every body, shape, joint and contact in one go. The memory is
+	/// released by dropping the allocator chunks and resetting the broad-phase,
+	/// so no per-object proxy or contact list maintenance takes place. The
+	/// destruction listener, if any, is still told about each joint and shape.
+	/// A fresh ground body is created afterwards.
+	/// @warning Pointers to any previous body, shape or joint become invalid.
+	/// @warning This function is locked during callbacks.
+	void DestroyAll();
+
 	/// The world provides a single static ground body with no collision shapes.
 	/// You can use this to simplify the creation of joints and static shapes.
 	b2Body* GetGroundBody();
@@ -139,6 +191,9 @@ public:
 	/// Enable/disable continuous physics. For testing.
 	void SetContinuousPhysics(bool flag) { m_continuousPhysics = flag; }
 
+	/// Enable/disable the batched shape synchronization. For testing.
+	void SetBatchSynchronize(bool flag) { m_batchSynchronize = flag; }
+
 	/// Perform validation of internal data structures.
 	void Validate();
 
@@ -157,9 +212,59 @@ public:
 	/// Get the number of contacts (each may have 0 or more contact points).
 	int32 GetContactCount() const;
 
+	/// Get the largest number of bytes the step allocator had in use at once.
+	int32 GetStackMaxAllocation() const;
+
+	/// Get the number of times the step allocator had to grow.
+	int32 GetStackGrowCount() const;
+
+	/// Get the memory usage of the allocator holding bodies, shapes, joints and contacts.
+	void GetBlockAllocatorStats(b2BlockAllocatorStats* stats) const;
+
 	/// Change the global gravity vector.
 	void SetGravity(const b2Vec2& gravity);
 
+	/// Get the number of bytes needed by SaveState for the current world.
+	int32 GetStateSize() const;
+
+	/// Save the dynamic simulation state into a flat buffer. This covers body
+	/// transforms, sweeps and velocities, joint impulses and the contact manifolds
+	/// used for warm starting. Bodies, shapes and joints themselves are not saved.
+	/// @param buffer a user allocated buffer of at least GetStateSize() bytes.
+	/// @return the number of bytes written.
+	int32 SaveState(void* buffer) const;
+
+	/// Restore a state written by SaveState. The world must still contain the
+	/// same bodies, shapes and joints it had when the state was saved. Bodies and
+	/// joints created since are refused, even where they reuse freed memory.
+	/// @warning This function is locked during callbacks.
+	/// @return false if the world doesn't match the saved state (nothing is changed).
+	bool LoadState(const void* buffer, int32 size);
+
+	/// Get the timings and counters of the last call to Step.
+	const b2Profile& GetProfile() const;
+
+	/// Get the bodies whose transform changed since the last ClearMovedBodies:
+	/// bodies solved by Step (awake ones only), moved by SetXForm or just created.
+	/// Static and sleeping bodies are never listed, destroyed ones are taken out.
+	b2Body** GetMovedBodies();
+
+	/// Get the number of bodies in the moved list.
+	int32 GetMovedBodyCount() const;
+
+	/// Empty the moved list.
+	void ClearMovedBodies();
+
+	/// Defer the broad-phase proxies of shapes created from now on. EndCreate
+	/// inserts them all in one batch, which is much cheaper than inserting them
+	/// one at a time when many bodies are created at once. Calls may be nested,
+	/// the outermost EndCreate creates the proxies.
+	/// @warning Do not step, destroy bodies or call SetXForm before EndCreate.
+	void BeginCreate();
+
+	/// Create the deferred broad-phase proxies.
+	void EndCreate();
+
 private:
 
 	friend class b2Body;
@@ -167,6 +272,12 @@ private:
 
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
+	int32 SynchronizeShapes();
+
+	void AddMovedBody(b2Body* b);
+	void RemoveMovedBody(b2Body* b);
+
+	void AddNewShape(b2Shape* s);
 
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Shape* shape, const b2XForm& xf, const b2Color& color, bool core);
@@ -190,6 +301,9 @@ private:
 	int32 m_contactCount;
 	int32 m_jointCount;
 
+	// Last stamp given to a body or joint, never reset.
+	uint32 m_stampCount;
+
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
 
@@ -213,6 +327,22 @@ private:
 
 	// This is for debugging the solver.
 	bool m_continuousPhysics;
+
+	// Compute the broad-phase AABBs of all awake shapes at once.
+	bool m_batchSynchronize;
+
+	b2Profile m_profile;
+
+	// Bodies moved since the last ClearMovedBodies, see b2Body::m_movedIndex.
+	b2Body** m_movedBodies;
+	int32 m_movedCount;
+	int32 m_movedCapacity;
+
+	// Shapes waiting for their broad-phase proxy, see BeginCreate.
+	b2Shape** m_newShapes;
+	int32 m_newShapeCount;
+	int32 m_newShapeCapacity;
+	int32 m_createDepth;
 };
 
 inline b2Body* b2World::GetGroundBody()
@@ -245,9 +375,39 @@ inline int32 b2World::GetContactCount() const
 	return m_contactCount;
 }
 
+inline int32 b2World::GetStackMaxAllocation() const
+{
+	return m_stackAllocator.GetMaxAllocation();
+}
+
+inline int32 b2World::GetStackGrowCount() const
+{
+	return m_stackAllocator.GetGrowCount();
+}
+
+inline void b2World::GetBlockAllocatorStats(b2BlockAllocatorStats* stats) const
+{
+	m_blockAllocator.GetStats(stats);
+}
+
 inline void b2World::SetGravity(const b2Vec2& gravity)
 {
 	m_gravity = gravity;
 }
 
+inline b2Body** b2World::GetMovedBodies()
+{
+	return m_movedBodies;
+}
+
+inline int32 b2World::GetMovedBodyCount() const
+{
+	return m_movedCount;
+}
+
+inline const b2Profile& b2World::GetProfile() const
+{
+	return m_profile;
+}
+
 #endif
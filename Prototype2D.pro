@@ -26,7 +26,15 @@ SOURCES += main.cpp \
     games/anim/anim.cpp \
     games/jelly/jelly.cpp \
     games/jelly/jellyactor.cpp \
-    games/autumn/autumn.cpp
+    games/autumn/autumn.cpp \
+    physicsthread.cpp \
+    contactbuffer.cpp \
+    actorpool.cpp \
+    chunkstreamer.cpp \
+    names.cpp \
+    prefab.cpp \
+    scene.cpp \
+    spritebatch.cpp
 HEADERS += mainwindow.h \
     world.h \
     texture.h \
@@ -53,7 +61,15 @@ HEADERS += mainwindow.h \
     games/anim/anim.h \
     games/jelly/jelly.h \
     games/jelly/jellyactor.h \
-    games/autumn/autumn.h
+    games/autumn/autumn.h \
+    physicsthread.h \
+    contactbuffer.h \
+    actorpool.h \
+    chunkstreamer.h \
+    names.h \
+    prefab.h \
+    scene.h \
+    spritebatch.h
 FORMS += mainwindow.ui \
     startupdlg.ui
 LIBS += -L"Box2D"
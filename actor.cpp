@@ -38,10 +38,16 @@
 #include "texturemanager.h"
 #include "env.h"
 #include "world.h"
+#include "actorpool.h"
+#include "prefab.h"
+#include "spritebatch.h"
 
 #include <QtCore/QDebug>
 #include <QtCore/QHash>
 #include <math.h>
+#include <string.h>
+#include <new>
+#include <typeinfo>
 
 using namespace GL;
 using namespace Sys;
@@ -49,32 +55,48 @@ using namespace Sys;
 // Global
 static Env *gEnv = &Env::getInstance();
 static TextureManager *gTex = &TextureManager::getInstance();
+static ActorPool *gPool = &ActorPool::getInstance();
 
 Actor::Actor( const QString &pName, World *pWorld ) :	mTexture(0),
-														mFlags(0),
+														mHot(&mLocal),
+														mRRot(0.0f),
 														mNumFrames(-1),
-														mFrame(-1),
 														mFrameLoop(false),
 														mAnimate(false),
 														mFrameCounter(0.0f),
 														mTexCoords(0),
-														mVertices(0),
+														mFrames(0),
 														mName(""),
+														mNameId(0),
+														mNameStale(false),
 														mId(0),
+														mHandle(0),
+														mDrawSeq(0),
+														mCullStamp(0),
+														mInGrid(false),
+														mGridDirty(false),
 														mBlending(B_NONE),
+														mRenderLayer(R_DEFAULT),
+														mAutoZ(false),
 														mBody(0),
+														mLayer(0),
+														mPrefab(0),
 														mWorld(0)
 {
-	// no joints by defult
-	setHasJoints(false);
+	// hot data lives in the actor itself until it joins a World
+	memset(&mLocal,0,sizeof(t_hot));
+	mLocal.mFrame = -1;
+	mLocal.mActor = this;
+
 	// set default offsets
 	setOffsets(0.0f,0.0f);
 	// set default position
 	setPos(0.0f,0.0f);
 	// set default size
 	setSize(0.0f,0.0f);
-	// default layer (Z)
+	// default layer (Z), not one set by hand
 	setZOrder(0.0f);
+	mAutoZ = true;
 	// no set box flag by default
 	setFlag(S_BOX);
 	// default rotation
@@ -101,8 +123,6 @@ Actor::Actor( const QString &pName, World *pWorld ) :	mTexture(0),
 
 	// store pointer to world
 	mWorld = pWorld;
-
-	qDebug() << "Success: [Actor] "<< mName << " created";
 }
 
 Actor::~Actor()
@@ -113,16 +133,29 @@ Actor::~Actor()
 		removePhysX(); // remove body
 	}
 
-	if( mTexCoords )
-		delete [] mTexCoords;
-
-	if( mVertices )
-		delete [] mVertices;
+	// single frame coordinates are kept inline
+	_releaseFrames();
 
 	if( mTexture )
 		mTexture->drop();
 
-	qDebug() << "Success: [Actor] "<< mName << " destroyed";
+	qDebug() << "Success: [Actor] "<< NameTable::getInstance().getBase(mNameId) << NameTable::getSerial(mNameId) << " destroyed";
+}
+
+void *Actor::operator new( size_t pSize )
+{
+	void *lBlock = gPool->alloc(pSize);
+
+	// same as the global operator new, never hand out 0
+	if( !lBlock )
+		throw std::bad_alloc();
+
+	return lBlock;
+}
+
+void Actor::operator delete( void *pBlock, size_t pSize )
+{
+	gPool->free(pBlock,pSize);
 }
 
 void Actor::setTexture(Texture *pTex)
@@ -183,9 +216,15 @@ void Actor::setPos(float pX, float pY)
 	// set physics properties
 	if( mBody )
 	{
+		//! not while the worker steps
+		mWorld->sync();
+
 		// screen space to world space
 		b2Vec2 lPos(S2W(pX,pY));
-		mBody->SetXForm(lPos,D2R(mRot));
+		mBody->SetXForm(lPos,D2R(mHot->mRot));
+
+		// teleported, nothing to interpolate
+		storeTransform();
 	}
 }
 
@@ -215,30 +254,30 @@ void Actor::center(float pW, float pH)
 
 void Actor::moveXY( float pDX, float pDY )
 {
-	_setPos(mPos[0]+pDX,mPos[1]+pDY);
+	_setPos(mHot->mPos[0]+pDX,mHot->mPos[1]+pDY);
 }
 
 bool Actor::inRect( float pX, float pY )
 {
-	return( (mPos[0] <= pX) && (pX <= (mPos[0]+mSize[0])) &&
-			(mPos[1] <= pY) && (pY <= (mPos[1]+mSize[1])) );
+	return( (mHot->mPos[0] <= pX) && (pX <= (mHot->mPos[0]+mSize[0])) &&
+			(mHot->mPos[1] <= pY) && (pY <= (mHot->mPos[1]+mSize[1])) );
 }
 
 float Actor::getPosX( void ) const
 {
-	return mPos[0];
+	return mHot->mPos[0];
 }
 
 float Actor::getPosY( void ) const
 {
-	return mPos[1];
+	return mHot->mPos[1];
 }
 
 void Actor::getPos( t_point *pPos )
 {
 	Q_ASSERT( pPos != 0 );
-	(*pPos)[0] = mPos[0];
-	(*pPos)[1] = mPos[1];
+	(*pPos)[0] = mHot->mPos[0];
+	(*pPos)[1] = mHot->mPos[1];
 }
 
 float Actor::getWidth( void ) const
@@ -289,32 +328,37 @@ float Actor::getRadius( void ) const
 
 void Actor::setFlag( unsigned long pFlag )
 {
-	mFlags |= pFlag;
+	mHot->mFlags |= pFlag;
 }
 
 bool Actor::isFlag(unsigned long pFlag) const
 {
-	return (mFlags & pFlag);
+	return (mHot->mFlags & pFlag);
 }
 
 void Actor::setFlags( unsigned long pFlags )
 {
-	mFlags = pFlags;
+	mHot->mFlags = pFlags;
 }
 
 void Actor::removeFlag( unsigned long pFlag )
 {
-	mFlags &= ~pFlag;
+	mHot->mFlags &= ~pFlag;
 }
 
 unsigned long Actor::getFlags( void ) const
 {
-	return mFlags;
+	return mHot->mFlags;
 }
 
 void Actor::setZOrder(float pZ)
 {
+	// keep the world's draw order up to date
+	if( mWorld && mHandle )
+		mWorld->_reorderActor(this,pZ);
+
 	mZ = pZ;
+	mAutoZ = false;
 }
 
 float Actor::getZOrder( void ) const
@@ -327,15 +371,23 @@ void Actor::setNumFrames( short pNumFrames )
 	if( !mTexture && mNumFrames > 1 )
 		return;
 
-	// delete the existing pre-calc
-	if( mTexCoords )
-		delete [] mTexCoords;
+	// drop the existing pre-calc, actors spawned from this one keep theirs
+	_releaseFrames();
 
 	mNumFrames = pNumFrames;
 	setFrame(0);
 
 	// pre-calc all texture coordinates
-	mTexCoords = new t_texcoords[ mNumFrames ];
+	mTexCoords = &mTexCoord;
+
+	if( mNumFrames > 1 )
+	{
+		mFrames = new t_frames;
+		mFrames->mRefCount = 1;
+		mFrames->mCoords = new t_texcoords[ mNumFrames ];
+
+		mTexCoords = mFrames->mCoords;
+	}
 
 	if( mNumFrames == 1 )
 	{
@@ -417,18 +469,18 @@ void Actor::setFrame( short pFrame )
 	{
 		if( mFrameLoop ) // go back to the 1st frame
 		{
-			mFrame = 0;
+			mHot->mFrame = 0;
 		}
 	}
 	else // set the actual frame
 	{
-		mFrame = pFrame;
+		mHot->mFrame = pFrame;
 	}
 }
 
 short Actor::getFrame( void ) const
 {
-	return mFrame;
+	return mHot->mFrame;
 }
 
 void Actor::setFrameSize(float pX,float pY,float pW,float pH)
@@ -461,19 +513,19 @@ void Actor::_draw(void)
 {
 	glPushMatrix();
 
-	glTranslatef(mDPos[0],mDPos[1],0.0f);
-	glRotatef(mRot,0.0f,0.0f,1.0f);
+	glTranslatef(mRPos[0],mRPos[1],0.0f);
+	glRotatef(mRRot,0.0f,0.0f,1.0f);
 
 #ifdef WORLD_VERTEX_ARRAYS
-	glTexCoordPointer(2,GL_FLOAT,0,mTexCoords[mFrame]);
+	glTexCoordPointer(2,GL_FLOAT,0,mTexCoords[mHot->mFrame]);
 	glVertexPointer(2,GL_FLOAT,0,mVertices);
 	glDrawArrays(GL_TRIANGLE_FAN,0,4);
 #else
 	glBegin(GL_TRIANGLE_FAN);
-	glTexCoord2fv(mTexCoords[mFrame][P_BL]); glVertex2f( -mHSize[0],  -mHSize[1] );
-	glTexCoord2fv(mTexCoords[mFrame][P_BR]); glVertex2f(  mHSize[0],  -mHSize[1] );
-	glTexCoord2fv(mTexCoords[mFrame][P_TR]); glVertex2f(  mHSize[0],   mHSize[1] );
-	glTexCoord2fv(mTexCoords[mFrame][P_TL]); glVertex2f( -mHSize[0],   mHSize[1] );
+	glTexCoord2fv(mTexCoords[mHot->mFrame][P_BL]); glVertex2f( -mHSize[0],  -mHSize[1] );
+	glTexCoord2fv(mTexCoords[mHot->mFrame][P_BR]); glVertex2f(  mHSize[0],  -mHSize[1] );
+	glTexCoord2fv(mTexCoords[mHot->mFrame][P_TR]); glVertex2f(  mHSize[0],   mHSize[1] );
+	glTexCoord2fv(mTexCoords[mHot->mFrame][P_TL]); glVertex2f( -mHSize[0],   mHSize[1] );
 	glEnd();
 #endif
 
@@ -488,8 +540,8 @@ void Actor::_drawDebug(void)
 
 	glPushMatrix();
 
-	glTranslatef(mDPos[0],mDPos[1],0.0f);
-	glRotatef(mRot,0.0f,0.0f,1.0f);
+	glTranslatef(mRPos[0],mRPos[1],0.0f);
+	glRotatef(mRRot,0.0f,0.0f,1.0f);
 
 	glBegin(GL_LINE_LOOP);
 	if( float lR = getRadius() ) // draw spheres
@@ -535,12 +587,27 @@ void Actor::_drawTextured(void)
 	mTexture->disable();
 }
 
+int Actor::getStateChanges( void ) const
+{
+	if( mHot->mFlags & V_HIDDEN )
+		return 0;
+
+	// _drawTextured() binds and unbinds, _drawBlended() sets and resets
+	return ((mTexture)?2:0) + ((mBlending != B_NONE)?2:0);
+}
+
 void Actor::render(void)
 {
+#ifdef WORLD_HEADLESS // nothing to draw into
+	return;
+#endif
+
 	// don't render if it's not visible!
-	if( mFlags & V_HIDDEN )
+	if( mHot->mFlags & V_HIDDEN )
 		return;
 
+	_interpolate();
+
 	// custom color with transparency
 	glColor4fv(mColor);
 	_drawBlended();
@@ -551,13 +618,67 @@ void Actor::render(void)
 #endif
 }
 
+void Actor::batch(SpriteBatch *pBatch)
+{
+	Q_ASSERT( pBatch != 0 );
+
+	if( mHot->mFlags & V_HIDDEN )
+		return;
+
+	// whatever else render() draws has to be drawn in order
+	if( !isBatchable() )
+	{
+		pBatch->flush();
+		render();
+		return;
+	}
+
+#ifdef WORLD_DEBUG_DRAW // the outline goes right on top of the sprite
+	if( gEnv->mDebugDraw )
+	{
+		pBatch->flush();
+		render();
+		return;
+	}
+#endif
+
+	_interpolate();
+
+	pBatch->add(mTexture,mBlending,mVertices,mTexCoords[mHot->mFrame],mColor,mRPos,mRRot);
+}
+
+bool Actor::isBatchable( void ) const
+{
+	// a subclass could have its own render()
+	return (typeid(*this) == typeid(Actor));
+}
+
+void Actor::_interpolate(void)
+{
+	if( mBody && mWorld ) // blend the last two physics steps
+	{
+		const float lAlpha = mWorld->getAlpha();
+
+		mRPos[0] = mHot->mPrevPos[0] + (mHot->mDPos[0] - mHot->mPrevPos[0]) * lAlpha;
+		mRPos[1] = mHot->mPrevPos[1] + (mHot->mDPos[1] - mHot->mPrevPos[1]) * lAlpha;
+		mRRot = mHot->mPrevRot + (mHot->mRot - mHot->mPrevRot) * lAlpha;
+	}
+	else
+	{
+		mRPos[0] = mHot->mDPos[0];
+		mRPos[1] = mHot->mDPos[1];
+		mRRot = mHot->mRot;
+	}
+}
+
 void Actor::update(void)
 {
 	// don't update if it was requested
-	if( mFlags & U_NOUPDATE )
+	if( mHot->mFlags & U_NOUPDATE )
 		return;
 
-	if( mBody ) // update PhysX body
+	// registered ones are pulled in one go by the World
+	if( mBody && mHot == &mLocal ) // update PhysX body
 	{
 		b2Vec2 lPos = mBody->GetPosition();
 
@@ -578,7 +699,7 @@ void Actor::update(void)
 	if( mNumFrames >= 1 )
 	{
 		// increment by one
-		setFrame(mFrame+1);
+		setFrame(mHot->mFrame+1);
 	}
 	else
 	{
@@ -587,29 +708,293 @@ void Actor::update(void)
 	}
 }
 
+void Actor::storeTransform(void)
+{
+	if( !mBody )
+		return;
+
+	b2Vec2 lPos = mBody->GetPosition();
+	storeTransform(W2S_(lPos.x),W2S_(lPos.y),R2D(mBody->GetAngle()));
+}
+
+void Actor::storeTransform(float pX, float pY, float pRot)
+{
+	mHot->mPrevPos[0] = pX;
+	mHot->mPrevPos[1] = pY;
+	mHot->mPrevRot = pRot;
+}
+
+void Actor::saveState(t_state *pState) const
+{
+	Q_ASSERT( pState != 0 );
+
+	memcpy(pState->mPos,mHot->mPos,sizeof(t_point));
+	memcpy(pState->mDPos,mHot->mDPos,sizeof(t_point));
+	memcpy(pState->mPrevPos,mHot->mPrevPos,sizeof(t_point));
+
+	pState->mRot = mHot->mRot;
+	pState->mPrevRot = mHot->mPrevRot;
+	pState->mFlags = mHot->mFlags;
+	pState->mFrame = mHot->mFrame;
+	pState->mFrameLoop = mFrameLoop;
+	pState->mAnimate = mAnimate;
+	pState->mFrameCounter = mFrameCounter;
+
+	memcpy(pState->mColor,mColor,sizeof(t_vec4));
+}
+
+void Actor::restoreState(const t_state *pState)
+{
+	Q_ASSERT( pState != 0 );
+
+	memcpy(mHot->mPos,pState->mPos,sizeof(t_point));
+	memcpy(mHot->mDPos,pState->mDPos,sizeof(t_point));
+	memcpy(mHot->mPrevPos,pState->mPrevPos,sizeof(t_point));
+
+	mHot->mRot = pState->mRot;
+	mHot->mPrevRot = pState->mPrevRot;
+	mHot->mFlags = pState->mFlags;
+	mHot->mFrame = pState->mFrame;
+	mFrameLoop = pState->mFrameLoop;
+	mAnimate = pState->mAnimate;
+	mFrameCounter = pState->mFrameCounter;
+
+	memcpy(mColor,pState->mColor,sizeof(t_vec4));
+
+	_invalidateBounds();
+}
+
+void Actor::saveRecord(t_record *pRecord) const
+{
+	Q_ASSERT( pRecord != 0 );
+
+	memset(pRecord,0,sizeof(t_record));
+
+	// always zero terminated
+	strncpy(pRecord->mName,NameTable::getInstance().toString(mNameId).toLatin1().constData(),sizeof(pRecord->mName)-1);
+
+	if( mTexture )
+		strncpy(pRecord->mTexture,mTexture->getName().toLatin1().constData(),sizeof(pRecord->mTexture)-1);
+
+	if( mBody ) // the body knows best, back to top left
+	{
+		b2Vec2 lPos = mBody->GetPosition();
+
+		pRecord->mPos[0] = W2S_(lPos.x) - mHSize[0];
+		pRecord->mPos[1] = W2S_(lPos.y) - mHSize[1];
+		pRecord->mRot = R2D(mBody->GetAngle());
+	}
+	else
+	{
+		memcpy(pRecord->mPos,mHot->mPos,sizeof(t_point));
+		pRecord->mRot = mHot->mRot;
+	}
+
+	memcpy(pRecord->mSize,mSize,sizeof(t_point));
+	memcpy(pRecord->mOffsets,mOffsets,sizeof(t_point));
+	pRecord->mZ = mZ;
+
+	pRecord->mFlags = mHot->mFlags;
+	pRecord->mLayer = mLayer;
+	pRecord->mBlending = mBlending;
+	memcpy(pRecord->mColor,mColor,sizeof(t_vec4));
+
+	memcpy(pRecord->mFrameRect,mFrameRect,sizeof(t_rect));
+	pRecord->mNumFrames = mNumFrames;
+	pRecord->mFrame = mHot->mFrame;
+	pRecord->mFrameLoop = mFrameLoop;
+	pRecord->mAnimate = mAnimate;
+
+	pRecord->mDensity = mShapeDef.density;
+	pRecord->mFriction = mShapeDef.friction;
+	pRecord->mRestitution = mShapeDef.restitution;
+
+	if( mBody )
+	{
+		b2Vec2 lVel = mBody->GetLinearVelocity();
+
+		pRecord->mPhysical = 1;
+		pRecord->mVelocity[0] = lVel.x;
+		pRecord->mVelocity[1] = lVel.y;
+		pRecord->mSpin = mBody->GetAngularVelocity();
+	}
+
+	if( mHot->mFlags & S_CUSTOM )
+	{
+		pRecord->mNumVertices = mShapeDef.vertexCount;
+
+		// back into screen space (see setShape())
+		for(int i=0;i<mShapeDef.vertexCount;i++)
+		{
+			pRecord->mVertices[i][0] = W2S_(mShapeDef.vertices[i].x) + mOffsets[0];
+			pRecord->mVertices[i][1] = W2S_(mShapeDef.vertices[i].y) + mOffsets[1];
+		}
+	}
+}
+
+void Actor::loadRecord(const t_record *pRecord)
+{
+	Q_ASSERT( pRecord != 0 );
+
+	if( pRecord->mTexture[0] )
+		setTexture(QString::fromLatin1(pRecord->mTexture));
+
+	// frames first, setTexture() resets them
+	setFrameSize(pRecord->mFrameRect[0],pRecord->mFrameRect[1],pRecord->mFrameRect[2],pRecord->mFrameRect[3]);
+
+	if( mTexture && pRecord->mNumFrames > 1 )
+		setNumFrames(pRecord->mNumFrames);
+
+	setFrame(pRecord->mFrame);
+	setAnimate(pRecord->mAnimate,pRecord->mFrameLoop);
+
+	setFlags(pRecord->mFlags);
+	setOffsets(pRecord->mOffsets[0],pRecord->mOffsets[1]);
+	setRect(pRecord->mPos[0],pRecord->mPos[1],pRecord->mSize[0],pRecord->mSize[1]);
+	setRotation(pRecord->mRot);
+	setZOrder(pRecord->mZ);
+
+	setLayer(pRecord->mLayer);
+	setBlending((t_blend)pRecord->mBlending);
+	memcpy(mColor,pRecord->mColor,sizeof(t_vec4));
+
+	setDensity(pRecord->mDensity);
+	setFriction(pRecord->mFriction);
+	setRestituition(pRecord->mRestitution);
+
+	if( pRecord->mNumVertices > 0 )
+		setShape(pRecord->mVertices,pRecord->mNumVertices);
+
+	if( !pRecord->mPhysical )
+		return;
+
+	applyPhysX();
+
+	mBody->SetLinearVelocity(b2Vec2(pRecord->mVelocity[0],pRecord->mVelocity[1]));
+	mBody->SetAngularVelocity(pRecord->mSpin);
+}
+
+void Actor::_applyPrefab( const Prefab *pPrefab, float pX, float pY )
+{
+	Q_ASSERT( pPrefab != 0 );
+
+	const Actor *lFrom = pPrefab->getActor();
+	mPrefab = pPrefab;
+
+	// no lookup, only a reference
+	if( mTexture )
+		mTexture->drop();
+
+	mTexture = lFrom->mTexture ? lFrom->mTexture->grab() : 0;
+
+	// texture coordinates, inline or shared with the prefab
+	_releaseFrames();
+
+	memcpy(mTexCoord,lFrom->mTexCoord,sizeof(t_texcoords));
+	mTexCoords = (lFrom->mTexCoords)?&mTexCoord:0;
+
+	if( lFrom->mFrames )
+	{
+		mFrames = lFrom->mFrames;
+		mFrames->mRefCount++;
+
+		mTexCoords = mFrames->mCoords;
+	}
+
+	mNumFrames = lFrom->mNumFrames;
+	memcpy(mFrameRect,lFrom->mFrameRect,sizeof(t_rect));
+	mFrameLoop = lFrom->mFrameLoop;
+	mAnimate = lFrom->mAnimate;
+	mFrameCounter = 0.0f;
+
+	mHot->mFlags = lFrom->mHot->mFlags;
+	mHot->mFrame = lFrom->mHot->mFrame;
+	mHot->mRot = lFrom->mHot->mRot;
+
+	memcpy(mOffsets,lFrom->mOffsets,sizeof(t_point));
+	memcpy(mColor,lFrom->mColor,sizeof(t_vec4));
+	mBlending = lFrom->mBlending;
+	mLayer = lFrom->mLayer;
+	mShapeDef = lFrom->mShapeDef;
+
+	// unregistered, no need to tell the World
+	setZOrder(lFrom->mZ);
+
+	_setSize(lFrom->mSize[0],lFrom->mSize[1]);
+	_setPos(pX,pY);
+
+	if( pPrefab->isPhysical() )
+		_createBody(pPrefab->getShapeDef(),pPrefab->getCullMargin());
+}
+
+void Actor::_revive( float pX, float pY, float pRot )
+{
+	_setRotation(pRot);
+	_setPos(pX,pY);
+
+	if( !mBody )
+		return;
+
+	// still inactive, nothing moves in the broadphase yet
+	mBody->SetXForm(b2Vec2(S2W((pX+mHSize[0]),(pY+mHSize[1]))),D2R(pRot));
+	mBody->SetLinearVelocity(b2Vec2(0.0f,0.0f));
+	mBody->SetAngularVelocity(0.0f);
+	mBody->SetActive(true);
+
+	//! Nothing to interpolate from yet
+	storeTransform();
+}
+
 void Actor::setName( const QString &pName )
 {
+	_setNameId(NameTable::getInstance().intern(pName));
+
 	mName = pName;
-	mId = qHash(pName);
+	mNameStale = false;
 }
 
 QString &Actor::getName( void )
 {
+	if( mNameStale )
+	{
+		mName = NameTable::getInstance().toString(mNameId);
+		mNameStale = false;
+	}
+
 	return mName;
 }
 
+void Actor::_setNameId( t_name pName )
+{
+	// keep the world's name index up to date
+	if( mWorld && mHandle )
+		mWorld->_renameActor(this,pName);
+
+	mNameId = pName;
+	mNameStale = true;
+	mId = qHash(pName);
+}
+
 unsigned int Actor::getId( void ) const
 {
 	return mId;
 }
 
+void Actor::setBody(b2Body *pBody)
+{
+	mBody = mHot->mBody = pBody;
+
+	// leaves / joins the World's grid of non-physical actors
+	_invalidateBounds();
+}
+
 void Actor::setShape(const t_point *pVerts, unsigned short pNumVerts)
 {
 	Q_ASSERT( pVerts != 0	);
 	Q_ASSERT( pNumVerts > 0 );
 
 	//! Set only when possible
-	if( !(mFlags & S_CUSTOM) )
+	if( !(mHot->mFlags & S_CUSTOM) )
 		return;
 
 	// copy over the vertices
@@ -639,6 +1024,35 @@ void Actor::setRestituition( float pRest )
 	mShapeDef.restitution = pRest;
 }
 
+void Actor::setLayer( int pLayer )
+{
+	Q_ASSERT( pLayer >= 0 && pLayer < WORLD_MAX_LAYERS );
+
+	if( mLayer == pLayer )
+		return;
+
+	mLayer = pLayer;
+
+	//! already simulated? update the shapes right away
+	if( mBody && mWorld )
+		mWorld->refilterActor(this);
+}
+
+void Actor::setLayer( const QString &pName )
+{
+	Q_ASSERT( mWorld != 0 );
+
+	int lLayer = mWorld->addLayer(pName);
+
+	if( lLayer < 0 )
+	{
+		qDebug() << "Warning: [Actor] No room for layer " << pName;
+		return;
+	}
+
+	setLayer(lLayer);
+}
+
 void Actor::applyPhysX(void)
 {
 	Q_ASSERT( mWorld != 0 );
@@ -647,56 +1061,95 @@ void Actor::applyPhysX(void)
 	if( mBody )
 		removePhysX();
 
-	b2BodyDef lBodyDef;
-	b2World *lWorld = mWorld->getPhysicsWorld();
+	b2CircleDef lCircleDef;
+	const b2ShapeDef *lShapeDef = _buildShape(&lCircleDef);
 
-	//! Set initial rotation
-	lBodyDef.angle = D2R(mRot);
-	//! Set initial position
-	lBodyDef.position.Set(S2W((mPos[0]+mHSize[0]),(mPos[1]+mHSize[1])));
+	_createBody(lShapeDef,_getCullMargin());
+}
+
+const b2ShapeDef *Actor::_buildShape( b2CircleDef *pCircleDef )
+{
+	Q_ASSERT( mWorld != 0 );
+	Q_ASSERT( pCircleDef != 0 );
 
-	mBody = lWorld->CreateBody(&lBodyDef);
+	//! Collision layer
+	mWorld->getLayerFilter(mLayer,&mShapeDef.filter);
 
 	if( isFlag(S_CUSTOM) )
 	{
+		//! use the predefined shape
 		if( isShapeSet() )
-		{
-			//! use the predefined shape
-			mBody->CreateShape(&mShapeDef);
-		}
-		else
-		{
-			qDebug() << "Warning: [Actor] Custom Shape but no vertices set";
-			setFlag(S_BOX); // fallback to BOX
-		}
-	}
+			return &mShapeDef;
 
-	if( isFlag(S_BOX) )
-	{
-		//! Set Shape
-		mShapeDef.SetAsBox(S2W((mHSize[0]-mOffsets[0]),(mHSize[1]-mOffsets[1])));
-		mBody->CreateShape(&mShapeDef);
+		qDebug() << "Warning: [Actor] Custom Shape but no vertices set";
+		setFlag(S_BOX); // fallback to BOX
 	}
-	else if( isFlag(S_CIRCLE) )
+
+	if( isFlag(S_CIRCLE) )
 	{
-		b2CircleDef lShapeDef;
 		// copy them over
-		lShapeDef.restitution = mShapeDef.restitution;
-		lShapeDef.density = mShapeDef.density;
-		lShapeDef.friction = mShapeDef.friction;
+		pCircleDef->restitution = mShapeDef.restitution;
+		pCircleDef->density = mShapeDef.density;
+		pCircleDef->friction = mShapeDef.friction;
+		pCircleDef->filter = mShapeDef.filter;
 		//! Set Shape
-		lShapeDef.radius = S2W_((getRadius()-mOffsets[0]));
-		mBody->CreateShape(&lShapeDef);
+		pCircleDef->radius = S2W_((getRadius()-mOffsets[0]));
 		//! Fake it, not used anyway :)
 		mShapeDef.vertexCount = 1;
+
+		return pCircleDef;
 	}
 
+	//! Set Shape
+	mShapeDef.SetAsBox(S2W((mHSize[0]-mOffsets[0]),(mHSize[1]-mOffsets[1])));
+	return &mShapeDef;
+}
+
+float Actor::_getCullMargin( void ) const
+{
+	//! How far the sprite may stick out of the shape's AABB (culling)
+	float lInner = 0.0f; // a circle surely inside the shape
+
+	if( isFlag(S_CUSTOM) )
+		lInner = 0.0f;
+	else if( isFlag(S_BOX) )
+		lInner = qMin(mHSize[0]-mOffsets[0],mHSize[1]-mOffsets[1]);
+	else if( isFlag(S_CIRCLE) )
+		lInner = getRadius()-mOffsets[0];
+
+	return sqrtf(mHSize[0]*mHSize[0] + mHSize[1]*mHSize[1]) - lInner;
+}
+
+void Actor::_createBody( const b2ShapeDef *pShapeDef, float pCullMargin )
+{
+	Q_ASSERT( mWorld != 0 );
+	Q_ASSERT( pShapeDef != 0 );
+
+	b2BodyDef lBodyDef;
+	b2World *lWorld = mWorld->getPhysicsWorld();
+
+	//! the b2World is locked while the worker steps
+	mWorld->sync();
+
+	//! Set initial rotation
+	lBodyDef.angle = D2R(mHot->mRot);
+	//! Set initial position
+	lBodyDef.position.Set(S2W((mHot->mPos[0]+mHSize[0]),(mHot->mPos[1]+mHSize[1])));
+
+	setBody(lWorld->CreateBody(&lBodyDef));
+	mBody->CreateShape(const_cast<b2ShapeDef *>(pShapeDef));
+
 	// auto-calc mass if density set (i.e > 0)
-	if( mShapeDef.density )
+	if( pShapeDef->density )
 		mBody->SetMassFromShapes();
 
 	//! Store itself as userData
 	mBody->SetUserData(this);
+
+	mWorld->_growCullMargin(pCullMargin);
+
+	//! Nothing to interpolate from yet
+	storeTransform();
 }
 
 void Actor::removePhysX(void)
@@ -704,7 +1157,7 @@ void Actor::removePhysX(void)
 	Q_ASSERT( mWorld != 0 );
 
 	if( mWorld->removeActorBody(this) )
-		mBody = 0;
+		setBody(0);
 }
 
 void Actor::removeJoint(void)
@@ -719,23 +1172,16 @@ bool Actor::isFrozen(void) const
 	if( !mBody )
 		return false;
 
+	mWorld->sync();
 	return mBody->IsFrozen();
 }
 
-void Actor::setHasJoints( bool pState )
-{
-	mHasJoints = pState;
-}
-
-bool Actor::hasJoints( void ) const
-{
-	return mHasJoints;
-}
-
 void Actor::applyForce(const float pX, const float pY, const bool pMass)
 {
 	Q_ASSERT( mBody != 0 );
 
+	mWorld->sync();
+
 	const float lM = mBody->GetMass();
 	const float lX = (pMass)?pX*lM:pX;
 	const float lY = (pMass)?pY*lM:pY;
@@ -746,12 +1192,16 @@ void Actor::applyForce(const float pX, const float pY, const bool pMass)
 void Actor::applyImpulse(const float pX, const float pY)
 {
 	Q_ASSERT( mBody != 0 );
+
+	mWorld->sync();
 	mBody->ApplyImpulse(b2Vec2(pX,pY),mBody->GetWorldCenter());
 }
 
 void Actor::applyTorque(const float pT)
 {
 	Q_ASSERT( mBody != 0 );
+
+	mWorld->sync();
 	mBody->ApplyTorque(pT);
 }
 
@@ -786,6 +1236,17 @@ void Actor::_setTexCoord( short pFrame, float pU, float pV, t_pos pPos )
 	mTexCoords[ pFrame ][ pPos ][ 1 ] = pV;
 }
 
+void Actor::_releaseFrames( void )
+{
+	if( mFrames && !--mFrames->mRefCount )
+	{
+		delete [] mFrames->mCoords;
+		delete mFrames;
+	}
+
+	mFrames = 0;
+}
+
 void Actor::_setVertex( t_point *pVertex, t_pos pPos )
 {
 	_setVertex((*pVertex)[0],(*pVertex)[1],pPos);
@@ -799,8 +1260,8 @@ void Actor::_setVertex( float pX, float pY, t_pos pPos )
 
 void Actor::_setPos(float pX, float pY)
 {
-	mDPos[0] = mPos[0] = pX;
-	mDPos[1] = mPos[1] = pY;
+	mHot->mDPos[0] = mHot->mPos[0] = pX;
+	mHot->mDPos[1] = mHot->mPos[1] = pY;
 
 	_setSize(-1,-1);
 }
@@ -818,11 +1279,6 @@ void Actor::_setSize(float pW, float pH)
 		mHSize[1] = mSize[1] / 2; // screen space
 
 		//! Setup Vertex Array
-		if( mVertices )
-			delete mVertices;
-
-		mVertices = new t_vertices[4];
-
 		_setVertex(-mHSize[0],-mHSize[1],P_BL);
 		_setVertex( mHSize[0],-mHSize[1],P_BR);
 		_setVertex( mHSize[0], mHSize[1],P_TR);
@@ -831,12 +1287,24 @@ void Actor::_setSize(float pW, float pH)
 
 	if( !mBody ) // no PhysX, draw centered
 	{
-		mDPos[0] = mPos[0] + mHSize[0];	// screen space
-		mDPos[1] = mPos[1] + mHSize[1];	// screen space
+		mHot->mDPos[0] = mHot->mPos[0] + mHSize[0];	// screen space
+		mHot->mDPos[1] = mHot->mPos[1] + mHSize[1];	// screen space
+
+		_invalidateBounds();
 	}
 }
 
+void Actor::_invalidateBounds( void )
+{
+	// once per frame is enough
+	if( !mWorld || !mHandle || mGridDirty )
+		return;
+
+	mGridDirty = true;
+	mWorld->_invalidateActor(this);
+}
+
 void Actor::_setRotation(float pRot)
 {
-	mRot = pRot;
+	mHot->mRot = pRot;
 }
@@ -38,16 +38,29 @@
 
 #include <QtOpenGL>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 
 #include "Box2D/Box2D.h"
 
 #include "types.h"
 #include "defines.h"
+#include "names.h"
 
 namespace GL {
 
 class Texture;
 class World;
+class ActorJoint;
+class Prefab;
+class SpriteBatch;
+
+//! Generation checked actor handle
+/*!
+	Slot index in the low and generation in the high
+	32 bits, 0 is never a valid handle. Resolve it with
+	World::findActor(), stale handles give back 0.
+*/
+typedef quint64 t_handle;
 
 class Actor
 {
@@ -55,6 +68,10 @@ public:
 	Actor(const QString &pName = "", World *pWorld = 0);
 	virtual ~Actor();
 
+	//! Actors of the same class share pooled blocks (see ActorPool)
+	static void *operator new( size_t pSize );
+	static void operator delete( void *pBlock, size_t pSize );
+
 	virtual void setTexture(Texture *pTex);
 	virtual void setTexture(const QString &pName);
 
@@ -95,9 +112,27 @@ public:
 	virtual void removeFlag( unsigned long pFlag );
 	virtual unsigned long getFlags( void ) const;
 
+	//! Draw order, lower Z-Orders are drawn first
+	/*!
+		Actors with the same Z-Order are drawn in
+		creation order, no sorting is ever needed.
+	*/
 	virtual void setZOrder(float pZ);
 	virtual float getZOrder( void ) const;
 
+	//! Render layer, what World::setSorting() may regroup
+	/*!
+		Neighbours in draw order on the same render layer
+		may swap places, as far as their blending allows.
+		R_DEFAULT has one layer per Z-Order, since every
+		actor createActor() makes gets its own Z-Order that
+		only groups actors given a Z-Order by hand. Any
+		other layer takes its actors regardless of their
+		Z-Order, opt in where the order doesn't matter.
+	*/
+	virtual void setRenderLayer( int pLayer ) { mRenderLayer = pLayer; }
+	virtual int getRenderLayer( void ) const { return mRenderLayer; }
+
 	virtual void setNumFrames( short pNumFrames );
 	virtual	short getNumFrames( void ) const;
 
@@ -111,29 +146,137 @@ public:
 	virtual void render(void);
 	virtual void update(void);
 
+	//! Texture binds and blend changes render() makes
+	virtual int getStateChanges( void ) const;
+
+	//! Queue into pBatch instead of drawing right away (see World::setBatching())
+	/*!
+		Unless isBatchable(), pBatch is flushed and
+		render() draws the actor as usual.
+	*/
+	virtual void batch(SpriteBatch *pBatch);
+
+	//! Whatever batch() may queue just the sprite
+	/*!
+		Only for plain Actors by default, a subclass might
+		draw more in render(). Subclasses which only draw
+		their sprite return true to be batched as well.
+	*/
+	virtual bool isBatchable( void ) const;
+
+	//! Keep the current body transform for render interpolation
+	virtual void storeTransform(void);
+	virtual void storeTransform(float pX, float pY, float pRot);
+
+	//! Plain copy of the per frame state of an actor
+	/*!
+		Used by World::saveState() / World::restoreState(),
+		the PhysX body is saved separately.
+	*/
+	typedef struct s_state
+	{
+		t_point mPos;
+		t_point mDPos;
+		t_point mPrevPos;
+
+		float mRot;
+		float mPrevRot;
+
+		unsigned long mFlags;
+
+		short mFrame;
+		bool mFrameLoop;
+		bool mAnimate;
+		float mFrameCounter;
+
+		t_vec4 mColor;
+	} t_state;
+
+	virtual void saveState(t_state *pState) const;
+	virtual void restoreState(const t_state *pState);
+
+	//! Everything needed to re-create a plain actor
+	/*!
+		Used by ChunkStreamer, unlike t_state it doesn't
+		need the same actor (or body) to be around, only
+		the texture (by name) and the collision layers.
+	*/
+	typedef struct s_record
+	{
+		char mName[32];
+		char mTexture[64];
+
+		t_point mPos;		// top left, screen space
+		t_point mSize;
+		t_point mOffsets;
+		float mRot;
+		float mZ;
+
+		quint32 mFlags;
+		qint32 mLayer;
+		qint32 mBlending;
+		t_vec4 mColor;
+
+		t_rect mFrameRect;
+		qint16 mNumFrames;
+		qint16 mFrame;
+		quint8 mFrameLoop;
+		quint8 mAnimate;
+
+		//! PhysX (only when mPhysical is set)
+		quint8 mPhysical;
+		float mDensity;
+		float mFriction;
+		float mRestitution;
+		t_point mVelocity;	// world space
+		float mSpin;
+
+		//! S_CUSTOM shapes
+		qint32 mNumVertices;
+		t_point mVertices[b2_maxPolygonVertices];
+	} t_record;
+
+	virtual void saveRecord(t_record *pRecord) const;
+	//! Apply a record to a fresh actor (creates its body too)
+	virtual void loadRecord(const t_record *pRecord);
+
 	virtual void setName( const QString &pName );
+	//! Built from the interned name on first use
 	virtual QString &getName( void );
-	virtual unsigned int getId( void ) const; //id == name hash
+	virtual t_name getNameId( void ) const { return mNameId; }
+	virtual unsigned int getId( void ) const; //id == interned name hash
+
+	//! Handle in the owning World (0 when not registered)
+	virtual t_handle getHandle( void ) const { return mHandle; }
 
 	// physics
 	virtual void setDensity( float pDens );
 	virtual void setFriction( float pFric );
 	virtual void setRestituition( float pRest );
 
+	//! Collision layer (see World::addLayer())
+	virtual void setLayer( int pLayer );
+	virtual void setLayer( const QString &pName );
+	virtual int getLayer( void ) const { return mLayer; }
+
+	//! Prefab it was spawned from, 0 if none
+	virtual const Prefab *getPrefab( void ) const { return mPrefab; }
+
 	virtual void applyPhysX(void);
 	virtual void removePhysX(void);
 	virtual void removeJoint(void);
 
 	virtual bool isFrozen(void) const;
 
-	virtual void setHasJoints( bool pState );
-	virtual bool hasJoints( void ) const;
+	virtual bool hasJoints( void ) const { return !mJoints.isEmpty(); }
+	//! Joints attached to this actor (see World::createJoint())
+	virtual const QVector<ActorJoint *> &getJoints( void ) const { return mJoints; }
 
 	virtual void applyForce(const float pX, const float pY, const bool pMass=true);
 	virtual void applyImpulse(const float pX, const float pY);
 	virtual void applyTorque(const float pT);
 
-	virtual void setBody(b2Body *pBody) { mBody = pBody; }
+	virtual void setBody(b2Body *pBody);
 	virtual b2Body *getBody( void ) const { return mBody; }
 
 	virtual void setShape(const t_point *pVerts, unsigned short pNumVerts);
@@ -149,6 +292,7 @@ public:
 	} t_blend;
 	// enable / disable blending
 	virtual void setBlending( t_blend pBlending );
+	virtual t_blend getBlending( void ) const { return mBlending; }
 	/*
 		255	= fully transparent
 		0	= opaque
@@ -176,6 +320,12 @@ public:
 		J_HASJOINTS= BIT(5) // reserved!
 	};
 
+	// render layers (see setRenderLayer())
+	enum
+	{
+		R_DEFAULT = 0
+	};
+
 protected:
 	typedef enum e_pos
 	{
@@ -187,6 +337,8 @@ protected:
 
 	virtual void _setTexCoord( short pFrame, t_point *pCoord, t_pos pPos );
 	virtual void _setTexCoord( short pFrame, float pU, float pV, t_pos pPos );
+	//! Let go of mFrames, the last one out deletes them
+	virtual void _releaseFrames( void );
 
 	virtual void _setVertex( t_point *pVertex, t_pos pPos );
 	virtual void _setVertex( float pX, float pY, t_pos pPos );
@@ -195,19 +347,67 @@ protected:
 	virtual void _setSize( float pW, float pH );
 	virtual void _setRotation( float pRot );
 
+	//! Moved or resized, let the World re-cull it
+	void _invalidateBounds( void );
+	//! Rename without building the string (see World::createActor())
+	void _setNameId( t_name pName );
+
+	//! Shape definition applyPhysX() creates the body from
+	/*!
+		Either mShapeDef or pCircleDef, override it to
+		build custom shapes (see Prefab::build() too).
+	*/
+	virtual const b2ShapeDef *_buildShape( b2CircleDef *pCircleDef );
+	//! How far the sprite may stick out of the shape's AABB
+	virtual float _getCullMargin( void ) const;
+	virtual void _createBody( const b2ShapeDef *pShapeDef, float pCullMargin );
+
+	//! Take over everything from a prefab, at pX,pY (see World::spawn())
+	virtual void _applyPrefab( const Prefab *pPrefab, float pX, float pY );
+	//! Back from a recycle bin at pX,pY (see World::reviveActor())
+	virtual void _revive( float pX, float pY, float pRot );
+
+	//! Render transform (mRPos, mRRot), between the last two physics steps
+	virtual void _interpolate(void);
+
 	virtual void _draw(void);
 	virtual void _drawDebug(void);
 	virtual void _drawTextured(void);
 	virtual void _drawBlended(void);
 
+	//! Per frame data touched by the update and render loops
+	/*!
+		Kept in the actor itself (mLocal) until it's
+		registered with a World, which moves it into
+		its own blocks (one per registry slot) and
+		points mHot there, see World::_registerActor().
+	*/
+	typedef struct s_hot
+	{
+		t_point mPos;	// screen space position
+		t_point mDPos;	// screen space drawing position
+		float mRot;		// store the actual rotation
+
+		//! Body transform before the last physics step
+		t_point mPrevPos;	// screen space
+		float mPrevRot;
+
+		unsigned long mFlags; // store various flags (bit based)
+		short mFrame;		  // the current frame
+
+		b2Body *mBody;	// same as Actor::mBody
+		Actor *mActor;	// owner, 0 for an unused block
+	} t_hot;
+
 protected:
 	//! Texture Assigned to the Actor
 	Texture *mTexture;
 
-	t_point mPos;	   // screen space position
-	t_point mSize;	   // screen space size
+	//! Hot data, either mLocal or a World block
+	t_hot *mHot;
+	t_hot mLocal;
 
-	t_point mDPos;	// screen space drawing position
+	t_point mSize;	   // screen space size
 	t_point mHSize; // screen space half width / half height
 
 	/*!
@@ -217,13 +417,13 @@ protected:
 	*/
 	t_point mOffsets; // screen space offsets ( mPos + mOffsets )
 
-	float mRot;	// store the actual rotation
 	float mZ; // z-order
 
-	unsigned long mFlags; // store various flags (bit based)
+	//! Interpolated transform used when drawing
+	t_point mRPos;	// screen space
+	float mRRot;
 
 	short mNumFrames;	// number of frames
-	short mFrame;		// the current frame
 
 	t_rect  mFrameRect;	// initial position + size of a frame
 	bool mFrameLoop;	// whatever loop frames or not
@@ -233,30 +433,62 @@ protected:
 	float mFrameCounter;
 
 	typedef t_point t_texcoords[4];
-	//! Texture Coordinate Array
+	//! Texture coordinates of more than one frame, shared with spawned actors
+	typedef struct s_frames
+	{
+		int mRefCount;
+		t_texcoords *mCoords;
+	} t_frames;
+
+	//! Texture Coordinate Array (mTexCoord for a single frame)
 	t_texcoords *mTexCoords;
+	t_texcoords mTexCoord;
+	//! Owner of mTexCoords, 0 when they're inline
+	t_frames *mFrames;
 
-	typedef t_point t_vertices;
 	//! Vertex Array
-	t_vertices *mVertices;
+	t_point mVertices[4];
 
 	//! Colors
 	t_vec4 mColor;
 
-	QString mName;
+	QString mName;		// stale while mNameStale is set
+	t_name mNameId;
+	bool mNameStale;
 	unsigned int mId;
+	t_handle mHandle;
+	//! Tie-break between equal Z-Orders (creation order)
+	unsigned int mDrawSeq;
+
+	//! Culling (see World::render())
+	unsigned int mCullStamp;	// last render() it was found visible
+	int mGridRect[4];			// cells covered (non-physical actors only)
+	bool mInGrid;
+	bool mGridDirty;
 
 	t_blend mBlending;
+	int mRenderLayer;
+	//! Z-Order not set by hand (see World::createActor(), World::spawn())
+	bool mAutoZ;
 
-	// TODO: move this into FLAGS
-	bool mHasJoints;
+	//! Joints attached (kept by ActorJoint)
+	QVector<ActorJoint *> mJoints;
 
 	// PhysX Body
 	b2Body *mBody;
 	b2PolygonDef mShapeDef;
+	int mLayer;
+
+	//! Spawned from (see World::spawn()), 0 if none
+	const Prefab *mPrefab;
 
 	//! Pointer to the World
 	World *mWorld;
+
+	friend class World;
+	friend class ActorJoint;
+	friend class Prefab;
+	friend class Scene;
 };
 
 /* GL */ }
@@ -43,8 +43,13 @@
 using namespace GL;
 
 ActorJoint::ActorJoint(const QString &pName, World *pWorld) :	mName(pName),
-																mId(qHash(pName)),
+																mNameId(NameTable::getInstance().intern(pName)),
+																mNameStale(false),
+																mId(qHash(mNameId)),
+																mHandle(0),
 																mJoint(0),
+																mActor1(0),
+																mActor2(0),
 																mWorld(pWorld)
 {
 	Q_ASSERT( mWorld != 0 );
@@ -56,11 +61,19 @@ ActorJoint::~ActorJoint()
 {
 	shutdown();
 
+	mWorld->_unregisterJoint(this);
+
 	qDebug() << "Success: [ActorJoint] " << mName << "destroyed";
 }
 
 QString &ActorJoint::getName(void)
 {
+	if( mNameStale )
+	{
+		mName = NameTable::getInstance().toString(mNameId);
+		mNameStale = false;
+	}
+
 	return mName;
 }
 
@@ -69,7 +82,7 @@ unsigned int ActorJoint::getId(void) const
 	return mId;
 }
 
-b2RevoluteJoint *ActorJoint::getJoint(void) const
+b2Joint *ActorJoint::getJoint(void) const
 {
 	return mJoint;
 }
@@ -85,21 +98,11 @@ ActorJoint *ActorJoint::init(Actor *pA1,Actor *pA2,const float pX,const float pY
 
 	b2RevoluteJointDef lJointDef;
 	lJointDef.collideConnected = true;
-	lJointDef.userData = this;
-
-	// mark them
-	if( pA1 )
-		pA1->setHasJoints(true);
-
-	if( pA2 )
-		pA2->setHasJoints(true);
 
 	// grab bodies & initialize
 	lJointDef.Initialize(pA1->getBody(),pA2->getBody(),b2Vec2(S2W(pX,pY)));
 
-	b2World *lWorld = mWorld->getPhysicsWorld();
-	mJoint = static_cast<b2RevoluteJoint *>(lWorld->CreateJoint(&lJointDef));
-	return this;
+	return _create(&lJointDef,pA1,pA2);
 }
 
 ActorJoint *ActorJoint::init(Actor *pA1,Actor *pA2)
@@ -113,47 +116,212 @@ ActorJoint *ActorJoint::init(Actor *pA1,Actor *pA2)
 
 	b2RevoluteJointDef lJointDef;
 	lJointDef.collideConnected = true;
-	lJointDef.userData = this;
 
 	// grab bodies
 	lJointDef.body1 = pA1->getBody();
 	lJointDef.body2 = pA2->getBody();
 
-	// mark them
-	if( pA1 )
-		pA1->setHasJoints(true);
+	return _create(&lJointDef,pA1,pA2);
+}
+
+void ActorJoint::shutdown(void)
+{
+	if( !mJoint )
+		return;
 
-	if( pA2 )
-		pA2->setHasJoints(true);
+	// gears go first, they point at this joint
+	while( !mGears.isEmpty() )
+		delete mGears.last();
+
+	_detach(mActor1);
+	_detach(mActor2);
+
+	mJoint->SetUserData(0);
 
-	// initialize
 	b2World *lWorld = mWorld->getPhysicsWorld();
-	mJoint = static_cast<b2RevoluteJoint *>(lWorld->CreateJoint(&lJointDef));
+	lWorld->DestroyJoint(mJoint);
+
+	mJoint = 0;
+}
+
+void ActorJoint::release(void)
+{
+	mJoint = 0;
+
+	mActor1 = 0;
+	mActor2 = 0;
+	mGears.clear();
+}
+
+ActorJoint *ActorJoint::_create(b2JointDef *pDef, Actor *pA1, Actor *pA2)
+{
+	Q_ASSERT( pDef != 0 );
+
+	pDef->userData = this;
+
+	b2World *lWorld = mWorld->getPhysicsWorld();
+	mJoint = lWorld->CreateJoint(pDef);
+
+	// both actors know about it
+	mActor1 = pA1;
+	mActor2 = pA2;
+
+	if( mActor1 )
+		mActor1->mJoints.push_back(this);
+
+	if( mActor2 && mActor2 != mActor1 )
+		mActor2->mJoints.push_back(this);
+
 	return this;
 }
 
-void ActorJoint::shutdown(void)
+void ActorJoint::_setNameId(t_name pName)
+{
+	// keep the world's name index up to date
+	if( mHandle )
+		mWorld->_renameJoint(this,pName);
+
+	mNameId = pName;
+	mNameStale = true;
+	mId = qHash(pName);
+}
+
+void ActorJoint::_detach(Actor *pActor)
+{
+	if( !pActor )
+		return;
+
+	int lIndex = pActor->mJoints.indexOf(this);
+
+	if( lIndex != -1 )
+		pActor->mJoints.remove(lIndex);
+
+	if( pActor == mActor1 )
+		mActor1 = 0;
+
+	if( pActor == mActor2 )
+		mActor2 = 0;
+}
+
+ActorJoint *DistanceJoint::init(Actor *pA1,Actor *pA2,
+								const float pX1,const float pY1,
+								const float pX2,const float pY2,
+								const float pFrequency,const float pDamping)
+{
+	Q_ASSERT( pA1 != 0 );
+	Q_ASSERT( pA2 != 0 );
+
+	if( mJoint )
+		return this;
+
+	b2DistanceJointDef lJointDef;
+	lJointDef.Initialize(pA1->getBody(),pA2->getBody(),b2Vec2(S2W(pX1,pY1)),b2Vec2(S2W(pX2,pY2)));
+	lJointDef.frequencyHz = pFrequency;
+	lJointDef.dampingRatio = pDamping;
+
+	return _create(&lJointDef,pA1,pA2);
+}
+
+ActorJoint *PrismaticJoint::init(Actor *pA1,Actor *pA2,
+								 const float pX,const float pY,
+								 const float pAX,const float pAY)
+{
+	Q_ASSERT( pA1 != 0 );
+	Q_ASSERT( pA2 != 0 );
+
+	if( mJoint )
+		return this;
+
+	b2Vec2 lAxis(pAX,pAY);
+	lAxis.Normalize();
+
+	b2PrismaticJointDef lJointDef;
+	lJointDef.Initialize(pA1->getBody(),pA2->getBody(),b2Vec2(S2W(pX,pY)),lAxis);
+
+	return _create(&lJointDef,pA1,pA2);
+}
+
+void PrismaticJoint::setLimits(const float pLower, const float pUpper)
 {
 	if( !mJoint )
 		return;
 
-	b2Body *lBody1 = mJoint->GetBody1();
-	b2Body *lBody2 = mJoint->GetBody2();
+	b2PrismaticJoint *lJoint = static_cast<b2PrismaticJoint *>(mJoint);
+	lJoint->SetLimits(S2W_(pLower),S2W_(pUpper));
+	lJoint->EnableLimit(true);
+}
 
-	if( lBody1->GetUserData() )
-	{
-		Actor *lActor = static_cast<Actor *>(lBody1->GetUserData());
-		lActor->setHasJoints(false);
-	}
+ActorJoint *PulleyJoint::init(Actor *pA1,Actor *pA2,
+							  const float pGX1,const float pGY1,
+							  const float pGX2,const float pGY2,
+							  const float pX1,const float pY1,
+							  const float pX2,const float pY2,
+							  const float pRatio)
+{
+	Q_ASSERT( pA1 != 0 );
+	Q_ASSERT( pA2 != 0 );
 
-	if( lBody2->GetUserData() )
-	{
-		Actor *lActor = static_cast<Actor *>(lBody2->GetUserData());
-		lActor->setHasJoints(false);
-	}
+	if( mJoint )
+		return this;
 
-	mJoint->SetUserData(0);
+	b2PulleyJointDef lJointDef;
+	lJointDef.Initialize(pA1->getBody(),pA2->getBody(),
+						 b2Vec2(S2W(pGX1,pGY1)),b2Vec2(S2W(pGX2,pGY2)),
+						 b2Vec2(S2W(pX1,pY1)),b2Vec2(S2W(pX2,pY2)),
+						 pRatio);
 
-	b2World *lWorld = mWorld->getPhysicsWorld();
-	lWorld->DestroyJoint(mJoint);
+	return _create(&lJointDef,pA1,pA2);
+}
+
+GearJoint::~GearJoint()
+{
+	// ActorJoint's destructor would only see ActorJoint::shutdown()
+	shutdown();
+}
+
+ActorJoint *GearJoint::init(ActorJoint *pJ1,ActorJoint *pJ2,const float pRatio)
+{
+	Q_ASSERT( pJ1 != 0 && pJ1->getJoint() != 0 );
+	Q_ASSERT( pJ2 != 0 && pJ2->getJoint() != 0 );
+
+	if( mJoint )
+		return this;
+
+	// the gear moves the second body of each joint
+	b2GearJointDef lJointDef;
+	lJointDef.joint1 = pJ1->getJoint();
+	lJointDef.joint2 = pJ2->getJoint();
+	lJointDef.body1 = pJ1->getJoint()->GetBody2();
+	lJointDef.body2 = pJ2->getJoint()->GetBody2();
+	lJointDef.ratio = pRatio;
+
+	mJoint1 = pJ1;
+	mJoint2 = pJ2;
+
+	mJoint1->mGears.push_back(this);
+	mJoint2->mGears.push_back(this);
+
+	return _create(&lJointDef,pJ1->getActor2(),pJ2->getActor2());
+}
+
+void GearJoint::shutdown(void)
+{
+	if( !mJoint )
+		return;
+
+	mJoint1->mGears.remove(mJoint1->mGears.indexOf(this));
+	mJoint2->mGears.remove(mJoint2->mGears.indexOf(this));
+
+	mJoint1 = 0;
+	mJoint2 = 0;
+
+	ActorJoint::shutdown();
+}
+
+void GearJoint::release(void)
+{
+	ActorJoint::release();
+
+	mJoint1 = 0;
+	mJoint2 = 0;
 }
@@ -37,37 +37,148 @@
 #define ACTORJOINT_H
 
 #include <QtCore/QString>
+#include <QtCore/QVector>
 
-class b2RevoluteJoint;
-class b2RevoluteJointDef;
+#include "actor.h"
+
+class b2Joint;
+struct b2JointDef;
 
 namespace GL {
 
-class Actor;
 class World;
 
+//! Joint between two actors (revolute)
+/*!
+	Created through World::createJoint(), which registers
+	it by handle and name. Both actors keep it in their
+	joint list until it goes away, so removing the joints
+	of an actor only visits its own.
+*/
 class ActorJoint
 {
 public:
 	ActorJoint(const QString &pName, World *pWorld);
 	virtual ~ActorJoint();
 
+	//! Built from the interned name on first use
 	virtual QString &getName(void);
+	virtual t_name getNameId(void) const { return mNameId; }
 	virtual unsigned int getId(void) const;
+	virtual t_handle getHandle( void ) const { return mHandle; }
+
+	virtual b2Joint *getJoint(void) const;
 
-	virtual b2RevoluteJoint *getJoint(void) const;
+	virtual Actor *getActor1( void ) const { return mActor1; }
+	virtual Actor *getActor2( void ) const { return mActor2; }
 
 	virtual ActorJoint *init(Actor *pA1,Actor *pA2,const float pX,const float pY);
 	virtual ActorJoint *init(Actor *pA1,Actor *pA2);
 
 	virtual void shutdown(void);
 
+	//! Forget the physics joint without destroying it
+	/*!
+		Used by bulk teardown, where the
+		b2World drops all joints at once.
+	*/
+	virtual void release(void);
+
+protected:
+	//! Create the physics joint and attach it to both actors
+	virtual ActorJoint *_create(b2JointDef *pDef, Actor *pA1, Actor *pA2);
+	//! Forget an actor which is going away in bulk
+	virtual void _detach(Actor *pActor);
+	//! Rename without building the string (see World::createJoint())
+	virtual void _setNameId(t_name pName);
+
 protected:
-	QString mName;
+	QString mName;		// stale while mNameStale is set
+	t_name mNameId;
+	bool mNameStale;
 	unsigned int mId;
+	t_handle mHandle;
+
+	b2Joint *mJoint;
+	Actor *mActor1;
+	Actor *mActor2;
+
+	//! Gear joints driving this one, they have to go first
+	QVector<ActorJoint *> mGears;
 
-	b2RevoluteJoint *mJoint;
 	World *mWorld;
+
+	friend class World;
+	friend class GearJoint;
+	friend class Scene;
+};
+
+//! Keeps two anchor points at a fixed distance (a spring with pFrequency)
+class DistanceJoint : public ActorJoint
+{
+public:
+	DistanceJoint(const QString &pName, World *pWorld) : ActorJoint(pName,pWorld) {}
+
+	virtual ActorJoint *init(Actor *pA1,Actor *pA2,
+							 const float pX1,const float pY1,
+							 const float pX2,const float pY2,
+							 const float pFrequency=0.0f,const float pDamping=0.0f);
+};
+
+//! Lets pA2 slide along an axis (pAX,pAY) through an anchor point
+class PrismaticJoint : public ActorJoint
+{
+public:
+	PrismaticJoint(const QString &pName, World *pWorld) : ActorJoint(pName,pWorld) {}
+
+	virtual ActorJoint *init(Actor *pA1,Actor *pA2,
+							 const float pX,const float pY,
+							 const float pAX,const float pAY);
+
+	//! Translation limits (screen space units)
+	virtual void setLimits(const float pLower, const float pUpper);
+};
+
+//! Hangs two actors from two ground points over a pulley
+class PulleyJoint : public ActorJoint
+{
+public:
+	PulleyJoint(const QString &pName, World *pWorld) : ActorJoint(pName,pWorld) {}
+
+	virtual ActorJoint *init(Actor *pA1,Actor *pA2,
+							 const float pGX1,const float pGY1,
+							 const float pGX2,const float pGY2,
+							 const float pX1,const float pY1,
+							 const float pX2,const float pY2,
+							 const float pRatio=1.0f);
+};
+
+//! Couples two revolute / prismatic joints
+/*!
+	Both joints must have the ground (or another
+	static actor) as their first actor, the gear
+	goes away with either of them.
+*/
+class GearJoint : public ActorJoint
+{
+public:
+	GearJoint(const QString &pName, World *pWorld) : ActorJoint(pName,pWorld),
+													 mJoint1(0),
+													 mJoint2(0) {}
+	virtual ~GearJoint();
+
+	virtual ActorJoint *init(ActorJoint *pJ1,ActorJoint *pJ2,const float pRatio=1.0f);
+
+	//! The coupled joints
+	virtual ActorJoint *getJoint1( void ) const { return mJoint1; }
+	virtual ActorJoint *getJoint2( void ) const { return mJoint2; }
+
+	virtual void shutdown(void);
+	virtual void release(void);
+
+protected:
+	ActorJoint *mJoint1;
+	ActorJoint *mJoint2;
 };
 
 }
@@ -0,0 +1,150 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include "actorpool.h"
+#include "defines.h"
+
+#include <QtCore/QDebug>
+#include <stdlib.h>
+
+using namespace GL;
+
+//! Block sizes are rounded up to this
+#define ACTORPOOL_ALIGN 16
+
+ActorPool::ActorPool() : mUsed(0),
+						 mReserved(0)
+{
+}
+
+ActorPool::~ActorPool()
+{
+	// actors still alive at exit are leaked on purpose
+	if( mUsed )
+		return;
+
+	clear();
+}
+
+void *ActorPool::alloc( size_t pSize )
+{
+	t_pool *lPool = _getPool(pSize);
+
+	if( !lPool->mFree && !_grow(lPool) )
+		return 0;
+
+	void *lBlock = lPool->mFree;
+	lPool->mFree = *(void **)lBlock;
+
+	mUsed++;
+	return lBlock;
+}
+
+void ActorPool::free( void *pBlock, size_t pSize )
+{
+	if( !pBlock )
+		return;
+
+	t_pool *lPool = _getPool(pSize);
+
+	*(void **)pBlock = lPool->mFree;
+	lPool->mFree = pBlock;
+
+	Q_ASSERT( mUsed > 0 );
+	mUsed--;
+}
+
+void ActorPool::clear( void )
+{
+	Q_ASSERT( mUsed == 0 );
+
+	for(int i=0;i<mPools.size();i++)
+	{
+		t_pool *lPool = mPools[i];
+
+		for(int j=0;j<lPool->mChunks.size();j++)
+			::free(lPool->mChunks[j]);
+
+		delete lPool;
+	}
+
+	mPools.clear();
+	mReserved = 0;
+}
+
+ActorPool::t_pool *ActorPool::_getPool( size_t pSize )
+{
+	const size_t lSize = (pSize + ACTORPOOL_ALIGN - 1) & ~(size_t)(ACTORPOOL_ALIGN - 1);
+
+	// only a handful of actor classes, a linear search will do
+	for(int i=0;i<mPools.size();i++)
+	{
+		if( mPools[i]->mSize == lSize )
+			return mPools[i];
+	}
+
+	t_pool *lPool = new t_pool;
+	lPool->mSize = lSize;
+	lPool->mFree = 0;
+
+	mPools.push_back(lPool);
+	return lPool;
+}
+
+bool ActorPool::_grow( t_pool *pPool )
+{
+	char *lChunk = (char *)malloc(pPool->mSize * WORLD_POOL_CHUNK);
+
+	if( !lChunk )
+	{
+		qDebug() << "Error: [ActorPool] out of memory for " << WORLD_POOL_CHUNK << " blocks of " << (int)pPool->mSize << " bytes";
+		return false;
+	}
+
+	pPool->mChunks.push_back(lChunk);
+
+	// thread the new blocks in address order
+	for(int i=WORLD_POOL_CHUNK-1;i>=0;i--)
+	{
+		void *lBlock = lChunk + i * pPool->mSize;
+		*(void **)lBlock = pPool->mFree;
+		pPool->mFree = lBlock;
+	}
+
+	mReserved += WORLD_POOL_CHUNK;
+
+	qDebug() << "Success: [ActorPool] " << WORLD_POOL_CHUNK << " more blocks of " << (int)pPool->mSize << " bytes";
+	return true;
+}
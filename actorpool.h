@@ -0,0 +1,99 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#ifndef ACTORPOOL_H
+#define ACTORPOOL_H
+
+#include <QtCore/QVector>
+#include <stddef.h>
+
+namespace GL {
+
+//! Fixed size block pools for actors
+/*!
+	Every actor class gets blocks of its own size, carved
+	out of big chunks, so actors of the same type end up
+	next to each other in memory instead of all over the
+	heap. Freed blocks are reused right away (LIFO), the
+	chunks are only given back by clear().
+
+	Used by Actor::operator new / delete, GUI thread only.
+*/
+class ActorPool
+{
+public:
+	ActorPool();
+	virtual ~ActorPool();
+
+	//! A free block of pSize bytes, 0 when out of memory
+	virtual void *alloc( size_t pSize );
+	virtual void free( void *pBlock, size_t pSize );
+
+	//! Give back all chunks (every block must be free)
+	virtual void clear( void );
+
+	//! Blocks handed out right now / ever reserved
+	virtual int getUsed( void ) const { return mUsed; }
+	virtual int getReserved( void ) const { return mReserved; }
+
+	static ActorPool &getInstance( void )
+	{
+		static ActorPool staticActorPool;
+		return staticActorPool;
+	}
+
+protected:
+	//! All blocks of the same (rounded up) size
+	typedef struct s_pool
+	{
+		size_t mSize;
+		void *mFree; // singly linked through the blocks
+		QVector<char *> mChunks;
+	} t_pool;
+
+	virtual t_pool *_getPool( size_t pSize );
+	//! Adds a chunk of blocks, false when malloc() fails
+	virtual bool _grow( t_pool *pPool );
+
+protected:
+	QVector<t_pool *> mPools;
+
+	int mUsed;
+	int mReserved;
+};
+
+/*GL*/ }
+
+#endif // ACTORPOOL_H
@@ -50,7 +50,9 @@ static Env *gEnv = &Env::getInstance();
 
 Canvas::Canvas(Interface::IGame *pGame, QWidget *pParent) :  QGLWidget(pParent),
 															 mTimer(new QTimer(this)),
-															 mGame(0)
+															 mGame(0),
+															 mProfileHead(0),
+															 mProfileCount(0)
 {
 	// MOUSE
 	setMouseTracking(gEnv->mCaptCursor);
@@ -155,6 +157,10 @@ void Canvas::paintGL(void)
 	// HERE AS NULL ...
 	mGame->render(this);
 
+	// PROFILER OVERLAY ON TOP OF EVERYTHING
+	if( gEnv->mShowProfile )
+		drawProfile();
+
 	end2D();
 }
 
@@ -162,6 +168,9 @@ void Canvas::updateGL(void)
 {
 	QGLWidget::updateGL();
 	mGame->think(this);
+
+	if( gEnv->mShowProfile )
+		recordProfile();
 }
 
 void Canvas::begin2D( int pWidth, int pHeight )
@@ -224,6 +233,11 @@ void Canvas::keyPressEvent(QKeyEvent *pEvent)
 	// HANDLE ESCAPE HERE
 	if( lKey == Qt::Key_Escape )
 		QApplication::quit();
+	else if( lKey == Qt::Key_F3 ) // PROFILER OVERLAY
+	{
+		gEnv->mShowProfile = !gEnv->mShowProfile;
+		mProfileCount = 0;
+	}
 	else if( !mGame->updateKeys(lKey,IGame::K_DOWN) ) // PASS IN ALL OTHER KEYS
 		QGLWidget::keyPressEvent(pEvent); // HANDLE UN-HANDLED KEYS
 }
@@ -239,6 +253,131 @@ void Canvas::keyReleaseEvent(QKeyEvent *pEvent)
 		QGLWidget::keyReleaseEvent(pEvent); // HANDLE UN-HANDLED KEYS
 }
 
+void Canvas::recordProfile(void)
+{
+	World *lWorld = mGame->getWorld();
+
+	if( !lWorld )
+		return;
+
+	const b2Profile &lProfile = lWorld->getProfile();
+
+	// frames without a physics step have nothing to show
+	if( lProfile.step <= 0.0f )
+		return;
+
+	mProfiles[mProfileHead] = lProfile;
+	mProfileHead = (mProfileHead + 1) % CANVAS_PROFILE_SAMPLES;
+
+	if( mProfileCount < CANVAS_PROFILE_SAMPLES )
+		mProfileCount++;
+}
+
+void Canvas::drawProfile(void)
+{
+	if( !mProfileCount )
+		return;
+
+	// one graph line per phase, summed over the steps of a frame
+	static const struct
+	{
+		const char *mName;
+		float32 b2Profile::*mTime;
+		float mColor[3];
+	} lPhases[] =
+	{
+		{ "step",		&b2Profile::step,			{ 1.0f, 1.0f, 1.0f } },
+		{ "collide",	&b2Profile::collide,		{ 1.0f, 0.3f, 0.3f } },
+		{ "islands",	&b2Profile::islands,		{ 1.0f, 0.8f, 0.2f } },
+		{ "solve",		&b2Profile::solve,			{ 0.3f, 1.0f, 0.3f } },
+		{ "sync",		&b2Profile::synchronize,	{ 0.3f, 0.6f, 1.0f } },
+		{ "commit",		&b2Profile::commit,			{ 1.0f, 0.4f, 1.0f } },
+		{ "toi",		&b2Profile::solveTOI,		{ 0.2f, 1.0f, 1.0f } }
+	};
+	const int lNumPhases = sizeof(lPhases) / sizeof(lPhases[0]);
+
+	const float lX = 10.0f;
+	const float lY = 10.0f;
+	const float lW = 2.0f * CANVAS_PROFILE_SAMPLES;
+	const float lH = 120.0f;
+
+	// the top of the graph is two physics steps worth of time
+	const float lScale = lH / (gEnv->mTimeStep * 2000.0f);
+
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LINE_BIT);
+	glDisable(GL_TEXTURE_2D);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glLineWidth(1.0f);
+
+	// backdrop
+	glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
+	glBegin(GL_QUADS);
+		glVertex2f(lX, lY);
+		glVertex2f(lX + lW, lY);
+		glVertex2f(lX + lW, lY + lH + 138.0f);
+		glVertex2f(lX, lY + lH + 138.0f);
+	glEnd();
+
+	// one physics step budget
+	glColor4f(1.0f, 1.0f, 1.0f, 0.3f);
+	glBegin(GL_LINES);
+		glVertex2f(lX, lY + lH * 0.5f);
+		glVertex2f(lX + lW, lY + lH * 0.5f);
+	glEnd();
+
+	// oldest sample on the left
+	const int lFirst = (mProfileHead - mProfileCount + CANVAS_PROFILE_SAMPLES) % CANVAS_PROFILE_SAMPLES;
+
+	for(int i=0;i<lNumPhases;i++)
+	{
+		glColor3fv(lPhases[i].mColor);
+		glBegin(GL_LINE_STRIP);
+
+		for(int j=0;j<mProfileCount;j++)
+		{
+			const b2Profile &lProfile = mProfiles[(lFirst + j) % CANVAS_PROFILE_SAMPLES];
+			float lValue = qMin(lProfile.*lPhases[i].mTime * lScale, lH);
+
+			glVertex2f(lX + j * 2.0f, lY + lH - lValue);
+		}
+
+		glEnd();
+	}
+
+	// legend and counters of the latest frame
+	const b2Profile &lLast = mProfiles[(mProfileHead - 1 + CANVAS_PROFILE_SAMPLES) % CANVAS_PROFILE_SAMPLES];
+	QFont lFont("Courier",8);
+
+	int lTextY = (int)(lY + lH + 14.0f);
+
+	for(int i=0;i<lNumPhases;i++)
+	{
+		glColor3fv(lPhases[i].mColor);
+		renderText((int)lX + 4 + (i % 4) * 100, lTextY + (i / 4) * 14,
+				   QString("%1 %2").arg(lPhases[i].mName).arg(lLast.*lPhases[i].mTime,0,'f',2),lFont);
+	}
+
+	glColor3f(1.0f, 1.0f, 1.0f);
+	renderText((int)lX + 4, lTextY + 36,
+			   QString("bodies %1 (%2 asleep) pairs %3 contacts %4")
+			   .arg(lLast.bodyCount).arg(lLast.sleepingBodies)
+			   .arg(lLast.pairCount).arg(lLast.contactCount),lFont);
+	renderText((int)lX + 4, lTextY + 50,
+			   QString("islands %1 (max %2) toi %3 gjk %4")
+			   .arg(lLast.islandCount).arg(lLast.maxIslandSize)
+			   .arg(lLast.toiEvents).arg(lLast.gjkIterations),lFont);
+	renderText((int)lX + 4, lTextY + 64,
+			   QString("stack %1k peak %2k (grown %3x)")
+			   .arg(lLast.stackCapacity / 1024).arg(lLast.stackMaxAllocation / 1024)
+			   .arg(lLast.stackGrowCount),lFont);
+	renderText((int)lX + 4, lTextY + 78,
+			   QString("blocks %1k used %2k")
+			   .arg(lLast.blockChunkBytes / 1024).arg(lLast.blockUsedBytes / 1024),lFont);
+
+	glPopAttrib();
+}
+
 #ifdef WORLD_VERTEX_ARRAYS
 void Canvas::enableClientStates(void)
 {
@@ -47,6 +47,9 @@
 #include "defines.h"
 #include "world.h"
 
+//! Number of frames kept by the profiler overlay
+#define CANVAS_PROFILE_SAMPLES 200
+
 namespace Interface
 {
 	class IGame;
@@ -84,6 +87,10 @@ protected:
 	void keyPressEvent(QKeyEvent *pEvent);
 	void keyReleaseEvent(QKeyEvent *pEvent);
 
+	//! Physics profiler overlay (F3)
+	void recordProfile(void);
+	void drawProfile(void);
+
 #ifdef WORLD_VERTEX_ARRAYS
 protected:
 	void enableClientStates(void);
@@ -93,6 +100,11 @@ protected:
 protected:
 	QTimer *mTimer;
 	Interface::IGame *mGame;
+
+	// profiler overlay samples (ring buffer)
+	b2Profile mProfiles[CANVAS_PROFILE_SAMPLES];
+	int mProfileHead;
+	int mProfileCount;
 };
 
 /* GL */}
@@ -0,0 +1,337 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include "chunkstreamer.h"
+#include "world.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QDebug>
+
+#include <string.h>
+#include <math.h>
+#include <typeinfo>
+
+using namespace GL;
+
+#define CHUNKSTREAMER_MAGIC 0x4B4E4843 // "CHNK"
+#define CHUNKSTREAMER_VERSION 1
+
+ChunkStreamer::ChunkStreamer( World *pWorld, const QString &pPath, float pChunkSize ) : mWorld(pWorld),
+																					  mPath(pPath),
+																					  mChunkSize(pChunkSize),
+																					  mLoadRadius(1),
+																					  mKeepRadius(2)
+{
+	Q_ASSERT( mWorld != 0 );
+	Q_ASSERT( mChunkSize > 0.0f );
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+	// the world may be gone already, only the files are ours
+	discard();
+}
+
+void ChunkStreamer::setRadius( int pLoad, int pKeep )
+{
+	Q_ASSERT( pLoad >= 0 && pKeep >= pLoad );
+
+	mLoadRadius = pLoad;
+	mKeepRadius = pKeep;
+}
+
+bool ChunkStreamer::add( Actor *pActor )
+{
+	if( !pActor || !pActor->getHandle() )
+		return false;
+
+	// records come back as plain Actors, a Pea would lose its class
+	if( typeid(*pActor) != typeid(Actor) )
+	{
+		qDebug() << "Error: [ChunkStreamer] Can't stream " << pActor->getName() << ", not a plain Actor";
+		return false;
+	}
+
+	mActors.push_back(pActor->getHandle());
+	return true;
+}
+
+int ChunkStreamer::getStoredCount( void ) const
+{
+	int lCount = 0;
+
+	QHash<quint32, int>::const_iterator lIt = mStored.begin();
+	QHash<quint32, int>::const_iterator lEnd = mStored.end();
+
+	for(;lIt!=lEnd;++lIt)
+		lCount += lIt.value();
+
+	return lCount;
+}
+
+void ChunkStreamer::update( void )
+{
+	t_point lCamera;
+	int lCX, lCY;
+
+	mWorld->getCamera(&lCamera);
+	_getChunk(lCamera[0],lCamera[1],&lCX,&lCY);
+
+	// 1. forget chunks out of the keep range
+	QHash<quint32, int>::iterator lIt = mLoaded.begin();
+
+	while( lIt != mLoaded.end() )
+	{
+		const int lX = (qint16)(lIt.key() >> 16);
+		const int lY = (qint16)(lIt.key() & 0xFFFF);
+
+		if( qAbs(lX - lCX) > mKeepRadius || qAbs(lY - lCY) > mKeepRadius )
+			lIt = mLoaded.erase(lIt);
+		else
+			++lIt;
+	}
+
+	// 2. read back what came into the load range
+	for(int y=lCY-mLoadRadius;y<=lCY+mLoadRadius;y++)
+	{
+		for(int x=lCX-mLoadRadius;x<=lCX+mLoadRadius;x++)
+		{
+			const quint32 lKey = _getKey(x,y);
+
+			if( mLoaded.contains(lKey) )
+				continue;
+
+			mLoaded.insert(lKey,1);
+
+			if( mStored.contains(lKey) )
+				_load(lKey);
+		}
+	}
+
+	// 3. whatever is (or wandered) outside the loaded chunks goes
+	_unload();
+}
+
+void ChunkStreamer::unloadAll( void )
+{
+	mLoaded.clear();
+	_unload();
+}
+
+void ChunkStreamer::discard( void )
+{
+	QHash<quint32, int>::const_iterator lIt = mStored.begin();
+	QHash<quint32, int>::const_iterator lEnd = mStored.end();
+
+	for(;lIt!=lEnd;++lIt)
+		QFile::remove(_getFileName(lIt.key()));
+
+	mStored.clear();
+}
+
+void ChunkStreamer::_unload( void )
+{
+	QHash<quint32, RecordArray> lOut;
+	QVector<t_handle> lKeep;
+
+	lKeep.reserve(mActors.size());
+
+	for(int i=0;i<mActors.size();i++)
+	{
+		Actor *lActor = mWorld->findActor<Actor>(mActors[i]);
+
+		if( !lActor ) // removed by the game
+			continue;
+
+		int lX, lY;
+		_getChunk(lActor,&lX,&lY);
+
+		const quint32 lKey = _getKey(lX,lY);
+		const bool lJoints = ( lActor->getBody() && lActor->getBody()->GetJointList() );
+
+		if( lJoints || mLoaded.contains(lKey) )
+		{
+			lKeep.push_back(mActors[i]);
+			continue;
+		}
+
+		Actor::t_record lRecord;
+		lActor->saveRecord(&lRecord);
+
+		lOut[lKey].push_back(lRecord);
+		mWorld->removeActorLater(lActor);
+	}
+
+	mActors = lKeep;
+
+	QHash<quint32, RecordArray>::const_iterator lIt = lOut.begin();
+	QHash<quint32, RecordArray>::const_iterator lEnd = lOut.end();
+
+	for(;lIt!=lEnd;++lIt)
+		_store(lIt.key(),lIt.value());
+}
+
+quint32 ChunkStreamer::_getKey( int pX, int pY ) const
+{
+	return ( ((quint32)(quint16)pX) << 16 ) | (quint32)(quint16)pY;
+}
+
+void ChunkStreamer::_getChunk( float pX, float pY, int *pCX, int *pCY ) const
+{
+	*pCX = (int)floorf(pX / mChunkSize);
+	*pCY = (int)floorf(pY / mChunkSize);
+}
+
+void ChunkStreamer::_getChunk( Actor *pActor, int *pCX, int *pCY ) const
+{
+	b2Body *lBody = pActor->getBody();
+
+	// the position of physical actors is their center
+	if( lBody )
+		_getChunk(W2S_(lBody->GetPosition().x),W2S_(lBody->GetPosition().y),pCX,pCY);
+	else
+		_getChunk(pActor->getPosX() + pActor->getHWidth(),pActor->getPosY() + pActor->getHHeight(),pCX,pCY);
+}
+
+t_name ChunkStreamer::_getName( const char *pName ) const
+{
+	NameTable &lNames = NameTable::getInstance();
+	const QString lName = QString::fromLatin1(pName);
+
+	// "Body_12" is most likely Body with serial 12
+	t_name lId = lNames.find(lName);
+
+	if( !lId )
+		lId = lNames.findUnique(lName);
+
+	if( !lId )
+		lId = lNames.intern(lName);
+
+	return lId;
+}
+
+QString ChunkStreamer::_getFileName( quint32 pKey ) const
+{
+	return QString("%1/chunk_%2_%3.bin").arg(mPath).arg((qint16)(pKey >> 16)).arg((qint16)(pKey & 0xFFFF));
+}
+
+bool ChunkStreamer::_store( quint32 pKey, const RecordArray &pRecords )
+{
+	QFile lFile(_getFileName(pKey));
+
+	// records are appended, a new file (even over a leftover) starts with the header
+	const bool lAppend = mStored.contains(pKey);
+
+	if( !lFile.open(QIODevice::WriteOnly | ((lAppend)?QIODevice::Append:QIODevice::Truncate)) )
+	{
+		qDebug() << "Error: [ChunkStreamer] Failed to open " << _getFileName(pKey);
+		return false;
+	}
+
+	if( !lAppend )
+	{
+		t_header lHeader;
+
+		lHeader.mMagic = CHUNKSTREAMER_MAGIC;
+		lHeader.mVersion = CHUNKSTREAMER_VERSION;
+		lHeader.mRecordSize = sizeof(Actor::t_record);
+
+		lFile.write((const char *)&lHeader,sizeof(t_header));
+	}
+
+	const qint64 lSize = sizeof(Actor::t_record) * pRecords.size();
+
+	if( lFile.write((const char *)pRecords.constData(),lSize) != lSize )
+	{
+		qDebug() << "Error: [ChunkStreamer] Failed to write " << _getFileName(pKey);
+		return false;
+	}
+
+	mStored[pKey] += pRecords.size();
+	return true;
+}
+
+int ChunkStreamer::_load( quint32 pKey )
+{
+	QFile lFile(_getFileName(pKey));
+
+	mStored.remove(pKey);
+
+	if( !lFile.open(QIODevice::ReadOnly) )
+	{
+		qDebug() << "Error: [ChunkStreamer] Failed to open " << _getFileName(pKey);
+		return 0;
+	}
+
+	QByteArray lData = lFile.readAll();
+	lFile.close();
+	QFile::remove(_getFileName(pKey));
+
+	const t_header *lHeader = (const t_header *)lData.constData();
+
+	if( lData.size() < (int)sizeof(t_header) ||
+		lHeader->mMagic != CHUNKSTREAMER_MAGIC ||
+		lHeader->mVersion != CHUNKSTREAMER_VERSION ||
+		lHeader->mRecordSize != sizeof(Actor::t_record) )
+	{
+		qDebug() << "Error: [ChunkStreamer] Bad chunk file " << _getFileName(pKey);
+		return 0;
+	}
+
+	const int lCount = (lData.size() - sizeof(t_header)) / sizeof(Actor::t_record);
+	const char *lRecords = lData.constData() + sizeof(t_header);
+
+	// the broadphase takes all the shapes of the chunk at once
+	b2World *lWorld = mWorld->getPhysicsWorld();
+
+	mWorld->sync();
+	lWorld->BeginCreate();
+
+	for(int i=0;i<lCount;i++)
+	{
+		// copied out, the byte array isn't aligned for floats
+		Actor::t_record lRecord;
+		memcpy(&lRecord,lRecords + i * sizeof(Actor::t_record),sizeof(Actor::t_record));
+
+		Actor *lActor = mWorld->createActor<Actor>(_getName(lRecord.mName));
+		lActor->loadRecord(&lRecord);
+
+		mActors.push_back(lActor->getHandle());
+	}
+
+	lWorld->EndCreate();
+
+	return lCount;
+}
@@ -0,0 +1,127 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#ifndef CHUNKSTREAMER_H
+#define CHUNKSTREAMER_H
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/QHash>
+
+#include "defines.h"
+#include "actor.h"
+
+namespace GL {
+
+class World;
+
+//! Pages actors in and out of a World around the camera
+/*!
+	The level is cut into square chunks, chunks that come
+	within the load radius (in chunks) of the camera are
+	read back, chunks further than the keep radius are
+	dropped. Actors outside the loaded chunks (even ones
+	which just wandered out) are written to their chunk's
+	file and removed.
+
+	Only plain Actor state is streamed (see Actor::t_record),
+	add() refuses subclasses, actors with joints are never
+	unloaded. Call update() right before World::update()
+	so removals are flushed in the same frame.
+*/
+class ChunkStreamer
+{
+public:
+	ChunkStreamer( World *pWorld, const QString &pPath, float pChunkSize = WORLD_CHUNK_SIZE );
+	virtual ~ChunkStreamer();
+
+	//! Radius (in chunks) to load around the camera and to keep loaded
+	virtual void setRadius( int pLoad, int pKeep );
+
+	//! Stream this actor from now on (false if it isn't a plain Actor)
+	virtual bool add( Actor *pActor );
+
+	virtual void update( void );
+
+	//! Write every streamed actor out
+	virtual void unloadAll( void );
+	//! Forget everything written out (removes the files)
+	virtual void discard( void );
+
+	virtual int getLoadedChunks( void ) const { return mLoaded.size(); }
+	virtual int getActorCount( void ) const { return mActors.size(); }
+	//! Actors sitting in chunk files
+	virtual int getStoredCount( void ) const;
+
+protected:
+	typedef struct s_header
+	{
+		quint32 mMagic;
+		quint32 mVersion;
+		quint32 mRecordSize;
+	} t_header;
+
+	typedef QVector<Actor::t_record> RecordArray;
+
+	virtual quint32 _getKey( int pX, int pY ) const;
+	virtual void _getChunk( float pX, float pY, int *pCX, int *pCY ) const;
+	virtual void _getChunk( Actor *pActor, int *pCX, int *pCY ) const;
+	virtual QString _getFileName( quint32 pKey ) const;
+	//! Interned name of a record (keeps unique names unique)
+	virtual t_name _getName( const char *pName ) const;
+
+	//! Write out (and remove) actors outside the loaded chunks
+	virtual void _unload( void );
+	virtual bool _store( quint32 pKey, const RecordArray &pRecords );
+	virtual int _load( quint32 pKey );
+
+protected:
+	World *mWorld;
+	QString mPath;
+	float mChunkSize;
+
+	int mLoadRadius;
+	int mKeepRadius;
+
+	QVector<t_handle> mActors;
+
+	//! Chunks in range / chunk files with their record count
+	QHash<quint32, int> mLoaded;
+	QHash<quint32, int> mStored;
+};
+
+/*GL*/ }
+
+#endif // CHUNKSTREAMER_H
@@ -0,0 +1,172 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include "contactbuffer.h"
+#include "actor.h"
+
+#include <string.h>
+
+using namespace GL;
+
+ContactBuffer::ContactBuffer(int pCapacity) : mEvents(0),
+											  mNumEvents(0),
+											  mCapacity(pCapacity),
+											  mSteps(0),
+											  mNumSteps(0),
+											  mStepCapacity(8),
+											  mTypes(ContactEvent::E_BEGIN | ContactEvent::E_END),
+											  mFilter(0),
+											  mLocked(false)
+{
+	Q_ASSERT( pCapacity > 0 );
+
+	mEvents = new ContactEvent[mCapacity];
+	mSteps = new int[mStepCapacity];
+
+	qDebug() << "Allocated Contact Event Buffer with a size of " << mCapacity;
+}
+
+ContactBuffer::~ContactBuffer()
+{
+	delete [] mEvents;
+	delete [] mSteps;
+
+	qDebug() << "DeAllocated Contact Event Buffer ...";
+}
+
+void ContactBuffer::record( ContactEvent::t_type pType, const b2ContactPoint *pPoint )
+{
+	if( mLocked || !(mTypes & pType) )
+		return;
+
+	ContactEvent *lEvent = _push(pType,pPoint->shape1,pPoint->shape2);
+
+	if( !lEvent )
+		return;
+
+	// Position (convert to Screen Space)
+	lEvent->mPos[0] = W2S_(pPoint->position.x);
+	lEvent->mPos[1] = W2S_(pPoint->position.y);
+
+	lEvent->mNormal[0] = pPoint->normal.x;
+	lEvent->mNormal[1] = pPoint->normal.y;
+
+	lEvent->mSeparation = pPoint->separation;
+	lEvent->mNormalImpulse = 0.0f;
+	lEvent->mTangentImpulse = 0.0f;
+}
+
+void ContactBuffer::record( const b2ContactResult *pResult )
+{
+	if( mLocked || !(mTypes & ContactEvent::E_IMPULSE) )
+		return;
+
+	ContactEvent *lEvent = _push(ContactEvent::E_IMPULSE,pResult->shape1,pResult->shape2);
+
+	if( !lEvent )
+		return;
+
+	// Position (convert to Screen Space)
+	lEvent->mPos[0] = W2S_(pResult->position.x);
+	lEvent->mPos[1] = W2S_(pResult->position.y);
+
+	lEvent->mNormal[0] = pResult->normal.x;
+	lEvent->mNormal[1] = pResult->normal.y;
+
+	lEvent->mSeparation = 0.0f;
+	lEvent->mNormalImpulse = pResult->normalImpulse;
+	lEvent->mTangentImpulse = pResult->tangentImpulse;
+}
+
+void ContactBuffer::endStep( void )
+{
+	if( mNumSteps == mStepCapacity )
+	{
+		int *lSteps = new int[mStepCapacity * 2];
+		memcpy(lSteps,mSteps,mNumSteps * sizeof(int));
+
+		delete [] mSteps;
+		mSteps = lSteps;
+		mStepCapacity *= 2;
+	}
+
+	mSteps[mNumSteps++] = mNumEvents;
+}
+
+void ContactBuffer::clear( void )
+{
+	mNumEvents = 0;
+	mNumSteps = 0;
+}
+
+const ContactEvent *ContactBuffer::getStep( int pStep, int *pNumEvents ) const
+{
+	Q_ASSERT( pStep >= 0 && pStep < mNumSteps );
+	Q_ASSERT( pNumEvents != 0 );
+
+	int lBegin = (pStep)?mSteps[pStep-1]:0;
+	*pNumEvents = mSteps[pStep] - lBegin;
+
+	return mEvents + lBegin;
+}
+
+ContactEvent *ContactBuffer::_push( ContactEvent::t_type pType, b2Shape *pShape1, b2Shape *pShape2 )
+{
+	Actor *lActor1 = static_cast<Actor *>(pShape1->GetBody()->GetUserData());
+	Actor *lActor2 = static_cast<Actor *>(pShape2->GetBody()->GetUserData());
+
+	// filter by actor flags
+	if( mFilter && !lActor1->isFlag(mFilter) && !lActor2->isFlag(mFilter) )
+		return 0;
+
+	if( mNumEvents == mCapacity )
+	{
+		ContactEvent *lEvents = new ContactEvent[mCapacity * 2];
+		memcpy(lEvents,mEvents,mNumEvents * sizeof(ContactEvent));
+
+		delete [] mEvents;
+		mEvents = lEvents;
+		mCapacity *= 2;
+
+		qDebug() << "Contact Event Buffer grown to " << mCapacity;
+	}
+
+	ContactEvent *lEvent = &mEvents[mNumEvents++];
+	lEvent->mType = pType;
+	lEvent->mActor1 = lActor1;
+	lEvent->mActor2 = lActor2;
+
+	return lEvent;
+}
@@ -0,0 +1,148 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#ifndef CONTACTBUFFER_H
+#define CONTACTBUFFER_H
+
+#include "Box2D/Box2D.h"
+
+#include "types.h"
+#include "defines.h"
+
+namespace GL {
+
+class Actor;
+
+//! A single contact event recorded during a physics step
+struct ContactEvent
+{
+	typedef enum e_type
+	{
+		E_BEGIN		= BIT(0), /* shapes started touching	*/
+		E_PERSIST	= BIT(1), /* still touching				*/
+		E_END		= BIT(2), /* stopped touching			*/
+		E_IMPULSE	= BIT(3), /* solver result				*/
+		E_ALL		= E_BEGIN | E_PERSIST | E_END | E_IMPULSE
+	} t_type;
+
+	t_type mType;
+
+	Actor *mActor1;
+	Actor *mActor2;
+
+	t_point mPos;	 // screen space
+	t_vec2 mNormal;	 // points from mActor1 to mActor2
+
+	//! E_BEGIN, E_PERSIST and E_END
+	float mSeparation;	// world space
+
+	//! E_IMPULSE only
+	float mNormalImpulse;
+	float mTangentImpulse;
+};
+
+//! Contact events of a batch of physics steps
+/*!
+	Events are written by the b2ContactListener while
+	stepping (possibly on the physics thread) and read
+	back on the GUI thread as one contiguous span per step.
+
+	Memory is reused from frame to frame, when a frame has
+	more events than fit the buffer grows instead of
+	dropping them.
+
+	Only event types enabled with setTypes() are recorded,
+	and if a filter is set, only events where at least one
+	of the actors has any of the filter flags.
+*/
+class ContactBuffer
+{
+public:
+	ContactBuffer(int pCapacity);
+	virtual ~ContactBuffer();
+
+	//! Event types to record (ContactEvent::t_type bits)
+	virtual void setTypes( int pTypes ) { mTypes = pTypes; }
+	virtual int getTypes( void ) const { return mTypes; }
+
+	//! Actor flags to record (0 = all actors)
+	virtual void setFilter( unsigned long pFlags ) { mFilter = pFlags; }
+	virtual unsigned long getFilter( void ) const { return mFilter; }
+
+	virtual void record( ContactEvent::t_type pType, const b2ContactPoint *pPoint );
+	virtual void record( const b2ContactResult *pResult );
+
+	//! Ignore events while the spans are being read
+	/*!
+		Destroying a body reports its contacts as ended,
+		this keeps subscribers which remove actors from
+		writing into the buffer they are reading.
+	*/
+	virtual void lock( void ) { mLocked = true; }
+	virtual void unlock( void ) { mLocked = false; }
+
+	//! Close the span of the step just taken
+	virtual void endStep( void );
+	//! Forget all events and steps
+	virtual void clear( void );
+
+	virtual int getNumSteps( void ) const { return mNumSteps; }
+	virtual int getNumEvents( void ) const { return mNumEvents; }
+
+	//! Events of a step, pNumEvents receives the length of the span
+	virtual const ContactEvent *getStep( int pStep, int *pNumEvents ) const;
+
+protected:
+	virtual ContactEvent *_push( ContactEvent::t_type pType, b2Shape *pShape1, b2Shape *pShape2 );
+
+protected:
+	ContactEvent *mEvents;
+	int mNumEvents;
+	int mCapacity;
+
+	//! End of each step's span in mEvents
+	int *mSteps;
+	int mNumSteps;
+	int mStepCapacity;
+
+	int mTypes;
+	unsigned long mFilter;
+
+	bool mLocked;
+};
+
+/* GL */ }
+
+#endif // CONTACTBUFFER_H
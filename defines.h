@@ -42,6 +42,25 @@
 
 #define WORLD_SCALE_VALUE 10
 
+// one per b2FilterData category bit
+#define WORLD_MAX_LAYERS 16
+
+// actors per ActorPool chunk / hot blocks per World chunk
+#define WORLD_POOL_CHUNK 64
+
+// retired actors kept per base name (see World::retireActor())
+#define WORLD_MAX_RECYCLED 64
+
+// sprites per SpriteBatch flush (4 vertices each, 16-bit indices)
+#define WORLD_BATCH_SIZE 2048
+
+// culling grid cell size (screen space) and the most cells an actor may cover
+#define WORLD_CULL_CELL 128
+#define WORLD_CULL_MAX_CELLS 64
+
+// ChunkStreamer chunk size (screen space)
+#define WORLD_CHUNK_SIZE 1024
+
 #define W2S(x,y)    ( x * WORLD_SCALE_VALUE ),( y * WORLD_SCALE_VALUE )
 #define W2S_(x)     ( x * WORLD_SCALE_VALUE )
 
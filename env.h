@@ -63,7 +63,12 @@ struct Env
 
 		mIterations = 10;
 
-		mNumContactPoints = 30;
+		mMaxSteps = 5;
+		mInterpolate = true;
+		mPipelined = false;
+		mFixedFrameTime = 0.0f;
+
+		mNumContactEvents = 256;
 
 		// default gravity
 		mGravity[0] =  0.0f;
@@ -78,9 +83,13 @@ struct Env
 		mSWidth = 800;
 		mSHeight= 600;
 
+		mLevelWidth = 0;
+		mLevelHeight= 0;
+
 		mBasePath = "./data/";
 
 		mDebugDraw = false;
+		mShowProfile = false;
 
 		// Debug Lines == RED
 		mDebugColor[0] = 1.0f;
@@ -149,14 +158,43 @@ struct Env
 		Box2D Physics Iteration
 	*/
 	int mIterations;
+	/*!
+		Maximum number of fixed physics steps
+		taken in a single frame.
+
+		Any time left over beyond this is dropped,
+		so a slow frame can't make the next one
+		even slower (the "spiral of death").
+	*/
+	int mMaxSteps;
+	/*!
+		Interpolate PhysX driven actors between the
+		previous and the current physics step when
+		rendering.
+	*/
+	bool mInterpolate;
+	/*!
+		Step physics on a worker thread while the
+		previous frame is being rendered.
+	*/
+	bool mPipelined;
+	/*!
+		Simulated frame time in seconds fed to the physics
+		time step accumulator, 0 means real (wall clock) time.
+
+		Setting it to mTimeStep takes exactly one physics
+		step every frame (benchmarks, replays).
+	*/
+	float mFixedFrameTime;
 	/*!
 		Box2D Initial Gravity
 	*/
 	t_vec2 mGravity;
 	/*!
-		Maximum Number of Contact Points
+		Initial Size of the Contact Event Buffer
+		(grows when a frame records more)
 	*/
-	unsigned short mNumContactPoints;
+	int mNumContactEvents;
 	//! Window Width
 	int mWWidth;
 	//! Window Height
@@ -176,11 +214,22 @@ struct Env
 	//! Screen Height
 	int mSHeight;
 
+	//! Level Width / Height (0 = same as the screen)
+	/*!
+		Size of the physics world a World is created
+		with, anything bigger than the screen needs the
+		camera (see World::setCamera()) to be seen.
+	*/
+	int mLevelWidth;
+	int mLevelHeight;
+
 	//! Base Data Path
 	const char *mBasePath;
 
 	//! Debug Draw flag when compiled with debug draw
 	bool mDebugDraw;
+	//! Physics profiler overlay (toggled with F3)
+	bool mShowProfile;
 	//! Vertex Outline Colors For Debug Draw
 	t_vec3 mDebugColor;
 
@@ -163,9 +163,6 @@ bool Game::init(void)
 		mAirPlane = lActor;
 	}
 
-	// SORT ONCE, JUST TO BE SURE
-	mWorld->sortByZorder();
-
 	return true;
 }
 
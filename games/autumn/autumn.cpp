@@ -129,9 +129,6 @@ bool Game::init(void)
 		mPython->setZOrder(1001);
 	}
 
-	// SORT ONCE, JUST TO BE SURE
-	mWorld->sortByZorder();
-
 	// tick-tack!
 	mTimer.start();
 	mLastTime = mTimer.elapsed();
@@ -187,22 +184,27 @@ void Game::think(Canvas *pCanvas)
 		{
 			float lPosX = ( rand() / (RAND_MAX + 1.0) * (640 + 1 - 130) + 130 );
 			float lPosY = 0;
+			float lRot = rand()%180;
+
+			// leaves which fell off the world come back first
+			Actor *lActor = mWorld->reviveActor<Actor>("Leaf",lPosX,lPosY,lRot);
 
-			Actor *lActor = mWorld->createActor<Actor>("Leaf",true);
-			//lActor->setRect(0,0,64,64);
-			//lActor->setFlags(Actor::S_CIRCLE);
-			lActor->setTexture("textures/autumn/leaf.png");
-			lActor->setBlending(Actor::B_SRC_ALPHA);
-			lActor->setPos(lPosX,lPosY);
-			lActor->setRotation(rand()%180);
-			lActor->setOffsets(20.0f,5.0f);
-			lActor->setDensity(0.1f);
-			lActor->applyPhysX();
+			if( !lActor )
+			{
+				lActor = mWorld->createActor<Actor>("Leaf",true);
+				//lActor->setRect(0,0,64,64);
+				//lActor->setFlags(Actor::S_CIRCLE);
+				lActor->setTexture("textures/autumn/leaf.png");
+				lActor->setBlending(Actor::B_SRC_ALPHA);
+				lActor->setPos(lPosX,lPosY);
+				lActor->setRotation(lRot);
+				lActor->setOffsets(20.0f,5.0f);
+				lActor->setDensity(0.1f);
+				lActor->applyPhysX();
+			}
 		}
 
 		mLastTime = mNow;
-
-		mWorld->sortByZorder();
 	}
 
 	mBkgDay->setTransparency(mNow*0.01f);
@@ -64,6 +64,8 @@ public:
 	virtual bool updateMouse(int pX, int pY, int pButton, t_MouseState pState);
 	virtual bool updateKeys(int pKey, t_KeyState pState);
 
+	virtual GL::World *getWorld( void ) const { return mWorld; }
+
 protected:
 	//! World
 	GL::World *mWorld;
@@ -92,8 +92,12 @@ bool Game::init(void)
 	mWorld = new World;
 
 	// hook up ...
-	connect(mWorld,SIGNAL(onCollision(const ContactPoint*)),
-			this,SLOT(handleCollision(const ContactPoint*)));
+	connect(mWorld,SIGNAL(onContacts(const ContactEvent*,int)),
+			this,SLOT(handleContacts(const ContactEvent*,int)));
+
+	// only new contacts of the pea are of any interest
+	mWorld->setContactTypes(ContactEvent::E_BEGIN);
+	mWorld->setContactFilter(Actor::S_CIRCLE);
 
 	// LOAD/CREATE ALL ASSETS/ACTORS HERE
 	{
@@ -209,9 +213,6 @@ bool Game::init(void)
 		mBoom = lActor;
 	}
 
-	// SORT ONCE, JUST TO BE SURE
-	mWorld->sortByZorder();
-
 	// POINTER
 	mPointer = new Actor("Pointer");
 	mPointer->setRect(0.0f,0.0f,32,32);
@@ -365,8 +366,6 @@ bool Game::updateKeys(int pKey, t_KeyState pState)
 				lActor->setDensity(2.0f);
 				lActor->setRestituition(0.5f);
 				lActor->applyPhysX();
-
-				mWorld->sortByZorder();
 			}
 			break;
 			// drop another (red) pea
@@ -389,21 +388,22 @@ bool Game::updateKeys(int pKey, t_KeyState pState)
 	return false;
 }
 
-void Game::handleCollision(const ContactPoint *pPoint)
+void Game::handleContacts(const ContactEvent *pEvents, int pNumEvents)
 {
-	QString lName1 = pPoint->mActor1->getName();
-	QString lName2 = pPoint->mActor2->getName();
-	//const t_point *lP = &pPoint->mPos;
-
-	// SHOW BIM-BA-RA-BOOOOOM!
-	if( pPoint->mActor2->isFlag(Actor::S_CIRCLE) )
+	for(int i=0;i<pNumEvents;i++)
 	{
-		mBoom->setPos(pPoint->mActor2->getPosX()-45,
-					  pPoint->mActor2->getPosY()-45);
-	}
+		const ContactEvent *lEvent = &pEvents[i];
 
-	if( gEnv->mDebugDraw )
-	{
-		qDebug() << "Collision" << lName1 << " with " << lName2 ;//<< " at position "<<*lP[0]<<","<<*lP[1];
+		// the filter lets through anything touching the pea
+		Actor *lPea = (lEvent->mActor2->isFlag(Actor::S_CIRCLE))?lEvent->mActor2:lEvent->mActor1;
+
+		// SHOW BIM-BA-RA-BOOOOOM!
+		mBoom->setPos(lPea->getPosX()-45,
+					  lPea->getPosY()-45);
+
+		if( gEnv->mDebugDraw )
+		{
+			qDebug() << "Collision" << lEvent->mActor1->getName() << " with " << lEvent->mActor2->getName();
+		}
 	}
 }
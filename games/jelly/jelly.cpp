@@ -134,9 +134,6 @@ bool Game::init(void)
 		mJelly.push_back(lActor);
 	}
 
-	// SORT ONCE, JUST TO BE SURE
-	mWorld->sortByZorder();
-
 	// POINTER
 	mPointer = new Actor("Pointer");
 	mPointer->setRect(0.0f,0.0f,32,32);
@@ -17,6 +17,9 @@ public:
 	JellyActor(const QString &pName,GL::World *pWorld);
 	virtual ~JellyActor();
 
+	//! Just the sprite (see Actor::isBatchable())
+	virtual bool isBatchable( void ) const { return true; }
+
 	virtual void applyPhysX(void);
 
 	virtual void addSpringForceUp(JellyActor *pActor);
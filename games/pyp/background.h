@@ -50,6 +50,9 @@ public:
 	virtual void update(void);
 	virtual void update(int pW, int pH);
 
+	//! Just the sprite (see Actor::isBatchable())
+	virtual bool isBatchable( void ) const { return true; }
+
 protected:
 	float mSpeed;
 };
@@ -44,6 +44,9 @@ class Block : public GL::Actor
 {
 public:
 	Block(const QString &pName,GL::World *pWorld);
+
+	//! Just the sprite (see Actor::isBatchable())
+	virtual bool isBatchable( void ) const { return true; }
 };
 
 }
@@ -44,6 +44,9 @@ class Pea : public GL::Actor
 {
 public:
 	Pea(const QString &pName,GL::World *pWorld);
+
+	//! Just the sprite (see Actor::isBatchable())
+	virtual bool isBatchable( void ) const { return true; }
 };
 
 }
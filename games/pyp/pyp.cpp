@@ -56,7 +56,7 @@ using namespace Sys;
 static Env *gEnv = &Env::getInstance();
 static TextureManager *gTex = &TextureManager::getInstance();
 
-Game::Game() : mWorld(0),mPointer(0)
+Game::Game() : mWorld(0),mStandard(0),mGel(0),mLeft(0),mRight(0),mSpring(0),mPointer(0)
 {
 	qDebug() << "Pyp::Game created ...";
 }
@@ -98,23 +98,36 @@ bool Game::init(void)
 
 	Actor *lGround = mWorld->getGroundActor();
 
+	// BLOCKS -- ONE PREFAB PER TOOL
+	mStandard = _createBlock<Block>("Block","textures/pyp/Block-Normal2.png");
+	mGel = _createBlock<Block>("BlockGel","textures/pyp/Block-Gel2.png");
+	mLeft = _createBlock<Tri>("BlockLeft","textures/pyp/Block-LeftRamp2.png");
+	mRight = _createBlock<Tri2>("BlockRight","textures/pyp/Block-RightRamp2.png");
+	mSpring = _createBlock<Block>("BlockSpring","textures/pyp/Block-Spring2.png",1.0f);
+
 	{
 		// BUILD BLOCK BRIDGE -- JOINT TEST
 		Actor *lPrevActor = lGround;
 		const int lNumPlanks = 8;
 
+		Prefab *lPlank = _createBlock<Block>("Plank","textures/pyp/Block-Normal2.png",0.0f);
+		lPlank->getActor()->setDensity(20.0f);
+
+		t_point lPos[lNumPlanks];
+		Actor *lPlanks[lNumPlanks];
+
 		for(int i=0;i<lNumPlanks;i++)
 		{
-			Block *lActor = mWorld->createActor<Block>("Block",true);
-			lActor->setTexture("textures/pyp/Block-Normal2.png");
-			lActor->setRect(100+71*i,150,71,61);
-			lActor->setBlending(Actor::B_SRC_ALPHA);
-			lActor->setDensity(20.0f);
-			lActor->setRestituition(0.0f);
-			lActor->applyPhysX();
+			lPos[i][0] = 100+71*i;
+			lPos[i][1] = 150;
+		}
 
-			mWorld->createJoint("Bridge",lPrevActor,lActor,100+71*i,150.0f,true);
-			lPrevActor = lActor;
+		mWorld->spawn(lPlank,lPos,lNumPlanks,lPlanks);
+
+		for(int i=0;i<lNumPlanks;i++)
+		{
+			mWorld->createJoint("Bridge",lPrevActor,lPlanks[i],100+71*i,150.0f,true);
+			lPrevActor = lPlanks[i];
 		}
 
 		mWorld->createJoint("Bridge",lPrevActor,lGround,100+71*lNumPlanks,150.0f,true);
@@ -156,9 +169,6 @@ bool Game::init(void)
 		lActor->setZOrder(100.0f);
 	}
 
-	// SORT ONCE, JUST TO BE SURE
-	mWorld->sortByZorder();
-
 	// POINTER
 	mPointer = new Actor("Pointer");
 	mPointer->setRect(0.0f,0.0f,32,32);
@@ -263,7 +273,7 @@ bool Game::updateMouse(int pX, int pY, int pButton, t_MouseState pState)
 			{
 				// drop it, then remove it
 				mWorld->dropActor();
-				mWorld->removeActor(lActor);
+				mWorld->removeActorLater(lActor);
 				lActor = 0;
 			}
 		}
@@ -287,15 +297,15 @@ bool Game::updateMouse(int pX, int pY, int pButton, t_MouseState pState)
 		}
 
 		if( lFlags & Tool::STANDARD )
-			_spawn<Block>(pX,pY,"textures/pyp/Block-Normal2.png");
+			_spawn(mStandard,pX,pY);
 		else if( lFlags & Tool::GEL )
-			_spawn<Block>(pX,pY,"textures/pyp/Block-Gel2.png");
+			_spawn(mGel,pX,pY);
 		else if( lFlags & Tool::LEFT )
-			_spawn<Tri>(pX,pY,"textures/pyp/Block-LeftRamp2.png");
+			_spawn(mLeft,pX,pY);
 		else if( lFlags & Tool::RIGHT )
-			_spawn<Tri2>(pX,pY,"textures/pyp/Block-RightRamp2.png");
+			_spawn(mRight,pX,pY);
 		else if( lFlags & Tool::SPRING )
-			_spawn<Block>(pX,pY,"textures/pyp/Block-Spring2.png",1.0f);
+			_spawn(mSpring,pX,pY);
 	}
 
 	return true;
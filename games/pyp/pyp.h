@@ -66,27 +66,41 @@ public:
 	virtual bool updateMouse(int pX, int pY, int pButton, t_MouseState pState);
 	virtual bool updateKeys(int pKey, t_KeyState pState);
 
+	virtual GL::World *getWorld( void ) const { return mWorld; }
+
 protected:
 	template <typename T>
-	void _spawn(const int pX, const int pY,
+	GL::Prefab *_createBlock(const QString &pName,
 				const QString &pTexture, float pBounce = 0.5f)
 	{
-		T *lActor = mWorld->createActor<T>("Block",true);
+		GL::Prefab *lPrefab = mWorld->createPrefab<T>(pName);
+		GL::Actor *lActor = lPrefab->getActor();
 
 		lActor->setTexture(pTexture);
-		lActor->setRect(pX-16,pY-16,71,61);
+		lActor->setSize(71,61);
 		lActor->setBlending(GL::Actor::B_SRC_ALPHA);
 		lActor->setDensity(1.0f);
 		lActor->setRestituition(pBounce);
-		lActor->applyPhysX();
-		//lActor->setZOrder(1.0f);
+		lPrefab->setPhysical(true);
+
+		return lPrefab;
+	}
 
-		mWorld->sortByZorder();
+	void _spawn(GL::Prefab *pPrefab, const int pX, const int pY)
+	{
+		t_point lPos = { pX-16.0f, pY-16.0f };
+		mWorld->spawn(pPrefab,&lPos,1);
 	}
 
 protected:
 	// World
 	GL::World *mWorld;
+	// Blocks (one per tool)
+	GL::Prefab *mStandard;
+	GL::Prefab *mGel;
+	GL::Prefab *mLeft;
+	GL::Prefab *mRight;
+	GL::Prefab *mSpring;
 	// Not Managed By World
 	GL::Actor *mPointer;
 	// Background
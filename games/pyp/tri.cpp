@@ -44,7 +44,7 @@ Tri::Tri(const QString &pName,World *pWorld) : Actor(pName,pWorld)
 	setFlags(S_CUSTOM);
 }
 
-void Tri::applyPhysX(void)
+const b2ShapeDef *Tri::_buildShape(b2CircleDef *pCircleDef)
 {
 	// no shape defined?
 	if( !isShapeSet() )
@@ -63,7 +63,7 @@ void Tri::applyPhysX(void)
 		setShape(lTri,3);
 	}
 
-	Actor::applyPhysX();
+	return Actor::_buildShape(pCircleDef);
 }
 
 Tri2::Tri2(const QString &pName,World *pWorld) : Actor(pName,pWorld)
@@ -71,7 +71,7 @@ Tri2::Tri2(const QString &pName,World *pWorld) : Actor(pName,pWorld)
 	setFlags(S_CUSTOM);
 }
 
-void Tri2::applyPhysX(void)
+const b2ShapeDef *Tri2::_buildShape(b2CircleDef *pCircleDef)
 {
 	// no shape defined?
 	if( !isShapeSet() )
@@ -90,5 +90,5 @@ void Tri2::applyPhysX(void)
 		setShape(lTri,3);
 	}
 
-	Actor::applyPhysX();
+	return Actor::_buildShape(pCircleDef);
 }
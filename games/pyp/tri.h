@@ -50,7 +50,11 @@ class Tri : public GL::Actor
 public:
 	Tri(const QString &pName,GL::World *pWorld);
 
-	void applyPhysX(void);
+	//! Just the sprite (see Actor::isBatchable())
+	virtual bool isBatchable( void ) const { return true; }
+
+protected:
+	const b2ShapeDef *_buildShape(b2CircleDef *pCircleDef);
 };
 
 class Tri2 : public GL::Actor
@@ -58,7 +62,11 @@ class Tri2 : public GL::Actor
 public:
 	Tri2(const QString &pName,GL::World *pWorld);
 
-	void applyPhysX(void);
+	//! Just the sprite (see Actor::isBatchable())
+	virtual bool isBatchable( void ) const { return true; }
+
+protected:
+	const b2ShapeDef *_buildShape(b2CircleDef *pCircleDef);
 };
 
 }
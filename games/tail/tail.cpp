@@ -114,8 +114,12 @@ bool Game::init(void)
 	mWorld = new World;
 
 	// hook up ...
-	connect(mWorld,SIGNAL(onCollision(const ContactPoint*)),
-			this,SLOT(handleCollision(const ContactPoint*)));
+	connect(mWorld,SIGNAL(onContacts(const ContactEvent*,int)),
+			this,SLOT(handleContacts(const ContactEvent*,int)));
+
+	// only new contacts of the pea are of any interest
+	mWorld->setContactTypes(ContactEvent::E_BEGIN);
+	mWorld->setContactFilter(MAIN_PEA);
 
 	// LOAD/CREATE ALL ASSETS/ACTORS HERE
 	{
@@ -231,9 +235,6 @@ bool Game::init(void)
 		mBoom = lActor;
 	}
 
-	// SORT ONCE, JUST TO BE SURE
-	mWorld->sortByZorder();
-
 	// POINTER
 	mPointer = new Actor("Pointer");
 	mPointer->setRect(0.0f,0.0f,32,32);
@@ -322,15 +323,22 @@ void Game::think(Canvas *pCanvas)
 				mLastLine = lLastLine;
 			}
 
-			Actor *lActor = mWorld->createActor<Actor>("Pea",true);
-			lActor->setFlags(Actor::S_CIRCLE);
-			lActor->setTexture("textures/valeria/valeria.png");
-			lActor->setRect(b2Random(50,700),b2Random(50,100),45,45);
-			lActor->setBlending(Actor::B_SRC_ALPHA);
-			lActor->setDensity(1.5f);
-			lActor->setFriction(0.3f);
-			lActor->setRestituition(0.8f);
-			lActor->applyPhysX();
+			const float lX = b2Random(50,700);
+			const float lY = b2Random(50,100);
+
+			// peas which fell off the world come back first
+			if( !mWorld->reviveActor<Actor>("Pea",lX,lY) )
+			{
+				Actor *lActor = mWorld->createActor<Actor>("Pea",true);
+				lActor->setFlags(Actor::S_CIRCLE);
+				lActor->setTexture("textures/valeria/valeria.png");
+				lActor->setRect(lX,lY,45,45);
+				lActor->setBlending(Actor::B_SRC_ALPHA);
+				lActor->setDensity(1.5f);
+				lActor->setFriction(0.3f);
+				lActor->setRestituition(0.8f);
+				lActor->applyPhysX();
+			}
 		}
 	}
 }
@@ -435,22 +443,26 @@ bool Game::updateKeys(int pKey, t_KeyState pState)
 				lActor->setDensity(2.0f);
 				lActor->setRestituition(0.5f);
 				lActor->applyPhysX();
-
-				mWorld->sortByZorder();
 			}
 			break;
 			// drop another (red) pea
 			case Qt::Key_P:
 			{
-				Actor *lActor = mWorld->createActor<Actor>("Pea",true);
-				lActor->setFlags(Actor::S_CIRCLE);
-				lActor->setTexture("textures/valeria/valeria.png");
-				lActor->setRect(b2Random(60,400),b2Random(60,400),45,45);
-				lActor->setBlending(Actor::B_SRC_ALPHA);
-				lActor->setDensity(1.5f);
-				lActor->setFriction(0.3f);
-				lActor->setRestituition(0.8f);
-				lActor->applyPhysX();
+				const float lX = b2Random(60,400);
+				const float lY = b2Random(60,400);
+
+				if( !mWorld->reviveActor<Actor>("Pea",lX,lY) )
+				{
+					Actor *lActor = mWorld->createActor<Actor>("Pea",true);
+					lActor->setFlags(Actor::S_CIRCLE);
+					lActor->setTexture("textures/valeria/valeria.png");
+					lActor->setRect(lX,lY,45,45);
+					lActor->setBlending(Actor::B_SRC_ALPHA);
+					lActor->setDensity(1.5f);
+					lActor->setFriction(0.3f);
+					lActor->setRestituition(0.8f);
+					lActor->applyPhysX();
+				}
 			}
 			break;
 		}
@@ -459,21 +471,22 @@ bool Game::updateKeys(int pKey, t_KeyState pState)
 	return false;
 }
 
-void Game::handleCollision(const ContactPoint *pPoint)
+void Game::handleContacts(const ContactEvent *pEvents, int pNumEvents)
 {
-	QString lName1 = pPoint->mActor1->getName();
-	QString lName2 = pPoint->mActor2->getName();
-	//const t_point *lP = &pPoint->mPos;
-
-	// SHOW BIM-BA-RA-BOOOOOM!
-	if( pPoint->mActor2->isFlag(MAIN_PEA) )
+	for(int i=0;i<pNumEvents;i++)
 	{
-		mBoom->setPos(pPoint->mActor2->getPosX()-45,
-					  pPoint->mActor2->getPosY()-45);
-	}
+		const ContactEvent *lEvent = &pEvents[i];
 
-	if( gEnv->mDebugDraw )
-	{
-		qDebug() << "Collision" << lName1 << " with " << lName2 ;//<< " at position "<<*lP[0]<<","<<*lP[1];
+		// the filter lets through anything touching the pea
+		Actor *lPea = (lEvent->mActor2->isFlag(MAIN_PEA))?lEvent->mActor2:lEvent->mActor1;
+
+		// SHOW BIM-BA-RA-BOOOOOM!
+		mBoom->setPos(lPea->getPosX()-45,
+					  lPea->getPosY()-45);
+
+		if( gEnv->mDebugDraw )
+		{
+			qDebug() << "Collision" << lEvent->mActor1->getName() << " with " << lEvent->mActor2->getName();
+		}
 	}
 }
@@ -69,8 +69,10 @@ public:
 	virtual bool updateMouse(int pX, int pY, int pButton, t_MouseState pState);
 	virtual bool updateKeys(int pKey, t_KeyState pState);
 
+	virtual GL::World *getWorld( void ) const { return mWorld; }
+
 public slots:
-	void handleCollision(const ContactPoint *pPoint);
+	void handleContacts(const ContactEvent *pEvents, int pNumEvents);
 
 public:
 	enum
@@ -110,9 +110,6 @@ bool Game::init(void)
 		lActor->setZOrder(100.0f);
 	}
 
-	// SORT ONCE, JUST TO BE SURE
-	mWorld->sortByZorder();
-
 	return true;
 }
 
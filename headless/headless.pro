@@ -0,0 +1,53 @@
+# -------------------------------------------------
+# Headless simulation runner / benchmark
+#
+# Steps any registered game or scripted scenario
+# without a GL context and prints frame timings.
+# -------------------------------------------------
+QT += opengl
+CONFIG += console
+CONFIG -= app_bundle
+TARGET = ../bin/Prototype2D-headless
+TEMPLATE = app
+DEFINES += WORLD_HEADLESS
+INCLUDEPATH += .. \
+    ../games
+SOURCES += main.cpp \
+    runner.cpp \
+    scenarios.cpp \
+    kernels.cpp \
+    ../world.cpp \
+    ../texture.cpp \
+    ../actor.cpp \
+    ../texturemanager.cpp \
+    ../gamemanager.cpp \
+    ../actorjoint.cpp \
+    ../physicsthread.cpp \
+    ../contactbuffer.cpp \
+    ../actorpool.cpp \
+    ../chunkstreamer.cpp \
+    ../names.cpp \
+    ../prefab.cpp \
+    ../scene.cpp \
+    ../spritebatch.cpp \
+    ../games/pyp/background.cpp \
+    ../games/pyp/pyp.cpp \
+    ../games/pyp/block.cpp \
+    ../games/pyp/toolpallette.cpp \
+    ../games/pyp/pea.cpp \
+    ../games/pyp/tri.cpp \
+    ../games/template/template.cpp \
+    ../games/force/force.cpp \
+    ../games/tail/tail.cpp \
+    ../games/anim/anim.cpp \
+    ../games/jelly/jelly.cpp \
+    ../games/jelly/jellyactor.cpp \
+    ../games/autumn/autumn.cpp
+HEADERS += runner.h \
+    scenarios.h \
+    kernels.h \
+    ../world.h \
+    ../games/force/force.h \
+    ../games/tail/tail.h
+LIBS += -L"../Box2D"
+LIBS += -lBox2D
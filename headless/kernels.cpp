@@ -0,0 +1,311 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include "kernels.h"
+#include "utils.h"
+
+#include "Box2D/Box2D.h"
+
+#include <QtCore/QVector>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace Headless;
+
+//! Bitwise equality, -0 and +0 differ too
+static bool _same( const b2Vec2 &pA, const b2Vec2 &pB )
+{
+	return memcmp(&pA,&pB,sizeof(b2Vec2)) == 0;
+}
+
+static int _mismatch( const char *pWhat, int pIndex, const b2Vec2 &pScalar, const b2Vec2 &pBatched )
+{
+	printf("Kernels: %s #%d differs, scalar (%.9g, %.9g) batched (%.9g, %.9g)\n",pWhat,pIndex,
+		   pScalar.x,pScalar.y,pBatched.x,pBatched.y);
+	return 1;
+}
+
+static void _print( const char *pLabel, float pScalar, float pBatched, int pCount )
+{
+	const float lScale = 1000000.0f / pCount; // ms -> ns/item
+
+	printf("%-10s %10.2f %10.2f %9.2fx\n",pLabel,pScalar*lScale,pBatched*lScale,
+		   (pBatched > 0.0f)?pScalar/pBatched:0.0f);
+}
+
+int Headless::checkKernels( int pShapes )
+{
+	if( pShapes <= 0 )
+		return 0;
+
+	b2AABB lWorldAABB;
+	lWorldAABB.lowerBound.Set(-1000.0f,-1000.0f);
+	lWorldAABB.upperBound.Set(1000.0f,1000.0f);
+
+	// the broadphase is not involved, stay clear of its proxy limit
+	b2World *lWorld = new b2World(lWorldAABB,b2Vec2(0.0f,0.0f),false);
+
+	QVector<b2Shape *> lShapes;
+	QVector<b2XForm> lXf1(pShapes), lXf2(pShapes);
+
+	for(int i=0;i<pShapes;i++)
+	{
+		// anywhere, turned any way, both for the swept box
+		lXf1[i].position.Set(b2Random(-900.0f,900.0f),b2Random(-900.0f,900.0f));
+		lXf1[i].R.Set(b2Random(-b2_pi,b2_pi));
+		lXf2[i].position = lXf1[i].position + b2Vec2(b2Random(),b2Random());
+		lXf2[i].R.Set(b2Random(-b2_pi,b2_pi));
+
+		b2BodyDef lBodyDef;
+		lBodyDef.position = lXf1[i].position;
+
+		b2Body *lBody = lWorld->CreateBody(&lBodyDef);
+
+		if( i % 2 )
+		{
+			b2CircleDef lCircle;
+			lCircle.localPosition.Set(b2Random(-2.0f,2.0f),b2Random(-2.0f,2.0f));
+			lCircle.radius = b2Random(0.05f,2.0f);
+			lShapes.push_back(lBody->CreateShape(&lCircle));
+		}
+		else
+		{
+			// convex and counter-clockwise: one vertex per sector of an ellipse
+			b2PolygonDef lPolygon;
+			lPolygon.vertexCount = 3 + i / 2 % (b2_maxPolygonVertices - 2);
+
+			const float lSector = 2.0f * b2_pi / lPolygon.vertexCount;
+			const b2Vec2 lCenter(b2Random(-2.0f,2.0f),b2Random(-2.0f,2.0f));
+			const b2Vec2 lRadius(b2Random(0.2f,2.0f),b2Random(0.2f,2.0f));
+
+			for(int j=0;j<lPolygon.vertexCount;j++)
+			{
+				const float lAngle = lSector * (j + b2Random(0.0f,0.5f));
+				lPolygon.vertices[j].Set(lCenter.x + lRadius.x * cosf(lAngle),
+										 lCenter.y + lRadius.y * sinf(lAngle));
+			}
+
+			lShapes.push_back(lBody->CreateShape(&lPolygon));
+		}
+	}
+
+	QVector<b2LocalBox> lBoxes(pShapes);
+	QVector<b2Vec2> lLower(pShapes), lUpper(pShapes);
+	int lMismatches = 0;
+
+	for(int i=0;i<pShapes;i++)
+		lBoxes[i] = lShapes[i]->GetLocalBox();
+
+	// swept AABBs against b2Shape::ComputeSweptAABB()
+	b2ComputeSweptAABBs(lBoxes.data(),lXf1.data(),lXf2.data(),lLower.data(),lUpper.data(),pShapes);
+
+	for(int i=0;i<pShapes;i++)
+	{
+		b2AABB lAABB;
+		lShapes[i]->ComputeSweptAABB(&lAABB,lXf1[i],lXf2[i]);
+
+		if( !_same(lAABB.lowerBound,lLower[i]) )
+			lMismatches += _mismatch("swept lower",i,lAABB.lowerBound,lLower[i]);
+		if( !_same(lAABB.upperBound,lUpper[i]) )
+			lMismatches += _mismatch("swept upper",i,lAABB.upperBound,lUpper[i]);
+	}
+
+	// not moving at all, against b2Shape::ComputeAABB()
+	b2ComputeSweptAABBs(lBoxes.data(),lXf2.data(),lXf2.data(),lLower.data(),lUpper.data(),pShapes);
+
+	for(int i=0;i<pShapes;i++)
+	{
+		b2AABB lAABB;
+		lShapes[i]->ComputeAABB(&lAABB,lXf2[i]);
+
+		if( !_same(lAABB.lowerBound,lLower[i]) )
+			lMismatches += _mismatch("lower",i,lAABB.lowerBound,lLower[i]);
+		if( !_same(lAABB.upperBound,lUpper[i]) )
+			lMismatches += _mismatch("upper",i,lAABB.upperBound,lUpper[i]);
+	}
+
+	// vertex sets of every length, odd ones take the scalar tail
+	b2Vec2 lVerts[b2_maxPolygonVertices], lOut[b2_maxPolygonVertices];
+
+	for(int i=0;i<pShapes;i++)
+	{
+		const int lCount = 1 + i % b2_maxPolygonVertices;
+
+		for(int j=0;j<lCount;j++)
+			lVerts[j].Set(b2Random(-10.0f,10.0f),b2Random(-10.0f,10.0f));
+
+		b2MulBatch(lXf1[i],lVerts,lOut,lCount);
+
+		for(int j=0;j<lCount;j++)
+		{
+			const b2Vec2 lScalar = b2Mul(lXf1[i],lVerts[j]);
+
+			if( !_same(lScalar,lOut[j]) )
+				lMismatches += _mismatch("vertex",i,lScalar,lOut[j]);
+		}
+	}
+
+	printf("Kernels: %d shapes checked, %d mismatches (%s)\n\n",pShapes,lMismatches,
+#ifdef B2_USE_SSE
+		   "SSE"
+#else
+		   "scalar fallback"
+#endif
+		   );
+
+	delete lWorld;
+
+	return lMismatches;
+}
+
+void Headless::benchKernels( int pShapes, int pReps )
+{
+	if( pShapes <= 0 || pReps <= 0 )
+		return;
+
+	// the broadphase is not involved, stay clear of its proxy limit
+	b2AABB lWorldAABB;
+	lWorldAABB.lowerBound.Set(-1000.0f,-1000.0f);
+	lWorldAABB.upperBound.Set(1000.0f,1000.0f);
+
+	b2World *lWorld = new b2World(lWorldAABB,b2Vec2(0.0f,0.0f),false);
+
+	QVector<b2Shape *> lShapes;
+	QVector<b2XForm> lXf1(pShapes), lXf2(pShapes);
+
+	for(int i=0;i<pShapes;i++)
+	{
+		b2BodyDef lBodyDef;
+		lBodyDef.position.Set(b2Random(-900.0f,900.0f),b2Random(-900.0f,900.0f));
+		lBodyDef.angle = b2Random(-b2_pi,b2_pi);
+
+		b2Body *lBody = lWorld->CreateBody(&lBodyDef);
+
+		if( i % 2 )
+		{
+			b2CircleDef lCircle;
+			lCircle.radius = b2Random(0.1f,1.0f);
+			lShapes.push_back(lBody->CreateShape(&lCircle));
+		}
+		else
+		{
+			b2PolygonDef lBox;
+			lBox.SetAsBox(b2Random(0.1f,1.0f),b2Random(0.1f,1.0f));
+			lShapes.push_back(lBody->CreateShape(&lBox));
+		}
+
+		// a small step between the two transforms
+		lXf2[i] = lBody->GetXForm();
+		lXf1[i].position = lXf2[i].position - b2Vec2(b2Random(),b2Random());
+		lXf1[i].R.Set(lBodyDef.angle - 0.1f);
+	}
+
+	QVector<b2LocalBox> lBoxes(pShapes);
+	QVector<b2Vec2> lLower(pShapes), lUpper(pShapes);
+	float lSink = 0.0f;
+
+	// swept AABBs, virtual per shape call
+	qint64 lTicks = Utils::getTicks();
+	for(int r=0;r<pReps;r++)
+	{
+		for(int i=0;i<pShapes;i++)
+		{
+			b2AABB lAABB;
+			lShapes[i]->ComputeSweptAABB(&lAABB,lXf1[i],lXf2[i]);
+			lSink += lAABB.lowerBound.x;
+		}
+	}
+	float lScalar = Utils::getElapsed(lTicks);
+
+	// swept AABBs, gather + one kernel call (as b2World does)
+	lTicks = Utils::getTicks();
+	for(int r=0;r<pReps;r++)
+	{
+		for(int i=0;i<pShapes;i++)
+			lBoxes[i] = lShapes[i]->GetLocalBox();
+
+		b2ComputeSweptAABBs(lBoxes.data(),lXf1.data(),lXf2.data(),lLower.data(),lUpper.data(),pShapes);
+		lSink += lLower[r % pShapes].x;
+	}
+	float lBatched = Utils::getElapsed(lTicks);
+
+	printf("Kernels: %d shapes, %d reps (%s)\n",pShapes,pReps,
+#ifdef B2_USE_SSE
+		   "SSE"
+#else
+		   "scalar fallback"
+#endif
+		   );
+	printf("%-10s %10s %10s %10s\n","(ns/item)","scalar","batched","speedup");
+
+	_print("swept",lScalar,lBatched,pShapes*pReps);
+
+	// vertex sets, one polygon's worth per transform
+	b2Vec2 lVerts[b2_maxPolygonVertices], lOut[b2_maxPolygonVertices];
+	for(int i=0;i<b2_maxPolygonVertices;i++)
+		lVerts[i].Set(b2Random(),b2Random());
+
+	lTicks = Utils::getTicks();
+	for(int r=0;r<pReps;r++)
+	{
+		for(int i=0;i<pShapes;i++)
+		{
+			for(int j=0;j<b2_maxPolygonVertices;j++)
+				lOut[j] = b2Mul(lXf2[i],lVerts[j]);
+
+			lSink += lOut[i % b2_maxPolygonVertices].y;
+		}
+	}
+	lScalar = Utils::getElapsed(lTicks);
+
+	lTicks = Utils::getTicks();
+	for(int r=0;r<pReps;r++)
+	{
+		for(int i=0;i<pShapes;i++)
+		{
+			b2MulBatch(lXf2[i],lVerts,lOut,b2_maxPolygonVertices);
+			lSink += lOut[i % b2_maxPolygonVertices].y;
+		}
+	}
+	lBatched = Utils::getElapsed(lTicks);
+
+	_print("vertices",lScalar,lBatched,pShapes*pReps*b2_maxPolygonVertices);
+
+	// keep the loops from being optimized away
+	printf("(checksum %g)\n\n",lSink);
+
+	delete lWorld;
+}
@@ -0,0 +1,193 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include <QtGui/QApplication>
+#include <QtCore/QStringList>
+
+#include "env.h"
+#include "gamemanager.h"
+#include "igame.h"
+
+#include "runner.h"
+#include "scenarios.h"
+#include "kernels.h"
+
+#include "games/pyp/pyp.h"
+#include "games/template/template.h"
+#include "games/force/force.h"
+#include "games/tail/tail.h"
+#include "games/anim/anim.h"
+#include "games/jelly/jelly.h"
+#include "games/autumn/autumn.h"
+
+#include <stdio.h>
+
+using namespace Sys;
+using namespace Game;
+using namespace Headless;
+
+static void usage( void )
+{
+	printf("usage: Prototype2D-headless [options] [name ...]\n\n");
+	printf("  -frames N    number of frames to step (default 1000)\n");
+	printf("  -pipelined   step physics on a worker thread\n");
+	printf("  -realtime    feed wall clock time to the physics (default one step per frame)\n");
+	printf("  -kernels     check and time the batched Box2D kernels against the scalar code\n");
+	printf("  -list        list all games and scenarios\n\n");
+	printf("Runs every game and scenario when no name is given.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	// no GUI, no display connection needed
+	QApplication lApp(argc, argv, false);
+
+	Env *lEnv = &Env::getInstance();
+	GameManager *lGames = &GameManager::getInstance();
+
+	// add all built-in games
+	lGames->addGame("Pyp",new Pyp::Game());
+	lGames->addGame("Template",new Template::Game());
+	lGames->addGame("Apply Force",new Force::Game());
+	lGames->addGame("GL Tail Clone",new Tail::Game());
+	lGames->addGame("Animation",new Animation::Game());
+	lGames->addGame("Jelly (Springs)",new Jelly::Game());
+	lGames->addGame("Autumn",new Autumn::Game());
+
+	// add all scripted scenarios
+	lGames->addGame("Scenario: Stack",new Stack());
+	lGames->addGame("Scenario: Rain",new Rain(false));
+	lGames->addGame("Scenario: Rain (recycled)",new Rain(true));
+	lGames->addGame("Scenario: Decor",new Decor(false));
+	lGames->addGame("Scenario: Decor (layers)",new Decor(true));
+	lGames->addGame("Scenario: Reload",new Reload());
+	lGames->addGame("Scenario: Snapshot",new Snapshot());
+	lGames->addGame("Scenario: Level",new Level());
+	lGames->addGame("Scenario: Swarm",new Swarm(true));
+	lGames->addGame("Scenario: Swarm (scalar sync)",new Swarm(false));
+	lGames->addGame("Scenario: Churn",new Churn(false));
+	lGames->addGame("Scenario: Churn (prefab)",new Churn(true));
+	lGames->addGame("Scenario: Sprawl",new Sprawl(true));
+	lGames->addGame("Scenario: Sprawl (no culling)",new Sprawl(false));
+	lGames->addGame("Scenario: Rigs",new Rigs());
+	lGames->addGame("Scenario: Stream",new Stream());
+	lGames->addGame("Scenario: Tiles",new Tiles(false));
+	lGames->addGame("Scenario: Tiles (sorted)",new Tiles(true));
+
+	int lFrames = 1000;
+	QStringList lNames;
+
+	// exactly one physics step per frame by default
+	lEnv->mFixedFrameTime = lEnv->mTimeStep;
+
+	QStringList lArgs = lApp.arguments();
+	for(int i=1;i<lArgs.size();i++)
+	{
+		const QString &lArg = lArgs[i];
+
+		if( lArg == "-frames" && i+1 < lArgs.size() )
+			lFrames = lArgs[++i].toInt();
+		else if( lArg == "-pipelined" )
+			lEnv->mPipelined = true;
+		else if( lArg == "-realtime" )
+			lEnv->mFixedFrameTime = 0.0f;
+		else if( lArg == "-kernels" )
+		{
+			// a mismatch fails the run, the timings aren't worth much then
+			int lMismatches = checkKernels(1000);
+			if( !lMismatches )
+				benchKernels(400,2000);
+
+			lGames->removeAll();
+			return lMismatches?1:0;
+		}
+		else if( lArg == "-list" )
+		{
+			GameManager::GameArray::const_iterator lIt = lGames->getGames().constBegin();
+			for( ; lIt!= lGames->getGames().constEnd(); ++lIt )
+				printf("%s\n",lIt.key().toLatin1().constData());
+
+			lGames->removeAll();
+			return 0;
+		}
+		else if( lArg.startsWith("-") )
+		{
+			usage();
+			lGames->removeAll();
+			return 1;
+		}
+		else
+			lNames.push_back(lArg);
+	}
+
+	if( lFrames <= 0 )
+	{
+		usage();
+		lGames->removeAll();
+		return 1;
+	}
+
+	if( lNames.isEmpty() )
+		lNames = lGames->getGames().keys();
+
+	int lRet = 0;
+	Runner lRunner;
+
+	for(int i=0;i<lNames.size();i++)
+	{
+		Interface::IGame *lGame = lGames->findGame(lNames[i]);
+
+		if( !lGame )
+		{
+			printf("Unknown game or scenario: %s\n",lNames[i].toLatin1().constData());
+			lRet = 1;
+			continue;
+		}
+
+		if( !lRunner.run(lGame,lFrames) )
+		{
+			printf("%s: FAILED\n\n",lNames[i].toLatin1().constData());
+			lRet = 1;
+			continue;
+		}
+
+		lRunner.report(lNames[i]);
+	}
+
+	// remove all games
+	lGames->removeAll();
+
+	return lRet;
+}
@@ -0,0 +1,187 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include "runner.h"
+#include "igame.h"
+#include "world.h"
+#include "utils.h"
+
+#include <QtAlgorithms>
+#include <QtCore/QDebug>
+
+#include <stdio.h>
+
+using namespace Headless;
+using namespace Interface;
+using namespace GL;
+
+Runner::Runner() : mTotal(0.0f), mShutdown(0.0f)
+{
+}
+
+Runner::~Runner()
+{
+}
+
+bool Runner::run( IGame *pGame, int pFrames )
+{
+	Q_ASSERT( pGame != 0 );
+	Q_ASSERT( pFrames > 0 );
+
+	_clear();
+
+	if( !pGame->configure() || !pGame->init() )
+	{
+		qDebug() << "Error: [Runner] Failed to initialize the game";
+		return false;
+	}
+
+	World *lWorld = pGame->getWorld();
+
+	mThink.reserve(pFrames);
+	mUpdate.reserve(pFrames);
+	mPhysics.reserve(pFrames);
+	mStep.reserve(pFrames);
+	mRender.reserve(pFrames);
+	mPairs.reserve(pFrames);
+	mContacts.reserve(pFrames);
+	mDrawn.reserve(pFrames);
+	mDrawCalls.reserve(pFrames);
+	mStateChanges.reserve(pFrames);
+
+	qint64 lStart = Utils::getTicks();
+
+	for(int i=0;i<pFrames;i++)
+	{
+		qint64 lTicks = Utils::getTicks();
+		pGame->think();
+		mThink.push_back(Utils::getElapsed(lTicks));
+
+		if( lWorld )
+		{
+			mUpdate.push_back(lWorld->getUpdateTime());
+			mPhysics.push_back(lWorld->getPhysicsTime());
+
+			const b2Profile &lProfile = lWorld->getProfile();
+			mStep.push_back(lProfile.step);
+			mPairs.push_back(lProfile.pairCount);
+			mContacts.push_back(lProfile.contactCount);
+
+			lTicks = Utils::getTicks();
+			lWorld->render();
+			mRender.push_back(Utils::getElapsed(lTicks));
+			mDrawn.push_back(lWorld->getDrawnCount());
+			mDrawCalls.push_back(lWorld->getDrawCalls());
+			mStateChanges.push_back(lWorld->getStateChanges());
+		}
+	}
+
+	mTotal = Utils::getElapsed(lStart);
+
+	lStart = Utils::getTicks();
+	const bool lPassed = pGame->shutdown();
+	mShutdown = Utils::getElapsed(lStart);
+
+	// scenarios fail their checks this way
+	if( !lPassed )
+	{
+		qDebug() << "Error: [Runner] The game failed to shut down cleanly";
+		return false;
+	}
+
+	return true;
+}
+
+void Runner::report( const QString &pName ) const
+{
+	printf("%s: %d frames in %.2f ms, shutdown in %.2f ms\n",pName.toLatin1().constData(),
+		   mThink.size(),mTotal,mShutdown);
+	printf("%-10s %10s %10s %10s %10s %10s\n","(ms)","mean","p50","p90","p99","max");
+
+	_report("think",mThink);
+	_report("update",mUpdate);
+	_report("physics",mPhysics);
+	_report("b2step",mStep);
+	_report("render",mRender);
+
+	printf("%-10s\n","(count)");
+
+	_report("pairs",mPairs);
+	_report("contacts",mContacts);
+	_report("drawn",mDrawn);
+	_report("draws",mDrawCalls);
+	_report("states",mStateChanges);
+
+	printf("\n");
+}
+
+void Runner::_clear( void )
+{
+	mThink.clear();
+	mUpdate.clear();
+	mPhysics.clear();
+	mStep.clear();
+	mRender.clear();
+	mPairs.clear();
+	mContacts.clear();
+	mDrawn.clear();
+	mDrawCalls.clear();
+	mStateChanges.clear();
+
+	mTotal = 0.0f;
+	mShutdown = 0.0f;
+}
+
+void Runner::_report( const char *pLabel, SampleArray pSamples ) const
+{
+	if( pSamples.isEmpty() )
+		return;
+
+	qSort(pSamples.begin(),pSamples.end());
+
+	const int lCount = pSamples.size();
+	double lSum = 0.0;
+
+	for(int i=0;i<lCount;i++)
+		lSum += pSamples[i];
+
+	// nearest rank
+	#define PERCENTILE(p) pSamples[ qMin(lCount-1, (int)((p) * lCount / 100)) ]
+
+	printf("%-10s %10.4f %10.4f %10.4f %10.4f %10.4f\n",pLabel,lSum / lCount,
+		   PERCENTILE(50),PERCENTILE(90),PERCENTILE(99),pSamples[lCount-1]);
+
+	#undef PERCENTILE
+}
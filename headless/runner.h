@@ -0,0 +1,92 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#ifndef RUNNER_H
+#define RUNNER_H
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+namespace Interface
+{
+	class IGame;
+}
+
+namespace Headless {
+
+//! Steps a game as fast as possible without a GL context
+/*!
+	Every frame is a single IGame::think() followed by a
+	World::render() (actors don't draw anything headless,
+	so that's the culling pass only). Per frame timings
+	are collected and printed as percentiles by report().
+	A game whose shutdown() returns false fails the run.
+*/
+class Runner
+{
+public:
+	Runner();
+	virtual ~Runner();
+
+	//! configure, init, think pFrames times, shutdown
+	virtual bool run( Interface::IGame *pGame, int pFrames );
+	virtual void report( const QString &pName ) const;
+
+protected:
+	typedef QVector<float> SampleArray;
+
+	virtual void _clear( void );
+	virtual void _report( const char *pLabel, SampleArray pSamples ) const;
+
+protected:
+	SampleArray mThink;
+	SampleArray mUpdate;
+	SampleArray mPhysics;
+	SampleArray mStep;
+	SampleArray mRender;
+
+	SampleArray mPairs;
+	SampleArray mContacts;
+	SampleArray mDrawn;
+	SampleArray mDrawCalls;
+	SampleArray mStateChanges;
+
+	float mTotal; // ms
+	float mShutdown; // ms
+};
+
+/* Headless */ }
+
+#endif // RUNNER_H
@@ -0,0 +1,964 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include "scenarios.h"
+#include "env.h"
+#include "texture.h"
+
+#include <QtAlgorithms>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+
+#include <math.h>
+
+using namespace Headless;
+using namespace GL;
+using namespace Sys;
+
+static Env *gEnv = &Env::getInstance();
+
+//! Anything but a plain Actor
+class Marker : public Actor
+{
+public:
+	Marker( const QString &pName, World *pWorld ) : Actor(pName,pWorld) {}
+};
+
+//! Draws more than its sprite, counts its render() calls
+class Badge : public Actor
+{
+public:
+	Badge( const QString &pName, World *pWorld ) : Actor(pName,pWorld), mRendered(0) {}
+
+	virtual void render( void ) { mRendered++; Actor::render(); }
+
+	int mRendered;
+};
+
+Scenario::Scenario() : mWorld(0), mFrame(0), mFailures(0)
+{
+}
+
+Scenario::~Scenario()
+{
+}
+
+bool Scenario::configure( void )
+{
+	return true;
+}
+
+bool Scenario::init(void)
+{
+	mWorld = new World;
+	mFrame = 0;
+	mFailures = 0;
+
+	_build();
+	return true;
+}
+
+bool Scenario::shutdown(void)
+{
+	if( mWorld )
+		delete mWorld;
+
+	mWorld = 0;
+	return !mFailures;
+}
+
+void Scenario::render(Canvas *pCanvas)
+{
+	Q_UNUSED(pCanvas);
+	mWorld->render();
+}
+
+void Scenario::think(Canvas *pCanvas)
+{
+	Q_UNUSED(pCanvas);
+
+	// UPDATE PHYSICS FIRST
+	mWorld->updatePhysics();
+
+	_script(mFrame++);
+
+	// UPDATE WORLD
+	mWorld->update();
+}
+
+bool Scenario::updateMouse(int pX, int pY, int pButton, t_MouseState pState)
+{
+	Q_UNUSED(pX);
+	Q_UNUSED(pY);
+	Q_UNUSED(pButton);
+	Q_UNUSED(pState);
+
+	return false;
+}
+
+bool Scenario::updateKeys(int pKey, t_KeyState pState)
+{
+	Q_UNUSED(pKey);
+	Q_UNUSED(pState);
+
+	return false;
+}
+
+void Scenario::_script( int pFrame )
+{
+	Q_UNUSED(pFrame);
+}
+
+bool Scenario::_check( bool pPassed, const char *pWhat, int pLine )
+{
+	if( pPassed )
+		return true;
+
+	// the first few are enough
+	if( mFailures++ < 10 )
+		qDebug() << "Error: [Scenario] Frame" << mFrame << "line" << pLine << "failed:" << pWhat;
+
+	return false;
+}
+
+bool Scenario::t_transform::operator<( const t_transform &pOther ) const
+{
+	// tenths of a pixel, so rounding doesn't reorder equal rows
+	const float lY = floorf(mY * 10.0f), lOtherY = floorf(pOther.mY * 10.0f);
+
+	if( lY != lOtherY )
+		return lY < lOtherY;
+
+	return mX < pOther.mX;
+}
+
+void Scenario::_getTransforms( TransformArray *pTransforms ) const
+{
+	Q_ASSERT( pTransforms != 0 );
+
+	QVector<Actor *> lActors;
+	mWorld->getActors(&lActors);
+
+	pTransforms->resize(lActors.size());
+
+	for(int i=0;i<lActors.size();i++)
+	{
+		t_transform &lTransform = (*pTransforms)[i];
+		b2Body *lBody = lActors[i]->getBody();
+
+		if( lBody )
+		{
+			lTransform.mX = W2S_(lBody->GetPosition().x);
+			lTransform.mY = W2S_(lBody->GetPosition().y);
+			lTransform.mRot = lBody->GetAngle();
+		}
+		else
+		{
+			lTransform.mX = lActors[i]->getPosX();
+			lTransform.mY = lActors[i]->getPosY();
+			lTransform.mRot = 0.0f;
+		}
+	}
+
+	qSort(pTransforms->begin(),pTransforms->end());
+}
+
+bool Scenario::_compareTransforms( const TransformArray &pA, const TransformArray &pB, float pTolerance ) const
+{
+	if( pA.size() != pB.size() )
+		return false;
+
+	for(int i=0;i<pA.size();i++)
+	{
+		if( fabsf(pA[i].mX - pB[i].mX) > pTolerance ||
+			fabsf(pA[i].mY - pB[i].mY) > pTolerance ||
+			fabsf(pA[i].mRot - pB[i].mRot) > pTolerance )
+			return false;
+	}
+
+	return true;
+}
+
+Actor *Scenario::_spawn( float pX, float pY, float pW, float pH, float pDensity, unsigned long pShape, int pLayer )
+{
+	Actor *lActor = mWorld->createActor<Actor>("Body",true);
+	lActor->setFlags(pShape);
+	lActor->setRect(pX,pY,pW,pH);
+	lActor->setDensity(pDensity);
+	lActor->setLayer(pLayer);
+	lActor->applyPhysX();
+
+	return lActor;
+}
+
+void Stack::_build( void )
+{
+	const int lRows = 12;
+	const float lSize = 20.0f;
+
+	// static ground along the bottom of the screen
+	_spawn(0,gEnv->mSHeight-20,gEnv->mSWidth,20,0.0f);
+
+	for(int i=0;i<lRows;i++)
+	{
+		float lY = gEnv->mSHeight - 20 - (i+1)*lSize;
+		float lX = gEnv->mSWidth/2 - (lRows-i)*lSize/2;
+
+		for(int j=0;j<lRows-i;j++)
+			_spawn(lX+j*lSize,lY,lSize,lSize,1.0f);
+	}
+}
+
+void Rain::_build( void )
+{
+	// a few pegs to bounce off
+	for(int i=0;i<8;i++)
+		_spawn(60+i*90,300+(i%2)*60,30,30,0.0f,Actor::S_CIRCLE);
+}
+
+void Rain::_script( int pFrame )
+{
+	// a new ball every other frame, frozen ones are retired by the world
+	if( pFrame % 2 )
+		return;
+
+	float lX = 20 + (pFrame * 37) % (gEnv->mSWidth - 40);
+
+	Actor *lActor = (mRecycle)?mWorld->reviveActor<Actor>("Body",lX,-20):0;
+
+	if( lActor )
+	{
+		// nothing carried over from its last life
+		b2Body *lBody = lActor->getBody();
+
+		if( SCENARIO_CHECK( lBody && lBody->IsActive() && !lBody->IsFrozen() ) )
+		{
+			SCENARIO_CHECK( lBody->GetLinearVelocity().LengthSquared() == 0.0f );
+			SCENARIO_CHECK( lBody->GetAngularVelocity() == 0.0f );
+
+			// the body went along
+			SCENARIO_CHECK( fabsf(W2S_(lBody->GetPosition().x) - (lX + lActor->getHWidth())) < 0.01f );
+			SCENARIO_CHECK( fabsf(W2S_(lBody->GetPosition().y) - (lActor->getHHeight() - 20.0f)) < 0.01f );
+		}
+
+		SCENARIO_CHECK( lActor->getPosX() == lX && lActor->getPosY() == -20.0f );
+		return;
+	}
+
+	_spawn(lX,-20,12,12,1.0f,Actor::S_CIRCLE);
+}
+
+void Decor::_build( void )
+{
+	int lDecor = 0;
+
+	if( mLayers )
+	{
+		lDecor = mWorld->addLayer("Decor");
+		mWorld->setLayersCollide(lDecor,lDecor,false);
+	}
+
+	// static ground along the bottom of the screen
+	_spawn(0,gEnv->mSHeight-20,gEnv->mSWidth,20,0.0f);
+
+	// a few heavy crates
+	for(int i=0;i<6;i++)
+		_spawn(100+i*110,gEnv->mSHeight-60,40,40,2.0f);
+
+	// static clouds the leaves drift through
+	for(int i=0;i<4;i++)
+		_spawn(50+i*190,120+(i%2)*40,140,40,0.0f,Actor::S_BOX,lDecor);
+}
+
+void Decor::_script( int pFrame )
+{
+	// three leaves every other frame, 300 in total
+	if( pFrame >= 200 || pFrame % 2 )
+		return;
+
+	int lDecor = (mLayers)?mWorld->getLayer("Decor"):0;
+
+	for(int i=0;i<3;i++)
+	{
+		float lX = 10 + ((pFrame * 3 + i) * 53) % (gEnv->mSWidth - 20);
+		_spawn(lX,-10 - i*12,8,4,0.1f,Actor::S_BOX,lDecor);
+	}
+}
+
+void Reload::_build( void )
+{
+	const int lChains = 4;
+	const int lLinks = 20;
+	const float lLink = 12.0f;
+
+	// static ground along the bottom of the screen
+	_spawn(0,gEnv->mSHeight-20,gEnv->mSWidth,20,0.0f);
+
+	// chains hanging from static anchors
+	for(int i=0;i<lChains;i++)
+	{
+		float lX = 100 + i*180;
+		Actor *lPrev = _spawn(lX,40,10,10,0.0f);
+
+		for(int j=0;j<lLinks;j++)
+		{
+			float lY = 50 + j*lLink;
+			Actor *lNext = _spawn(lX+1,lY,8,lLink,0.5f);
+
+			mWorld->createJoint("Link",lPrev,lNext,lX+5,lY,true);
+			lPrev = lNext;
+		}
+	}
+
+	// a pile of loose boxes
+	for(int i=0;i<200;i++)
+		_spawn(20 + (i*47) % (gEnv->mSWidth-40),300 + (i/16)*14,10,10,1.0f);
+}
+
+void Reload::_script( int pFrame )
+{
+	// start the level over every 100 frames
+	if( !pFrame || pFrame % 100 )
+		return;
+
+	mWorld->removeAll();
+	_build();
+}
+
+void Snapshot::_build( void )
+{
+	// static ground along the bottom of the screen
+	_spawn(0,gEnv->mSHeight-20,gEnv->mSWidth,20,0.0f);
+
+	// a small pyramid coming to rest
+	for(int i=0;i<6;i++)
+	{
+		for(int j=0;j<6-i;j++)
+			mBox = _spawn(300 + i*10 + j*20,gEnv->mSHeight-40-i*20,20,20,1.0f)->getHandle();
+	}
+
+	// a swinging chain, its links only held by the joints: contacts
+	// made since a snapshot keep their place in the contact list, a
+	// chain folding onto itself would only replay up to rounding
+	const int lChain = mWorld->addLayer("Chain");
+	mWorld->setLayersCollide(lChain,lChain,false);
+
+	Actor *lPrev = _spawn(100,40,10,10,0.0f,Actor::S_BOX,lChain);
+
+	for(int i=0;i<12;i++)
+	{
+		Actor *lNext = _spawn(101 + i*12,50,12,8,0.5f,Actor::S_BOX,lChain);
+		mWorld->createJoint("Link",lPrev,lNext,101 + i*12,54,true);
+
+		mLink = lPrev->getHandle();
+		mLinkNext = lNext->getHandle();
+		lPrev = lNext;
+	}
+}
+
+void Snapshot::_script( int pFrame )
+{
+	// give the pile some time to settle first
+	if( pFrame < 60 )
+		return;
+
+	switch( pFrame % 60 )
+	{
+	case 0:
+		SCENARIO_CHECK( mWorld->saveState(&mState) );
+		_getTransforms(&mSaved);
+		break;
+
+	case 20:
+	{
+		_getTransforms(&mStepped);
+
+		SCENARIO_CHECK( mWorld->restoreState(mState) );
+
+		TransformArray lRestored;
+		_getTransforms(&lRestored);
+
+		SCENARIO_CHECK( _compareTransforms(mSaved,lRestored,0.0f) );
+		break;
+	}
+
+	case 40:
+	{
+		// same steps from the same state, same result
+		if( gEnv->mFixedFrameTime > 0.0f )
+		{
+			TransformArray lReplayed;
+			_getTransforms(&lReplayed);
+
+			SCENARIO_CHECK( _compareTransforms(mStepped,lReplayed,0.0f) );
+		}
+
+		QByteArray lState;
+
+		// a new body for the same actor
+		SCENARIO_CHECK( mWorld->saveState(&lState) );
+
+		Actor *lBox = mWorld->findActor<Actor>(mBox);
+		lBox->removePhysX();
+		lBox->applyPhysX();
+
+		_checkRefused(lState);
+
+		// a new joint between the same actors
+		SCENARIO_CHECK( mWorld->saveState(&lState) );
+
+		Actor *lLink = mWorld->findActor<Actor>(mLink);
+		Actor *lLinkNext = mWorld->findActor<Actor>(mLinkNext);
+
+		mWorld->removeJoint(lLinkNext);
+		mWorld->createJoint("Link",lLink,lLinkNext,lLinkNext->getPosX(),lLinkNext->getPosY()+4,true);
+
+		_checkRefused(lState);
+
+		// a new actor in place of an old one
+		SCENARIO_CHECK( mWorld->saveState(&lState) );
+
+		mWorld->removeActor(lBox);
+		mBox = _spawn(300,gEnv->mSHeight-200,20,20,1.0f)->getHandle();
+
+		_checkRefused(lState);
+		break;
+	}
+	}
+}
+
+void Snapshot::_checkRefused( const QByteArray &pState )
+{
+	TransformArray lBefore, lAfter;
+	_getTransforms(&lBefore);
+
+	SCENARIO_CHECK( !mWorld->restoreState(pState) );
+
+	_getTransforms(&lAfter);
+	SCENARIO_CHECK( _compareTransforms(lBefore,lAfter,0.0f) );
+}
+
+bool Level::shutdown( void )
+{
+	mScene.close();
+	QFile::remove(QDir::tempPath() + "/level.scn");
+
+	return Reload::shutdown();
+}
+
+void Level::_build( void )
+{
+	if( mScene.isOpen() )
+	{
+		SCENARIO_CHECK( mScene.load(mWorld) == mSaved.size() );
+		SCENARIO_CHECK( mWorld->getJointCount() == mJoints );
+
+		TransformArray lLoaded;
+		_getTransforms(&lLoaded);
+
+		SCENARIO_CHECK( _compareTransforms(mSaved,lLoaded,0.001f) );
+		return;
+	}
+
+	// built once, loaded from then on
+	Reload::_build();
+
+	// gone with the next update(), they mustn't be saved
+	mWorld->removeActorLater(_spawn(100,100,10,10,1.0f));
+	mWorld->retireActor(_spawn(120,100,10,10,1.0f));
+
+	const QString lFileName = QDir::tempPath() + "/level.scn";
+
+	_getTransforms(&mSaved);
+	mJoints = mWorld->getJointCount();
+
+	if( SCENARIO_CHECK( mScene.save(mWorld,lFileName) ) )
+		SCENARIO_CHECK( mScene.open(lFileName) );
+}
+
+void Swarm::_build( void )
+{
+	mWorld->getPhysicsWorld()->SetBatchSynchronize(mBatched);
+
+	// walls
+	_spawn(0,gEnv->mSHeight-20,gEnv->mSWidth,20,0.0f);
+	_spawn(0,0,20,gEnv->mSHeight-20,0.0f);
+	_spawn(gEnv->mSWidth-20,0,20,gEnv->mSHeight-20,0.0f);
+}
+
+void Swarm::_script( int pFrame )
+{
+	// eight bodies a frame, 400 in total
+	if( pFrame >= 50 )
+		return;
+
+	for(int i=0;i<8;i++)
+	{
+		float lX = 40 + ((pFrame * 8 + i) * 71) % (gEnv->mSWidth - 80);
+		_spawn(lX,-20,10,10,1.0f,(i % 2)?Actor::S_CIRCLE:Actor::S_BOX);
+	}
+}
+
+void Sprawl::_build( void )
+{
+	mWorld->setCulling(mCulling);
+	mMoving.clear();
+
+	// a few bodies in the middle
+	_spawn(0,gEnv->mSHeight-20,gEnv->mSWidth,20,0.0f);
+
+	for(int i=0;i<100;i++)
+		_spawn(40 + (i * 71) % (gEnv->mSWidth - 80),(i / 10) * 20,10,10,1.0f);
+
+	// sprites all over a 10x10 screens area around it
+	const int lW = gEnv->mSWidth * 10;
+	const int lH = gEnv->mSHeight * 10;
+
+	for(int i=0;i<20000;i++)
+	{
+		int lSeed = i * 104729;
+
+		Actor *lActor = mWorld->createActor<Actor>("Sprite",true);
+		lActor->setRect(lSeed % lW - lW / 2,(lSeed / 7) % lH - lH / 2,16,16);
+
+		if( !(i % 50) )
+			mMoving.push_back(lActor->getHandle());
+	}
+}
+
+void Sprawl::_script( int pFrame )
+{
+	// pan around the middle
+	mWorld->setViewRect((pFrame % 200) * 4 - 400,0,gEnv->mSWidth,gEnv->mSHeight);
+
+	for(int i=0;i<mMoving.size();i++)
+	{
+		Actor *lActor = mWorld->findActor<Actor>(mMoving[i]);
+
+		if( !SCENARIO_CHECK( lActor != 0 ) )
+			continue;
+
+		lActor->moveXY((i % 2)?2.0f:-2.0f,1.0f);
+	}
+}
+
+void Churn::_build( void )
+{
+	mSpawned.clear();
+	mSpawned.resize(mLifetime);
+
+	// a floor to land on
+	_spawn(0,gEnv->mSHeight-20,gEnv->mSWidth,20,0.0f);
+
+	// a name spelled like the next unique one mustn't be handed out twice
+	NameTable &lNames = NameTable::getInstance();
+	const t_name lNext = lNames.unique(lNames.intern("Body")) + 1;
+
+	Actor *lSpelled = mWorld->createActor<Actor>(lNames.toString(lNext));
+	Actor *lUnique = mWorld->createActor<Actor>("Body",true);
+
+	SCENARIO_CHECK( lUnique->getName() != lSpelled->getName() );
+	SCENARIO_CHECK( mWorld->findActor<Actor>(lUnique->getName()) == lUnique );
+	SCENARIO_CHECK( mWorld->findActor<Actor>(lSpelled->getName()) == lSpelled );
+
+	mWorld->removeActor(lSpelled);
+	mWorld->removeActor(lUnique);
+
+	mBall = 0;
+
+	if( !mPrefab )
+		return;
+
+	mBall = mWorld->createPrefab<Actor>("Body");
+
+	// animated (see _script()), set before the size
+	Texture *lTexture = new Texture();
+	mBall->getActor()->setTexture(lTexture);
+	lTexture->drop();
+
+	mBall->getActor()->setFlags(Actor::S_CIRCLE);
+	mBall->getActor()->setSize(6,6);
+	mBall->getActor()->setDensity(1.0f);
+	mBall->setPhysical(true);
+}
+
+void Churn::_script( int pFrame )
+{
+	const int lPerSecond = 10000;
+	const float lSteps = 1.0f / gEnv->mTimeStep;
+
+	QVector<t_handle> &lBucket = mSpawned[pFrame % mLifetime];
+
+	// the oldest ones go (unless frozen & gone already)
+	for(int i=0;i<lBucket.size();i++)
+	{
+		Actor *lActor = mWorld->findActor<Actor>(lBucket[i]);
+
+		if( !lActor )
+			continue;
+
+		// gone for good, even before it's deleted
+		mWorld->removeActorLater(lActor);
+		SCENARIO_CHECK( !mWorld->findActor<Actor>(lBucket[i]) );
+	}
+
+	lBucket.clear();
+
+	// spread 10k/s evenly over the frames
+	int lCount = (int)((pFrame+1) * lPerSecond / lSteps) - (int)(pFrame * lPerSecond / lSteps);
+
+	t_point *lPos = new t_point[lCount];
+
+	for(int i=0;i<lCount;i++)
+	{
+		int lSeed = pFrame * 7919 + i * 104729;
+		lPos[i][0] = 20 + lSeed % (gEnv->mSWidth - 40);
+		lPos[i][1] = (lSeed / 7) % (gEnv->mSHeight / 2);
+	}
+
+	QVector<Actor *> lActors(lCount);
+
+	if( mBall )
+	{
+		// new frames for the next ones, the live ones still draw theirs
+		mBall->getActor()->setNumFrames(2 + pFrame % 3);
+		mWorld->spawn(mBall,lPos,lCount,lActors.data());
+	}
+	else
+	{
+		for(int i=0;i<lCount;i++)
+			lActors[i] = _spawn(lPos[i][0],lPos[i][1],6,6,1.0f,Actor::S_CIRCLE);
+	}
+
+	for(int i=0;i<lCount;i++)
+	{
+		lBucket.push_back(lActors[i]->getHandle());
+
+		// fresh serials, one after the other, each on top of the last
+		if( i > 0 )
+		{
+			SCENARIO_CHECK( NameTable::getSerial(lActors[i]->getNameId()) > NameTable::getSerial(lActors[i-1]->getNameId()) );
+			SCENARIO_CHECK( lActors[i]->getZOrder() > lActors[i-1]->getZOrder() );
+		}
+	}
+
+	// and found by name
+	if( lCount > 0 )
+		SCENARIO_CHECK( mWorld->findActor<Actor>(lActors[lCount-1]->getName()) == lActors[lCount-1] );
+
+	delete [] lPos;
+}
+
+void Rigs::_build( void )
+{
+	mRigs.clear();
+	mRigs.resize(100);
+
+	for(int i=0;i<mRigs.size();i++)
+		_buildRig(i);
+}
+
+void Rigs::_script( int pFrame )
+{
+	const int lIndex = pFrame % mRigs.size();
+
+	const QVector<t_handle> lRig = mRigs[lIndex];
+
+	for(int i=0;i<lRig.size();i++)
+	{
+		Actor *lActor = mWorld->findActor<Actor>(lRig[i]);
+
+		if( !lActor )
+			continue;
+
+		mWorld->removeActorLater(lActor);
+		SCENARIO_CHECK( !mWorld->findActor<Actor>(lRig[i]) );
+	}
+
+	_buildRig(lIndex);
+
+	// it took the freed slots, the old handles have to stay stale
+	for(int i=0;i<lRig.size();i++)
+		SCENARIO_CHECK( !mWorld->findActor<Actor>(lRig[i]) );
+}
+
+void Rigs::_buildRig( int pIndex )
+{
+	const float lX = 20 + (pIndex % 10) * 78;
+	const float lY = 40 + (pIndex / 10) * 55;
+
+	Actor *lGround = mWorld->getGroundActor();
+
+	Actor *lWheel1 = _spawn(lX,lY,10,10,1.0f,Actor::S_CIRCLE);
+	Actor *lWheel2 = _spawn(lX+20,lY,10,10,1.0f,Actor::S_CIRCLE);
+	Actor *lSlider = _spawn(lX+40,lY,10,6,1.0f);
+	Actor *lWeight = _spawn(lX+55,lY+20,8,8,1.0f);
+	Actor *lCounter = _spawn(lX+40,lY+30,8,8,1.0f);
+
+	ActorJoint *lAxle1 = mWorld->createJoint("Axle",lGround,lWheel1,lX+5,lY+5,true);
+	ActorJoint *lAxle2 = mWorld->createJoint("Axle",lGround,lWheel2,lX+25,lY+5,true);
+
+	PrismaticJoint *lRail = mWorld->createJoint<PrismaticJoint>("Rail",true);
+	lRail->init(lGround,lSlider,lX+45,lY+3,0.0f,1.0f);
+	lRail->setLimits(-10.0f,10.0f);
+
+	mWorld->createJoint<GearJoint>("Gear",true)->init(lAxle1,lAxle2,1.0f);
+	mWorld->createJoint<GearJoint>("Gear",true)->init(lAxle2,lRail,0.5f);
+
+	mWorld->createJoint<DistanceJoint>("Spring",true)->init(lSlider,lWeight,lX+45,lY+3,lX+59,lY+24,4.0f,0.5f);
+	mWorld->createJoint<PulleyJoint>("Pulley",true)->init(lWeight,lCounter,lX+59,lY,lX+44,lY,lX+59,lY+24,lX+44,lY+34);
+
+	QVector<t_handle> &lRig = mRigs[pIndex];
+	lRig.clear();
+
+	lRig.push_back(lWheel1->getHandle());
+	lRig.push_back(lWheel2->getHandle());
+	lRig.push_back(lSlider->getHandle());
+	lRig.push_back(lWeight->getHandle());
+	lRig.push_back(lCounter->getHandle());
+}
+
+bool Stream::configure( void )
+{
+	gEnv->mLevelWidth = gEnv->mSWidth * 40;
+	gEnv->mLevelHeight = gEnv->mSHeight;
+
+	return true;
+}
+
+bool Stream::shutdown( void )
+{
+	if( mStreamer )
+	{
+		qDebug() << "Success: [Stream] " << mStreamer->getActorCount() << " actors loaded, "
+				 << mStreamer->getStoredCount() << " stored";
+
+		delete mStreamer;
+	}
+
+	mStreamer = 0;
+
+	gEnv->mLevelWidth = 0;
+	gEnv->mLevelHeight = 0;
+
+	return Scenario::shutdown();
+}
+
+void Stream::_build( void )
+{
+	const int lW = gEnv->mLevelWidth;
+
+	mStreamer = new ChunkStreamer(mWorld,QDir::tempPath());
+	mStreamer->setRadius(1,2);
+
+	// junk where the chunk files go, as if a crashed run left it
+	for(int x=0;x<lW;x+=WORLD_CHUNK_SIZE)
+	{
+		QFile lFile(QString("%1/chunk_%2_0.bin").arg(QDir::tempPath()).arg(x / WORLD_CHUNK_SIZE));
+
+		if( lFile.open(QIODevice::WriteOnly | QIODevice::Truncate) )
+			lFile.write("leftover",8);
+	}
+
+	// one floor segment per chunk
+	for(int x=0;x<lW;x+=WORLD_CHUNK_SIZE)
+		mStreamed += mStreamer->add(_spawn(x,gEnv->mSHeight-20,qMin(WORLD_CHUNK_SIZE,lW - x),20,0.0f));
+
+	for(int i=0;i<2000;i++)
+		mStreamed += mStreamer->add(_spawn(20 + (i * 7919) % (lW - 40),(i % 20) * 24,10,10,1.0f,(i % 2)?Actor::S_CIRCLE:Actor::S_BOX));
+
+	for(int i=0;i<10000;i++)
+	{
+		Actor *lActor = mWorld->createActor<Actor>("Sprite",true);
+		lActor->setRect((i * 104729) % lW,(i * 31) % (gEnv->mSHeight - 40),16,16);
+
+		mStreamed += mStreamer->add(lActor);
+	}
+
+	// it would come back as a plain Actor
+	SCENARIO_CHECK( !mStreamer->add(mWorld->createActor<Marker>("Marker")) );
+
+	mWorld->setCamera(gEnv->mSWidth / 2,gEnv->mSHeight / 2);
+}
+
+void Stream::_script( int pFrame )
+{
+	// back and forth along the level, 32px a frame
+	const int lRange = gEnv->mLevelWidth - gEnv->mSWidth;
+	const int lX = (pFrame * 32) % (lRange * 2);
+
+	mWorld->setCamera(gEnv->mSWidth / 2 + ((lX < lRange)?lX:lRange * 2 - lX),gEnv->mSHeight / 2);
+
+	// before World::update() flushes the removals
+	mStreamer->update();
+
+	SCENARIO_CHECK( mStreamer->getActorCount() + mStreamer->getStoredCount() == mStreamed );
+}
+
+void Tiles::_build( void )
+{
+	const int lSize = 16;
+	const int lNumTextures = 4;
+
+	mWorld->setSorting(mSorting);
+
+	// no files, sizes and ids don't matter here
+	Texture *lTextures[lNumTextures];
+	for(int i=0;i<lNumTextures;i++)
+		lTextures[i] = new Texture();
+
+	// opaque backdrops, each on its own Z-Order, keep their order
+	for(int i=0;i<8;i++)
+	{
+		Actor *lActor = mWorld->createActor<Actor>("Backdrop",true);
+		lActor->setTexture(lTextures[i % lNumTextures]);
+		lActor->setRect(0,0,gEnv->mSWidth,gEnv->mSHeight);
+	}
+
+	// a third at the Z-Orders they're created with and a third
+	// at one Z-Order a row, both on a render layer, a third
+	// sharing one Z-Order
+	const int lRows = gEnv->mSHeight / lSize;
+
+	for(int y=0;y<lRows;y++)
+	{
+		for(int x=0;x<gEnv->mSWidth / lSize;x++)
+		{
+			Actor *lActor = mWorld->createActor<Actor>("Tile",true);
+			lActor->setTexture(lTextures[(x + y) % lNumTextures]);
+			lActor->setRect(x * lSize,y * lSize,lSize,lSize);
+
+			if( y >= lRows * 2 / 3 )
+			{
+				lActor->setZOrder(2.0f + y * 0.01f);
+				lActor->setRenderLayer(2);
+			}
+			else if( y >= lRows / 3 )
+				lActor->setZOrder(1.0f);
+			else
+				lActor->setRenderLayer(1);
+		}
+	}
+
+	// blended ones on top, alternating textures too
+	for(int i=0;i<40;i++)
+	{
+		Actor *lActor = mWorld->createActor<Actor>("Glass",true);
+		lActor->setTexture(lTextures[i % lNumTextures]);
+		lActor->setRect((i * 7919) % (gEnv->mSWidth - 64),(i * 104729) % (gEnv->mSHeight - 64),64,64);
+		lActor->setBlending(Actor::B_SRC_ALPHA);
+		lActor->setZOrder(4.0f);
+	}
+
+	// batched or not, it has to be drawn by its own render()
+	Actor *lBadge = mWorld->createActor<Badge>("Badge",true);
+	lBadge->setTexture(lTextures[0]);
+	lBadge->setRect(100,100,32,32);
+	lBadge->setZOrder(5.0f);
+	mBadge = lBadge->getHandle();
+
+	// the actors hold on to them
+	for(int i=0;i<lNumTextures;i++)
+		lTextures[i]->drop();
+}
+
+void Tiles::_script( int pFrame )
+{
+	// pan a little, the culled set changes every frame
+	mWorld->setViewRect((pFrame % 100) - 50,0,gEnv->mSWidth,gEnv->mSHeight);
+
+	if( pFrame % 50 )
+		return;
+
+	// sorted or not, the same sprites are drawn
+	QVector<Actor *> lDrawn, lOther;
+
+	Badge *lBadge = mWorld->findActor<Badge>(mBadge);
+	const int lRendered = (lBadge)?lBadge->mRendered:0;
+
+	mWorld->render();
+	mWorld->getDrawn(&lDrawn);
+	const int lChanges = mWorld->getStateChanges();
+
+	mWorld->setSorting(!mSorting);
+	mWorld->render();
+	mWorld->getDrawn(&lOther);
+	const int lOtherChanges = mWorld->getStateChanges();
+	mWorld->setSorting(mSorting);
+
+	SCENARIO_CHECK( lBadge && lBadge->mRendered == lRendered + 2 );
+
+	// all of the floor regrouped
+	const int lSorted = (mSorting)?lChanges:lOtherChanges;
+	const int lUnsorted = (mSorting)?lOtherChanges:lChanges;
+
+	SCENARIO_CHECK( lSorted * 10 < lUnsorted );
+
+	// and the blended ones in the same order
+	QVector<Actor *> lBlended, lOtherBlended;
+
+	for(int i=0;i<lDrawn.size();i++)
+	{
+		if( lDrawn[i]->getBlending() == Actor::B_SRC_ALPHA )
+			lBlended.push_back(lDrawn[i]);
+	}
+
+	for(int i=0;i<lOther.size();i++)
+	{
+		if( lOther[i]->getBlending() == Actor::B_SRC_ALPHA )
+			lOtherBlended.push_back(lOther[i]);
+	}
+
+	SCENARIO_CHECK( lBlended == lOtherBlended );
+
+	// off the render layers, Z-Orders are never swapped
+	const QVector<Actor *> &lSortedDrawn = (mSorting)?lDrawn:lOther;
+	float lZ = -1.0f;
+
+	for(int i=0;i<lSortedDrawn.size();i++)
+	{
+		if( lSortedDrawn[i]->getRenderLayer() != Actor::R_DEFAULT )
+			continue;
+
+		SCENARIO_CHECK( lSortedDrawn[i]->getZOrder() >= lZ );
+		lZ = lSortedDrawn[i]->getZOrder();
+	}
+
+	qSort(lDrawn.begin(),lDrawn.end());
+	qSort(lOther.begin(),lOther.end());
+
+	SCENARIO_CHECK( !lDrawn.isEmpty() && lDrawn == lOther );
+}
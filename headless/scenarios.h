@@ -0,0 +1,375 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#ifndef SCENARIOS_H
+#define SCENARIOS_H
+
+#include "igame.h"
+#include "world.h"
+#include "chunkstreamer.h"
+#include "scene.h"
+
+namespace Headless {
+
+//! Counts a failed check of a scenario (see Scenario::_check())
+#define SCENARIO_CHECK(pCond) _check((pCond),#pCond,__LINE__)
+
+//! Base of the scripted scenarios
+/*!
+	A scenario is just a game without any assets or input,
+	init() builds the scene and _script() is called every
+	frame before the world is updated.
+
+	Scenarios double as tests, SCENARIO_CHECK() failures
+	make shutdown() return false and the Runner fail.
+*/
+class Scenario : public Interface::IGame
+{
+public:
+	Scenario();
+	virtual ~Scenario();
+
+	virtual bool configure( void );
+
+	virtual bool init(void);
+	virtual bool shutdown(void);
+
+	virtual void render(GL::Canvas *pCanvas=0);
+	virtual void think(GL::Canvas *pCanvas=0);
+
+	virtual bool updateMouse(int pX, int pY, int pButton, t_MouseState pState);
+	virtual bool updateKeys(int pKey, t_KeyState pState);
+
+	virtual GL::World *getWorld( void ) const { return mWorld; }
+
+protected:
+	//! Where an actor is, its body's transform if it has one
+	typedef struct s_transform
+	{
+		float mX;
+		float mY;
+		float mRot;
+
+		bool operator<( const s_transform &pOther ) const;
+	} t_transform;
+
+	typedef QVector<t_transform> TransformArray;
+
+protected:
+	virtual void _build( void ) = 0;
+	virtual void _script( int pFrame );
+
+	//! Reports and counts a failure, gives back pPassed
+	virtual bool _check( bool pPassed, const char *pWhat, int pLine );
+
+	//! Transforms of all actors, sorted by position (order independent)
+	virtual void _getTransforms( TransformArray *pTransforms ) const;
+	virtual bool _compareTransforms( const TransformArray &pA, const TransformArray &pB, float pTolerance ) const;
+
+	//! untextured box or circle actor
+	virtual GL::Actor *_spawn( float pX, float pY, float pW, float pH,
+							   float pDensity, unsigned long pShape = GL::Actor::S_BOX,
+							   int pLayer = 0 );
+
+protected:
+	GL::World *mWorld;
+	int mFrame;
+	int mFailures;
+};
+
+//! Pyramid of boxes settling on the ground
+class Stack : public Scenario
+{
+protected:
+	virtual void _build( void );
+};
+
+//! Balls raining through pegs, retired once they fall off the world
+/*!
+	With pRecycle new balls are revived from the World's
+	recycle bin first (see World::reviveActor()) instead
+	of always being created from scratch, they have to
+	come back where asked and at rest.
+*/
+class Rain : public Scenario
+{
+public:
+	Rain( bool pRecycle ) : mRecycle(pRecycle) {}
+
+protected:
+	virtual void _build( void );
+	virtual void _script( int pFrame );
+
+protected:
+	bool mRecycle;
+};
+
+//! Leaves falling onto a few crates, optionally on their own layer
+/*!
+	With pLayers the leaves and clouds share a "Decor" layer
+	which doesn't collide with itself, they still land on
+	the ground and the crates.
+*/
+class Decor : public Scenario
+{
+public:
+	Decor( bool pLayers ) : mLayers(pLayers) {}
+
+protected:
+	virtual void _build( void );
+	virtual void _script( int pFrame );
+
+protected:
+	bool mLayers;
+};
+
+//! Jointed level torn down and rebuilt every few frames
+/*!
+	Exercises World::removeAll(), which releases all
+	bodies, shapes, joints and contacts in bulk.
+*/
+class Reload : public Scenario
+{
+protected:
+	virtual void _build( void );
+	virtual void _script( int pFrame );
+};
+
+//! Rolls a jointed, resting pile back to a snapshot over and over
+/*!
+	Every 60 frames World::saveState() is taken, 20 frames
+	later the world is restored and has to be right where
+	the snapshot was. With a fixed frame time the next 20
+	frames then have to replay the first ones exactly, which
+	only works if velocities, joints and warm starting
+	impulses came back too.
+
+	A snapshot taken before a body, a joint or an actor was
+	removed and created again (likely in the same memory)
+	has to be refused.
+*/
+class Snapshot : public Scenario
+{
+public:
+	Snapshot() : mLink(0), mLinkNext(0), mBox(0) {}
+
+protected:
+	virtual void _build( void );
+	virtual void _script( int pFrame );
+
+	//! Restoring pState has to fail and change nothing
+	virtual void _checkRefused( const QByteArray &pState );
+
+protected:
+	QByteArray mState;
+
+	TransformArray mSaved;
+	TransformArray mStepped;
+
+	//! Last two links of the chain and one of the boxes
+	GL::t_handle mLink;
+	GL::t_handle mLinkNext;
+	GL::t_handle mBox;
+};
+
+//! Same level as Reload, read back from a scene file
+/*!
+	The first build goes through Reload and is written
+	out with Scene::save(), every rebuild after that is
+	a Scene::load() of the mapped file and has to come
+	back with the same actors, joints and transforms.
+	Actors still queued for removal stay out of the file.
+*/
+class Level : public Reload
+{
+public:
+	Level() : mJoints(0) {}
+
+	virtual bool shutdown( void );
+
+protected:
+	virtual void _build( void );
+
+protected:
+	GL::Scene mScene;
+
+	//! What was saved
+	TransformArray mSaved;
+	int mJoints;
+};
+
+//! Lots of awake bodies tumbling in a box
+/*!
+	With pBatched false the b2World synchronizes
+	the shapes body by body, to compare against
+	the batched pass.
+*/
+class Swarm : public Scenario
+{
+public:
+	Swarm( bool pBatched ) : mBatched(pBatched) {}
+
+protected:
+	virtual void _build( void );
+	virtual void _script( int pFrame );
+
+protected:
+	bool mBatched;
+};
+
+//! Spawns and removes 10k actors per (simulated) second
+/*!
+	Every actor lives for mLifetime frames and is then
+	removed through World::removeActorLater(), so the
+	destroy queue flushes ~170 actors a frame.
+
+	With pPrefab each frame's actors come from a single
+	World::spawn() call instead of one by one, and the
+	prefab's animation frames change before every call.
+*/
+class Churn : public Scenario
+{
+public:
+	Churn( bool pPrefab ) : mLifetime(20), mPrefab(pPrefab), mBall(0) {}
+
+protected:
+	virtual void _build( void );
+	virtual void _script( int pFrame );
+
+protected:
+	int mLifetime;
+
+	//! Actors spawned during each of the last mLifetime frames
+	QVector< QVector<GL::t_handle> > mSpawned;
+
+	bool mPrefab;
+	GL::Prefab *mBall;
+};
+
+//! Big level of mostly non-physical sprites, seen through a panning view
+/*!
+	Only a small part of the 20k sprites overlaps the view
+	rect at any time, some of them move every frame. With
+	pCulling false World::render() walks every actor.
+*/
+class Sprawl : public Scenario
+{
+public:
+	Sprawl( bool pCulling ) : mCulling(pCulling) {}
+
+protected:
+	virtual void _build( void );
+	virtual void _script( int pFrame );
+
+protected:
+	bool mCulling;
+
+	//! The ones which keep moving
+	QVector<GL::t_handle> mMoving;
+};
+
+//! Geared machines, one of them torn down and rebuilt every frame
+/*!
+	A rig uses every joint type, removing its actors
+	takes their joints (and the gears on them) along.
+*/
+class Rigs : public Scenario
+{
+protected:
+	virtual void _build( void );
+	virtual void _script( int pFrame );
+
+	virtual void _buildRig( int pIndex );
+
+protected:
+	//! Actors of each rig
+	QVector< QVector<GL::t_handle> > mRigs;
+};
+
+//! Level 40 screens wide, streamed in chunks around a panning camera
+/*!
+	Everything is built up front and handed to a
+	ChunkStreamer, which writes all but the chunks
+	around the camera out on the first frame. Not a
+	single actor may get lost on the way, not even to
+	chunk files left behind by an earlier run.
+*/
+class Stream : public Scenario
+{
+public:
+	Stream() : mStreamer(0), mStreamed(0) {}
+
+	virtual bool configure( void );
+	virtual bool shutdown( void );
+
+protected:
+	virtual void _build( void );
+	virtual void _script( int pFrame );
+
+protected:
+	GL::ChunkStreamer *mStreamer;
+	//! Actors handed to the streamer
+	int mStreamed;
+};
+
+//! Opaque tiles of a few interleaved textures under some blended sprites
+/*!
+	Neighbouring tiles never share a texture, so in
+	draw order every tile breaks the batch. With
+	pSorting World::render() regroups the tiles by
+	texture, the blended sprites keep their order.
+	The tiles are regrouped whether they share a Z-Order
+	or a render layer, a few opaque backdrops under them
+	keep their Z-Orders. Every 50 frames both ways are
+	drawn and compared. A badge with its own render()
+	on top must not be batched.
+*/
+class Tiles : public Scenario
+{
+public:
+	Tiles( bool pSorting ) : mSorting(pSorting), mBadge(0) {}
+
+protected:
+	virtual void _build( void );
+	virtual void _script( int pFrame );
+
+protected:
+	bool mSorting;
+	GL::t_handle mBadge;
+};
+
+/* Headless */ }
+
+#endif // SCENARIOS_H
@@ -39,6 +39,7 @@
 namespace GL
 {
 	class Canvas;
+	class World;
 }
 
 namespace Interface {
@@ -76,6 +77,9 @@ public:
 
 	virtual bool updateMouse(int pX, int pY, int pButton, t_MouseState pState) = 0;
 	virtual bool updateKeys(int pKey, t_KeyState pState) = 0;
+
+	//! The world being simulated (0 if there isn't one)
+	virtual GL::World *getWorld( void ) const { return 0; }
 };
 
 }
@@ -0,0 +1,159 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include "names.h"
+
+using namespace GL;
+
+NameTable::NameTable() : mSerial(0)
+{
+	// id 0 is no name
+	mStrings.push_back(QString());
+}
+
+NameTable::~NameTable()
+{
+}
+
+t_name NameTable::intern( const QString &pString )
+{
+	if( pString.isEmpty() )
+		return 0;
+
+	QHash<QString, quint32>::const_iterator lIt = mIds.find(pString);
+
+	if( lIt != mIds.end() )
+		return (t_name)lIt.value() << 32;
+
+	const quint32 lId = mStrings.size();
+
+	mStrings.push_back(pString);
+	mIds.insert(pString,lId);
+
+	//! "Leaf_12" spelled out, unique() must not hand out 12 again
+	_reserveSerial(pString);
+
+	return (t_name)lId << 32;
+}
+
+t_name NameTable::unique( t_name pName )
+{
+	// never 0, wraps after 4 billion spawns
+	quint32 lSerial;
+
+	do
+	{
+		lSerial = (quint32)(mSerial.fetchAndAddRelaxed(1) + 1);
+	}
+	while( !lSerial );
+
+	return (pName & ~(t_name)0xFFFFFFFF) | lSerial;
+}
+
+void NameTable::_reserveSerial( const QString &pString )
+{
+	const int lSplit = pString.lastIndexOf(QChar('_'));
+
+	if( lSplit <= 0 )
+		return;
+
+	bool lOk = false;
+	const quint32 lSerial = pString.mid(lSplit+1).toUInt(&lOk);
+
+	// only the way toString() would spell it
+	if( !lOk || !lSerial || pString.mid(lSplit+1) != QString::number(lSerial) )
+		return;
+
+	int lCurrent;
+
+	do
+	{
+		lCurrent = mSerial;
+
+		if( (quint32)lCurrent >= lSerial )
+			return;
+	}
+	while( !mSerial.testAndSetOrdered(lCurrent,(int)lSerial) );
+}
+
+t_name NameTable::find( const QString &pString ) const
+{
+	QHash<QString, quint32>::const_iterator lIt = mIds.find(pString);
+
+	if( lIt == mIds.end() )
+		return 0;
+
+	return (t_name)lIt.value() << 32;
+}
+
+t_name NameTable::findUnique( const QString &pString ) const
+{
+	const int lSplit = pString.lastIndexOf(QChar('_'));
+
+	if( lSplit <= 0 )
+		return 0;
+
+	bool lOk = false;
+	const quint32 lSerial = pString.mid(lSplit+1).toUInt(&lOk);
+
+	if( !lOk || !lSerial )
+		return 0;
+
+	const t_name lBase = find(pString.left(lSplit));
+
+	if( !lBase )
+		return 0;
+
+	return lBase | lSerial;
+}
+
+QString NameTable::toString( t_name pName ) const
+{
+	const quint32 lSerial = getSerial(pName);
+
+	if( !lSerial )
+		return getBase(pName);
+
+	return getBase(pName) + "_" + QString::number(lSerial);
+}
+
+const QString &NameTable::getBase( t_name pName ) const
+{
+	const quint32 lId = (quint32)(pName >> 32);
+
+	Q_ASSERT( (int)lId < mStrings.size() );
+
+	return mStrings[lId];
+}
@@ -0,0 +1,105 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#ifndef NAMES_H
+#define NAMES_H
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/QHash>
+#include <QtCore/QAtomicInt>
+
+namespace GL {
+
+//! Interned actor / joint name
+/*!
+	Base string id in the high and a serial number in
+	the low 32 bits, "Leaf" with serial 12 reads "Leaf_12".
+	Serial 0 is the plain base string, 0 is no name at all.
+*/
+typedef quint64 t_name;
+
+//! Process wide table of interned names
+/*!
+	Every base string is stored once, unique names only
+	differ in their serial, so handing one out is an
+	atomic increment and the string is only built when
+	someone asks for it (see toString()).
+
+	Interning is GUI thread only, unique() is thread safe.
+*/
+class NameTable
+{
+public:
+	NameTable();
+	virtual ~NameTable();
+
+	//! Name of pString, added to the table if new
+	virtual t_name intern( const QString &pString );
+	//! Same base as pName with a never used serial
+	virtual t_name unique( t_name pName );
+
+	//! Name pString is known as, 0 if it was never interned
+	virtual t_name find( const QString &pString ) const;
+	//! Same, reading "Base_Serial" as a unique name
+	virtual t_name findUnique( const QString &pString ) const;
+
+	virtual QString toString( t_name pName ) const;
+	virtual const QString &getBase( t_name pName ) const;
+
+	static quint32 getSerial( t_name pName ) { return (quint32)(pName & 0xFFFFFFFF); }
+	//! Serial 0 of the same base, "Leaf_12" becomes "Leaf"
+	static t_name getBaseName( t_name pName ) { return pName & ~(t_name)0xFFFFFFFF; }
+
+	static NameTable &getInstance( void )
+	{
+		static NameTable staticNameTable;
+		return staticNameTable;
+	}
+
+protected:
+	//! Skip the serial of a "Base_Serial" string (see intern())
+	virtual void _reserveSerial( const QString &pString );
+
+protected:
+	QHash<QString, quint32> mIds;
+	QVector<QString> mStrings;
+
+	QAtomicInt mSerial;
+};
+
+/*GL*/ }
+
+#endif // NAMES_H
@@ -0,0 +1,183 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include "physicsthread.h"
+
+#include <QtCore/QDebug>
+
+using namespace GL;
+
+PhysicsThread::PhysicsThread(b2World *pWorld, ContactBuffer *pContacts) : mWorld(pWorld),
+																		  mContacts(pContacts),
+																		  mSteps(0),
+																		  mTimeStep(0.0f),
+																		  mIters(0),
+																		  mTransforms(0),
+																		  mQuit(false)
+{
+	Q_ASSERT( pWorld != 0 );
+	Q_ASSERT( pContacts != 0 );
+
+	mProfile.SetZero();
+
+	start();
+	qDebug() << "Success: [PhysicsThread] started";
+}
+
+PhysicsThread::~PhysicsThread()
+{
+	stop();
+}
+
+void PhysicsThread::step(int pSteps, float pTimeStep, int pIters, TransformArray *pTransforms)
+{
+	Q_ASSERT( pSteps > 0 );
+
+	// one batch at a time
+	sync();
+
+	mMutex.lock();
+
+	mSteps = pSteps;
+	mTimeStep = pTimeStep;
+	mIters = pIters;
+	mTransforms = pTransforms;
+
+	mStart.wakeOne();
+	mMutex.unlock();
+}
+
+void PhysicsThread::sync(void)
+{
+	mMutex.lock();
+
+	while( mSteps )
+		mDone.wait(&mMutex);
+
+	mMutex.unlock();
+}
+
+bool PhysicsThread::isBusy(void)
+{
+	mMutex.lock();
+	bool lBusy = (mSteps != 0);
+	mMutex.unlock();
+
+	return lBusy;
+}
+
+void PhysicsThread::stop(void)
+{
+	if( !isRunning() )
+		return;
+
+	sync();
+
+	mMutex.lock();
+	mQuit = true;
+	mStart.wakeOne();
+	mMutex.unlock();
+
+	wait();
+	qDebug() << "Success: [PhysicsThread] stopped";
+}
+
+void PhysicsThread::run(void)
+{
+	mMutex.lock();
+
+	forever
+	{
+		while( !mSteps && !mQuit )
+			mStart.wait(&mMutex);
+
+		if( mQuit )
+			break;
+
+		int lSteps = mSteps;
+		mMutex.unlock();
+
+		mProfile.SetZero();
+
+		for(int i=0;i<lSteps;i++)
+		{
+			//! keep the state before the last step for interpolation
+			if( i == lSteps-1 )
+				_storeTransforms();
+
+			mWorld->Step(mTimeStep,mIters);
+			mContacts->endStep();
+			mProfile.Accumulate(mWorld->GetProfile());
+		}
+
+		mMutex.lock();
+		mSteps = 0;
+		mDone.wakeAll();
+	}
+
+	mMutex.unlock();
+}
+
+void PhysicsThread::_storeTransforms(void)
+{
+	if( !mTransforms )
+		return;
+
+	// same as World::_storeTransforms(), only bodies which moved
+	b2Body **lBodies = mWorld->GetMovedBodies();
+	const int lCount = mWorld->GetMovedBodyCount();
+
+	mTransforms->reserve(lCount);
+
+	for(int i=0;i<lCount;i++)
+	{
+		BodyTransform lTransform;
+		lTransform.mActor = static_cast<Actor *>(lBodies[i]->GetUserData());
+		lTransform.mBody = lBodies[i];
+
+		if( !lTransform.mActor )
+			continue;
+
+		b2Vec2 lPos = lBodies[i]->GetPosition();
+
+		lTransform.mPos[0] = W2S_(lPos.x);
+		lTransform.mPos[1] = W2S_(lPos.y);
+		lTransform.mRot = R2D(lBodies[i]->GetAngle());
+
+		mTransforms->push_back(lTransform);
+	}
+
+	mWorld->ClearMovedBodies();
+}
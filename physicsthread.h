@@ -0,0 +1,122 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#ifndef PHYSICSTHREAD_H
+#define PHYSICSTHREAD_H
+
+#include <QtCore/QThread>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QVector>
+
+#include "Box2D/Box2D.h"
+
+#include "types.h"
+#include "defines.h"
+#include "contactbuffer.h"
+
+namespace GL {
+
+class Actor;
+
+//! Body transform captured by the worker thread
+/*!
+	This is the back buffer of the pipelined mode, the
+	worker writes it while the actors (front buffer) are
+	being rendered, then it's copied over on sync().
+*/
+struct BodyTransform
+{
+	Actor *mActor;
+	b2Body *mBody;
+
+	t_point mPos; // screen space
+	float mRot;
+};
+
+typedef QVector<BodyTransform> TransformArray;
+
+//! Steps a b2World on a worker thread
+/*!
+	The thread stays around and sleeps between frames, step()
+	hands it a batch of fixed steps and returns right away, sync()
+	waits until the batch is done.
+
+	Nothing else is allowed to touch the b2World in between.
+*/
+class PhysicsThread : public QThread
+{
+public:
+	PhysicsThread(b2World *pWorld, ContactBuffer *pContacts);
+	virtual ~PhysicsThread();
+
+	//! Start a batch of steps (returns immediately)
+	virtual void step(int pSteps, float pTimeStep, int pIters, TransformArray *pTransforms);
+	//! Wait for the current batch to finish
+	virtual void sync(void);
+
+	virtual bool isBusy(void);
+
+	//! Box2D profile summed over the last batch (call sync() first)
+	virtual const b2Profile &getProfile(void) const { return mProfile; }
+
+	//! Finish the current batch and shut down the thread
+	virtual void stop(void);
+
+protected:
+	virtual void run(void);
+	virtual void _storeTransforms(void);
+
+protected:
+	b2World *mWorld;
+	ContactBuffer *mContacts;
+
+	QMutex mMutex;
+	QWaitCondition mStart;
+	QWaitCondition mDone;
+
+	// current batch
+	int mSteps;
+	float mTimeStep;
+	int mIters;
+	TransformArray *mTransforms;
+	b2Profile mProfile;
+
+	bool mQuit;
+};
+
+/* GL */ }
+
+#endif // PHYSICSTHREAD_H
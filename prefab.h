@@ -0,0 +1,114 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#ifndef PREFAB_H
+#define PREFAB_H
+
+#include <QtCore/QString>
+
+#include "Box2D/Box2D.h"
+
+#include "actor.h"
+#include "names.h"
+
+namespace GL {
+
+//! Archetype for spawning many alike actors
+/*!
+	Set it up through getActor() like any other actor
+	(texture, rect, flags, blending, physics ...), that
+	one is never registered with the World. World::spawn()
+	copies it into every new actor, the texture is looked
+	up once, the texture coordinates are shared and the
+	shape definition is built once per spawn() call.
+
+	It may be changed between spawn() calls, actors spawned
+	already keep what they got (frames included).
+
+	Prefabs are owned by the World (see World::createPrefab()).
+*/
+class Prefab
+{
+public:
+	//! Makes the actors, see World::createPrefab()
+	typedef Actor *(*t_factory)(const QString &pName, World *pWorld);
+
+	Prefab(const QString &pName, World *pWorld, t_factory pFactory);
+	virtual ~Prefab();
+
+	//! A new (unconfigured) actor of the prefab's class
+	virtual Actor *create( World *pWorld, const QString &pName ) const { return mFactory(pName,pWorld); }
+
+	template <typename T>
+	static Actor *factory( const QString &pName, World *pWorld )
+	{
+		return new T(pName,pWorld);
+	}
+
+	//! The template actor, configure this one
+	virtual Actor *getActor( void ) const { return mActor; }
+
+	//! Whatever spawned actors get a body or not
+	virtual void setPhysical( bool pPhysical ) { mPhysical = pPhysical; }
+	virtual bool isPhysical( void ) const { return mPhysical; }
+
+	virtual const QString &getName( void ) const { return mName; }
+	virtual t_name getNameId( void ) const { return mNameId; }
+
+	//! Resolve the shape definition (World::spawn() calls it)
+	virtual void build( void );
+
+	//! Shape definition spawned bodies are created from
+	virtual const b2ShapeDef *getShapeDef( void ) const { return mShape; }
+	//! How far the sprite may stick out of the shape (culling)
+	virtual float getCullMargin( void ) const { return mCullMargin; }
+
+protected:
+	QString mName;
+	t_name mNameId;
+
+	t_factory mFactory;
+	Actor *mActor;
+	bool mPhysical;
+
+	//! Valid after build(), points to mActor's or mCircleDef
+	const b2ShapeDef *mShape;
+	b2CircleDef mCircleDef;
+	float mCullMargin;
+};
+
+/* GL */ }
+
+#endif // PREFAB_H
@@ -0,0 +1,930 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include "scene.h"
+#include "world.h"
+#include "texture.h"
+#include "texturemanager.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QTime>
+
+#include <string.h>
+
+using namespace GL;
+
+#define SCENE_MAGIC 0x53443250 // "P2DS"
+#define SCENE_VERSION 1
+
+static TextureManager *gTex = &TextureManager::getInstance();
+
+Scene::Scene() : mData(0),
+				 mSize(0)
+{
+}
+
+Scene::~Scene()
+{
+	close();
+}
+
+bool Scene::save( World *pWorld, const QString &pFileName )
+{
+	Q_ASSERT( pWorld != 0 );
+
+	// bodies have to hold still
+	pWorld->sync();
+
+	mStringIndex.clear();
+	mStrings.clear();
+	mTextureIndex.clear();
+	mTextureNames.clear();
+	mVertices.clear();
+	mActorIndex.clear();
+	mJointIndex.clear();
+
+	// 1. collision layers
+	QVector<t_layer> lLayers(pWorld->mLayers.size());
+
+	for(int i=0;i<lLayers.size();i++)
+	{
+		lLayers[i].mName = _addString(pWorld->mLayers[i]);
+		lLayers[i].mMask = pWorld->mLayerMasks[i];
+	}
+
+	// 2. prefabs, actors refer to them by index
+	QVector<t_prefab> lPrefabs;
+	QHash<const Prefab *, qint32> lPrefabIndex;
+
+	World::PrefabIndex::const_iterator lPIt	= pWorld->mPrefabs.constBegin();
+	World::PrefabIndex::const_iterator lPEnd	= pWorld->mPrefabs.constEnd();
+
+	for( ; lPIt != lPEnd; ++lPIt )
+	{
+		const Prefab *lPrefab = lPIt.value();
+
+		t_prefab lRecord;
+		lRecord.mName = _addString(lPrefab->getName());
+		lRecord.mPhysical = lPrefab->isPhysical();
+		_saveActor(lPrefab->getActor(),&lRecord.mActor);
+
+		lPrefabIndex.insert(lPrefab,lPrefabs.size());
+		lPrefabs.push_back(lRecord);
+	}
+
+	// 3. actors in draw order, only registered ones are in there
+	//    (load() creates them in this order, equal Z-Orders keep it)
+	QVector<t_actor> lActors(pWorld->mDrawOrder.size());
+
+	World::DrawOrder::const_iterator lIt	= pWorld->mDrawOrder.constBegin();
+	World::DrawOrder::const_iterator lEnd	= pWorld->mDrawOrder.constEnd();
+
+	for( int i=0 ; lIt != lEnd; ++lIt, ++i )
+	{
+		const Actor *lActor = lIt.value();
+		t_actor &lRecord = lActors[i];
+
+		_saveActor(lActor,&lRecord);
+
+		// only while it still looks like one
+		const Prefab *lPrefab = lActor->mPrefab;
+
+		if( lPrefab && lPrefabIndex.contains(lPrefab) &&
+			lPrefab->getActor()->mTexture == lActor->mTexture &&
+			lPrefab->getActor()->mNumFrames == lActor->mNumFrames )
+			lRecord.mPrefab = lPrefabIndex.value(lPrefab);
+
+		mActorIndex.insert(lActor,i);
+	}
+
+	// 4. joints, gears after the joints they couple
+	QVector<t_joint> lJoints;
+
+	for(int lPass=0;lPass<2;lPass++)
+	{
+		for(int i=0;i<pWorld->mJointSlots.size();i++)
+		{
+			ActorJoint *lJoint = pWorld->mJointSlots[i].mJoint;
+
+			if( !lJoint || !lJoint->getJoint() )
+				continue;
+
+			if( (lJoint->getJoint()->GetType() == e_gearJoint) != (lPass == 1) )
+				continue;
+
+			t_joint lRecord;
+
+			if( !_saveJoint(lJoint,&lRecord) )
+				continue;
+
+			mJointIndex.insert(lJoint,lJoints.size());
+			lJoints.push_back(lRecord);
+		}
+	}
+
+	// 5. put it all together
+	QByteArray lData;
+	t_header lHeader;
+
+	memset(&lHeader,0,sizeof(t_header));
+	lHeader.mMagic = SCENE_MAGIC;
+	lHeader.mVersion = SCENE_VERSION;
+
+	lData.resize(sizeof(t_header));
+
+	// string offsets first, the characters right behind them
+	QVector<quint32> lOffsets(mStrings.size());
+	quint32 lOffset = ((lData.size() + 7) & ~7) + lOffsets.size() * sizeof(quint32);
+
+	for(int i=0;i<mStrings.size();i++)
+	{
+		lOffsets[i] = lOffset;
+		lOffset += mStrings[i].size() + 1;
+	}
+
+	_append(&lData,&lHeader,SC_STRINGS,lOffsets.constData(),lOffsets.size());
+
+	for(int i=0;i<mStrings.size();i++)
+	{
+		lData.append(mStrings[i]);
+		lData.append('\0');
+	}
+
+	_append(&lData,&lHeader,SC_TEXTURES,mTextureNames.constData(),mTextureNames.size());
+	_append(&lData,&lHeader,SC_LAYERS,lLayers.constData(),lLayers.size());
+	_append(&lData,&lHeader,SC_PREFABS,lPrefabs.constData(),lPrefabs.size());
+	_append(&lData,&lHeader,SC_ACTORS,lActors.constData(),lActors.size());
+	_append(&lData,&lHeader,SC_VERTICES,mVertices.constData(),mVertices.size() / sizeof(t_point));
+	_append(&lData,&lHeader,SC_JOINTS,lJoints.constData(),lJoints.size());
+
+	lHeader.mSize = lData.size();
+	memcpy(lData.data(),&lHeader,sizeof(t_header));
+
+	QFile lFile(pFileName);
+
+	if( !lFile.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+		lFile.write(lData) != lData.size() )
+	{
+		qDebug() << "Error: [Scene] Failed to write " << pFileName;
+		return false;
+	}
+
+	qDebug() << "Success: [Scene] " << lActors.size() << " actors, " << lJoints.size()
+			 << " joints written to " << pFileName;
+
+	return true;
+}
+
+bool Scene::open( const QString &pFileName )
+{
+	close();
+
+	mFile.setFileName(pFileName);
+
+	if( !mFile.open(QIODevice::ReadOnly) )
+	{
+		qDebug() << "Error: [Scene] Failed to open " << pFileName;
+		return false;
+	}
+
+	mSize = mFile.size();
+	mData = mFile.map(0,mSize);
+
+	// not every file can be mapped, fall back to a copy
+	if( !mData )
+	{
+		mBuffer = mFile.readAll();
+		mData = (const uchar *)mBuffer.constData();
+	}
+
+	const t_header *lHeader = (const t_header *)mData;
+	bool lValid = (mSize >= (qint64)sizeof(t_header) &&
+				   lHeader->mMagic == SCENE_MAGIC &&
+				   lHeader->mVersion == SCENE_VERSION &&
+				   lHeader->mSize == mSize);
+
+	for(int i=0;lValid && i<SC_COUNT;i++)
+	{
+		const t_section &lSection = lHeader->mSections[i];
+		const quint32 lRecordSize = _getRecordSize(i);
+
+		lValid = (!lSection.mCount ||
+				  (lSection.mRecordSize == lRecordSize && !(lSection.mOffset & 3) &&
+				   (qint64)lSection.mOffset + (qint64)lSection.mCount * lRecordSize <= mSize));
+	}
+
+	if( !lValid )
+	{
+		qDebug() << "Error: [Scene] Bad scene file " << pFileName;
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void Scene::close( void )
+{
+	if( mData && mBuffer.isEmpty() )
+		mFile.unmap(const_cast<uchar *>(mData));
+
+	mFile.close();
+	mBuffer.clear();
+
+	mData = 0;
+	mSize = 0;
+}
+
+int Scene::getActorCount( void ) const
+{
+	return _getCount(SC_ACTORS);
+}
+
+int Scene::getJointCount( void ) const
+{
+	return _getCount(SC_JOINTS);
+}
+
+int Scene::load( World *pWorld )
+{
+	Q_ASSERT( pWorld != 0 );
+
+	if( !mData )
+	{
+		qDebug() << "Error: [Scene] Nothing to load";
+		return 0;
+	}
+
+	QTime lClock;
+	lClock.start();
+
+	// bodies are created right away
+	pWorld->sync();
+
+	// 1. textures, looked up (and uploaded) once
+	const quint32 *lTextures = (const quint32 *)_getSection(SC_TEXTURES);
+	mTextures.resize(_getCount(SC_TEXTURES));
+
+	for(int i=0;i<mTextures.size();i++)
+		mTextures[i] = gTex->find(_getString(lTextures[i]));
+
+	// 2. collision layers, by name
+	const t_layer *lLayers = (const t_layer *)_getSection(SC_LAYERS);
+	mLayers.resize(_getCount(SC_LAYERS));
+
+	for(int i=0;i<mLayers.size();i++)
+		mLayers[i] = qMax(pWorld->addLayer(_getString(lLayers[i].mName)),0);
+
+	for(int i=0;i<mLayers.size();i++)
+		for(int j=i;j<mLayers.size();j++)
+			pWorld->setLayersCollide(mLayers[i],mLayers[j],(lLayers[i].mMask & BIT(j)) != 0);
+
+	// 3. prefabs
+	const t_prefab *lPrefabs = (const t_prefab *)_getSection(SC_PREFABS);
+	mPrefabs.resize(_getCount(SC_PREFABS));
+
+	for(int i=0;i<mPrefabs.size();i++)
+		mPrefabs[i] = _loadPrefab(pWorld,&lPrefabs[i]);
+
+	// 4. actors, the broadphase takes all their shapes at once
+	const t_actor *lActors = (const t_actor *)_getSection(SC_ACTORS);
+	const int lCount = _getCount(SC_ACTORS);
+
+	mActors.fill(0,lCount);
+
+	b2World *lWorld = pWorld->getPhysicsWorld();
+	lWorld->BeginCreate();
+
+	float lMaxZ = pWorld->mZOrder;
+	t_point *lPositions = new t_point[lCount];
+
+	for(int i=0;i<lCount;)
+	{
+		const t_actor &lRecord = lActors[i];
+		const bool lSpawned = (lRecord.mPrefab >= 0 && lRecord.mPrefab < mPrefabs.size());
+
+		if( !lSpawned )
+		{
+			mActors[i] = pWorld->createActor<Actor>(_getString(lRecord.mName),lRecord.mSerial != 0);
+			_loadActor(mActors[i],&lRecord,true);
+
+			lMaxZ = qMax(lMaxZ,lRecord.mZ);
+			++i;
+
+			continue;
+		}
+
+		// the whole run of actors of this prefab in one go
+		int lRun = i + 1;
+
+		while( lRun < lCount && lActors[lRun].mPrefab == lRecord.mPrefab )
+			++lRun;
+
+		for(int j=i;j<lRun;j++)
+			memcpy(lPositions[j],lActors[j].mPos,sizeof(t_point));
+
+		pWorld->spawn(mPrefabs[lRecord.mPrefab],lPositions + i,lRun - i,mActors.data() + i);
+
+		for(int j=i;j<lRun;j++)
+		{
+			_loadSpawned(mActors[j],&lActors[j]);
+			lMaxZ = qMax(lMaxZ,lActors[j].mZ);
+		}
+
+		i = lRun;
+	}
+
+	delete [] lPositions;
+
+	lWorld->EndCreate();
+
+	// a physical body can only be turned with its proxy in place
+	for(int i=0;i<lCount;i++)
+	{
+		Actor *lActor = mActors[i];
+		const float lRot = lActors[i].mRot;
+
+		if( !lActor->mBody || lActor->mHot->mRot == lRot )
+			continue;
+
+		lActor->mBody->SetXForm(lActor->mBody->GetPosition(),D2R(lRot));
+		lActor->_setRotation(lRot);
+		lActor->storeTransform();
+	}
+
+	// new actors go on top of the scene
+	if( lMaxZ >= pWorld->mZOrder )
+		pWorld->mZOrder = lMaxZ + 0.000001;
+
+	// 5. joints
+	const t_joint *lJoints = (const t_joint *)_getSection(SC_JOINTS);
+	mJoints.fill(0,_getCount(SC_JOINTS));
+
+	for(int i=0;i<mJoints.size();i++)
+		mJoints[i] = _loadJoint(pWorld,&lJoints[i]);
+
+	qDebug() << "Success: [Scene] " << lCount << " actors, " << mJoints.size()
+			 << " joints loaded in " << lClock.elapsed() << "ms";
+
+	mTextures.clear();
+	mPrefabs.clear();
+	mActors.clear();
+	mJoints.clear();
+
+	return lCount;
+}
+
+const void *Scene::_getSection( int pSection ) const
+{
+	Q_ASSERT( pSection >= 0 && pSection < SC_COUNT );
+
+	if( !mData )
+		return 0;
+
+	const t_section &lSection = ((const t_header *)mData)->mSections[pSection];
+
+	return (lSection.mCount)?(mData + lSection.mOffset):0;
+}
+
+quint32 Scene::_getRecordSize( int pSection )
+{
+	switch( pSection )
+	{
+		case SC_STRINGS:	return sizeof(quint32); // offsets
+		case SC_TEXTURES:	return sizeof(quint32); // strings
+		case SC_LAYERS:		return sizeof(t_layer);
+		case SC_PREFABS:	return sizeof(t_prefab);
+		case SC_ACTORS:		return sizeof(t_actor);
+		case SC_VERTICES:	return sizeof(t_point);
+		case SC_JOINTS:		return sizeof(t_joint);
+	}
+
+	return 0;
+}
+
+int Scene::_getCount( int pSection ) const
+{
+	Q_ASSERT( pSection >= 0 && pSection < SC_COUNT );
+
+	if( !mData )
+		return 0;
+
+	return ((const t_header *)mData)->mSections[pSection].mCount;
+}
+
+QString Scene::_getString( quint32 pIndex ) const
+{
+	if( pIndex >= (quint32)_getCount(SC_STRINGS) )
+		return QString();
+
+	const quint32 lOffset = ((const quint32 *)_getSection(SC_STRINGS))[pIndex];
+
+	if( lOffset >= mSize )
+		return QString();
+
+	// zero terminated, unless the file is broken
+	const char *lString = (const char *)mData + lOffset;
+	const char *lEnd = (const char *)memchr(lString,0,mSize - lOffset);
+
+	return (lEnd)?QString::fromLatin1(lString,lEnd - lString):QString();
+}
+
+quint32 Scene::_addString( const QString &pString )
+{
+	QHash<QString, quint32>::const_iterator lIt = mStringIndex.constFind(pString);
+
+	if( lIt != mStringIndex.constEnd() )
+		return lIt.value();
+
+	const quint32 lIndex = mStrings.size();
+
+	mStrings.push_back(pString.toLatin1());
+	mStringIndex.insert(pString,lIndex);
+
+	return lIndex;
+}
+
+qint32 Scene::_addTexture( Texture *pTexture )
+{
+	if( !pTexture )
+		return -1;
+
+	QHash<Texture *, qint32>::const_iterator lIt = mTextureIndex.constFind(pTexture);
+
+	if( lIt != mTextureIndex.constEnd() )
+		return lIt.value();
+
+	const qint32 lIndex = mTextureNames.size();
+
+	mTextureNames.push_back(_addString(pTexture->getName()));
+	mTextureIndex.insert(pTexture,lIndex);
+
+	return lIndex;
+}
+
+void Scene::_saveActor( const Actor *pActor, t_actor *pRecord )
+{
+	Q_ASSERT( pActor != 0 );
+	Q_ASSERT( pRecord != 0 );
+
+	// the body knows best, see Actor::saveRecord()
+	Actor::t_record lRecord;
+	pActor->saveRecord(&lRecord);
+
+	memset(pRecord,0,sizeof(t_actor));
+
+	pRecord->mName = _addString(NameTable::getInstance().getBase(pActor->mNameId));
+	pRecord->mSerial = NameTable::getSerial(pActor->mNameId);
+	pRecord->mTexture = _addTexture(pActor->mTexture);
+	pRecord->mPrefab = -1;
+
+	memcpy(pRecord->mPos,lRecord.mPos,sizeof(t_point));
+	memcpy(pRecord->mSize,lRecord.mSize,sizeof(t_point));
+	memcpy(pRecord->mOffsets,lRecord.mOffsets,sizeof(t_point));
+	pRecord->mRot = lRecord.mRot;
+	pRecord->mZ = lRecord.mZ;
+
+	pRecord->mFlags = lRecord.mFlags;
+	pRecord->mLayer = lRecord.mLayer;
+	pRecord->mBlending = lRecord.mBlending;
+	memcpy(pRecord->mColor,lRecord.mColor,sizeof(t_vec4));
+
+	memcpy(pRecord->mFrameRect,lRecord.mFrameRect,sizeof(t_rect));
+	pRecord->mNumFrames = lRecord.mNumFrames;
+	pRecord->mFrame = lRecord.mFrame;
+	pRecord->mFrameLoop = lRecord.mFrameLoop;
+	pRecord->mAnimate = lRecord.mAnimate;
+	pRecord->mPhysical = lRecord.mPhysical;
+
+	pRecord->mDensity = lRecord.mDensity;
+	pRecord->mFriction = lRecord.mFriction;
+	pRecord->mRestitution = lRecord.mRestitution;
+	memcpy(pRecord->mVelocity,lRecord.mVelocity,sizeof(t_point));
+	pRecord->mSpin = lRecord.mSpin;
+
+	if( lRecord.mNumVertices > 0 )
+	{
+		const int lSize = mVertices.size();
+
+		pRecord->mFirstVertex = lSize / sizeof(t_point);
+		pRecord->mNumVertices = lRecord.mNumVertices;
+
+		mVertices.resize(lSize + lRecord.mNumVertices * sizeof(t_point));
+		memcpy(mVertices.data() + lSize,lRecord.mVertices,lRecord.mNumVertices * sizeof(t_point));
+	}
+}
+
+bool Scene::_saveJoint( ActorJoint *pJoint, t_joint *pRecord )
+{
+	Q_ASSERT( pJoint != 0 );
+	Q_ASSERT( pRecord != 0 );
+
+	memset(pRecord,0,sizeof(t_joint));
+
+	b2Joint *lJoint = pJoint->getJoint();
+	Actor *lGround = pJoint->mWorld->getGroundActor();
+
+	// both ends have to be in the scene (or the ground)
+	const Actor *lActors[2] = { pJoint->getActor1(), pJoint->getActor2() };
+	qint32 *lIndices[2] = { &pRecord->mActor1, &pRecord->mActor2 };
+
+	for(int i=0;i<2;i++)
+	{
+		if( !lActors[i] || lActors[i] == lGround )
+			*lIndices[i] = -1;
+		else if( mActorIndex.contains(lActors[i]) )
+			*lIndices[i] = mActorIndex.value(lActors[i]);
+		else
+			return false;
+	}
+
+	pRecord->mName = _addString(NameTable::getInstance().getBase(pJoint->mNameId));
+	pRecord->mSerial = NameTable::getSerial(pJoint->mNameId);
+	pRecord->mType = lJoint->GetType();
+	pRecord->mCollide = lJoint->GetCollideConnected();
+	pRecord->mJoint1 = -1;
+	pRecord->mJoint2 = -1;
+
+	switch( lJoint->GetType() )
+	{
+		case e_revoluteJoint:
+		{
+			const b2RevoluteJoint *lRevolute = static_cast<const b2RevoluteJoint *>(lJoint);
+
+			pRecord->mAnchor1[0] = lRevolute->m_localAnchor1.x;
+			pRecord->mAnchor1[1] = lRevolute->m_localAnchor1.y;
+			pRecord->mAnchor2[0] = lRevolute->m_localAnchor2.x;
+			pRecord->mAnchor2[1] = lRevolute->m_localAnchor2.y;
+
+			pRecord->mReference = lRevolute->m_referenceAngle;
+			pRecord->mEnableLimit = lRevolute->m_enableLimit;
+			pRecord->mLower = lRevolute->m_lowerAngle;
+			pRecord->mUpper = lRevolute->m_upperAngle;
+			pRecord->mEnableMotor = lRevolute->m_enableMotor;
+			pRecord->mMotorSpeed = lRevolute->m_motorSpeed;
+			pRecord->mMaxMotor = lRevolute->m_maxMotorTorque;
+			break;
+		}
+
+		case e_prismaticJoint:
+		{
+			const b2PrismaticJoint *lPrismatic = static_cast<const b2PrismaticJoint *>(lJoint);
+
+			pRecord->mAnchor1[0] = lPrismatic->m_localAnchor1.x;
+			pRecord->mAnchor1[1] = lPrismatic->m_localAnchor1.y;
+			pRecord->mAnchor2[0] = lPrismatic->m_localAnchor2.x;
+			pRecord->mAnchor2[1] = lPrismatic->m_localAnchor2.y;
+			pRecord->mAxis[0] = lPrismatic->m_localXAxis1.x;
+			pRecord->mAxis[1] = lPrismatic->m_localXAxis1.y;
+
+			pRecord->mReference = lPrismatic->m_refAngle;
+			pRecord->mEnableLimit = lPrismatic->m_enableLimit;
+			pRecord->mLower = lPrismatic->m_lowerTranslation;
+			pRecord->mUpper = lPrismatic->m_upperTranslation;
+			pRecord->mEnableMotor = lPrismatic->m_enableMotor;
+			pRecord->mMotorSpeed = lPrismatic->m_motorSpeed;
+			pRecord->mMaxMotor = lPrismatic->m_maxMotorForce;
+			break;
+		}
+
+		case e_distanceJoint:
+		{
+			const b2DistanceJoint *lDistance = static_cast<const b2DistanceJoint *>(lJoint);
+
+			pRecord->mAnchor1[0] = lDistance->m_localAnchor1.x;
+			pRecord->mAnchor1[1] = lDistance->m_localAnchor1.y;
+			pRecord->mAnchor2[0] = lDistance->m_localAnchor2.x;
+			pRecord->mAnchor2[1] = lDistance->m_localAnchor2.y;
+
+			pRecord->mLength = lDistance->m_length;
+			pRecord->mFrequency = lDistance->m_frequencyHz;
+			pRecord->mDamping = lDistance->m_dampingRatio;
+			break;
+		}
+
+		case e_pulleyJoint:
+		{
+			const b2PulleyJoint *lPulley = static_cast<const b2PulleyJoint *>(lJoint);
+
+			pRecord->mAnchor1[0] = lPulley->m_localAnchor1.x;
+			pRecord->mAnchor1[1] = lPulley->m_localAnchor1.y;
+			pRecord->mAnchor2[0] = lPulley->m_localAnchor2.x;
+			pRecord->mAnchor2[1] = lPulley->m_localAnchor2.y;
+			pRecord->mGround1[0] = lPulley->m_groundAnchor1.x;
+			pRecord->mGround1[1] = lPulley->m_groundAnchor1.y;
+			pRecord->mGround2[0] = lPulley->m_groundAnchor2.x;
+			pRecord->mGround2[1] = lPulley->m_groundAnchor2.y;
+
+			pRecord->mLength = lPulley->m_constant;
+			pRecord->mRatio = lPulley->m_ratio;
+			pRecord->mMaxLength1 = lPulley->m_maxLength1;
+			pRecord->mMaxLength2 = lPulley->m_maxLength2;
+			break;
+		}
+
+		case e_gearJoint:
+		{
+			const GearJoint *lGear = static_cast<const GearJoint *>(pJoint);
+
+			if( !mJointIndex.contains(lGear->getJoint1()) || !mJointIndex.contains(lGear->getJoint2()) )
+				return false;
+
+			pRecord->mJoint1 = mJointIndex.value(lGear->getJoint1());
+			pRecord->mJoint2 = mJointIndex.value(lGear->getJoint2());
+			pRecord->mRatio = static_cast<const b2GearJoint *>(lJoint)->m_ratio;
+			break;
+		}
+
+		default: // mouse joints are never ActorJoints
+			return false;
+	}
+
+	return true;
+}
+
+void Scene::_append( QByteArray *pData, t_header *pHeader, int pSection,
+					 const void *pRecords, int pCount )
+{
+	Q_ASSERT( pData != 0 );
+	Q_ASSERT( pHeader != 0 );
+
+	// every section starts 8 byte aligned
+	while( pData->size() & 7 )
+		pData->append('\0');
+
+	t_section &lSection = pHeader->mSections[pSection];
+	const int lRecordSize = _getRecordSize(pSection);
+
+	lSection.mOffset = pData->size();
+	lSection.mCount = pCount;
+	lSection.mRecordSize = lRecordSize;
+
+	if( !pCount )
+		return;
+
+	pData->resize(lSection.mOffset + pCount * lRecordSize);
+	memcpy(pData->data() + lSection.mOffset,pRecords,pCount * lRecordSize);
+}
+
+Prefab *Scene::_loadPrefab( World *pWorld, const t_prefab *pRecord )
+{
+	Q_ASSERT( pWorld != 0 );
+	Q_ASSERT( pRecord != 0 );
+
+	const QString lName = _getString(pRecord->mName);
+
+	if( lName.isEmpty() )
+		return 0;
+
+	// the game's own (maybe of a custom class) wins
+	Prefab *lPrefab = pWorld->findPrefab(lName);
+
+	if( lPrefab )
+		return lPrefab;
+
+	lPrefab = pWorld->createPrefab<Actor>(lName);
+	lPrefab->setPhysical(pRecord->mPhysical != 0);
+
+	_loadActor(lPrefab->getActor(),&pRecord->mActor,false);
+
+	return lPrefab;
+}
+
+void Scene::_loadActor( Actor *pActor, const t_actor *pRecord, bool pBody )
+{
+	Q_ASSERT( pActor != 0 );
+	Q_ASSERT( pRecord != 0 );
+
+	// same order as Actor::loadRecord(), without the texture lookup
+	if( pRecord->mTexture >= 0 && pRecord->mTexture < mTextures.size() )
+		pActor->setTexture(mTextures[pRecord->mTexture]);
+
+	pActor->setFrameSize(pRecord->mFrameRect[0],pRecord->mFrameRect[1],pRecord->mFrameRect[2],pRecord->mFrameRect[3]);
+
+	if( pActor->mTexture && pRecord->mNumFrames > 1 )
+		pActor->setNumFrames(pRecord->mNumFrames);
+
+	pActor->setFrame(pRecord->mFrame);
+	pActor->setAnimate(pRecord->mAnimate,pRecord->mFrameLoop);
+
+	pActor->setFlags(pRecord->mFlags);
+	pActor->setOffsets(pRecord->mOffsets[0],pRecord->mOffsets[1]);
+	pActor->setRect(pRecord->mPos[0],pRecord->mPos[1],pRecord->mSize[0],pRecord->mSize[1]);
+	pActor->setRotation(pRecord->mRot);
+	pActor->setZOrder(pRecord->mZ);
+
+	if( pRecord->mLayer >= 0 && pRecord->mLayer < mLayers.size() )
+		pActor->setLayer(mLayers[pRecord->mLayer]);
+
+	pActor->setBlending((Actor::t_blend)pRecord->mBlending);
+	memcpy(pActor->mColor,pRecord->mColor,sizeof(t_vec4));
+
+	pActor->setDensity(pRecord->mDensity);
+	pActor->setFriction(pRecord->mFriction);
+	pActor->setRestituition(pRecord->mRestitution);
+
+	if( pRecord->mNumVertices > 0 &&
+		pRecord->mFirstVertex + pRecord->mNumVertices <= (quint32)_getCount(SC_VERTICES) )
+	{
+		const t_point *lVertices = (const t_point *)_getSection(SC_VERTICES);
+		pActor->setShape(lVertices + pRecord->mFirstVertex,qMin(pRecord->mNumVertices,(quint32)b2_maxPolygonVertices));
+	}
+
+	if( !pBody || !pRecord->mPhysical )
+		return;
+
+	pActor->applyPhysX();
+
+	pActor->mBody->SetLinearVelocity(b2Vec2(pRecord->mVelocity[0],pRecord->mVelocity[1]));
+	pActor->mBody->SetAngularVelocity(pRecord->mSpin);
+}
+
+void Scene::_loadSpawned( Actor *pActor, const t_actor *pRecord )
+{
+	Q_ASSERT( pActor != 0 );
+	Q_ASSERT( pRecord != 0 );
+
+	NameTable &lNames = NameTable::getInstance();
+
+	// spawn() hands out "Prefab_N", plain or other names are kept
+	const QString lName = _getString(pRecord->mName);
+
+	if( !pRecord->mSerial || lNames.getBase(pActor->mNameId) != lName )
+	{
+		t_name lId = lNames.intern(lName);
+		pActor->_setNameId((pRecord->mSerial)?lNames.unique(lId):lId);
+	}
+
+	if( pActor->getFlags() != pRecord->mFlags )
+		pActor->setFlags(pRecord->mFlags);
+
+	pActor->setFrame(pRecord->mFrame);
+	pActor->setAnimate(pRecord->mAnimate,pRecord->mFrameLoop);
+	memcpy(pActor->mColor,pRecord->mColor,sizeof(t_vec4));
+
+	if( pActor->mZ != pRecord->mZ )
+		pActor->setZOrder(pRecord->mZ);
+
+	if( pRecord->mLayer >= 0 && pRecord->mLayer < mLayers.size() )
+		pActor->setLayer(mLayers[pRecord->mLayer]);
+
+	// bodies are turned once they're in the broadphase (see load())
+	if( !pActor->mBody )
+	{
+		pActor->setRotation(pRecord->mRot);
+		return;
+	}
+
+	pActor->mBody->SetLinearVelocity(b2Vec2(pRecord->mVelocity[0],pRecord->mVelocity[1]));
+	pActor->mBody->SetAngularVelocity(pRecord->mSpin);
+}
+
+ActorJoint *Scene::_loadJoint( World *pWorld, const t_joint *pRecord )
+{
+	Q_ASSERT( pWorld != 0 );
+	Q_ASSERT( pRecord != 0 );
+
+	const QString lName = _getString(pRecord->mName);
+	const bool lUnique = (pRecord->mSerial != 0);
+
+	if( lName.isEmpty() )
+		return 0;
+
+	if( pRecord->mType == e_gearJoint )
+	{
+		const int lCount = mJoints.size();
+
+		if( pRecord->mJoint1 < 0 || pRecord->mJoint1 >= lCount || !mJoints[pRecord->mJoint1] ||
+			pRecord->mJoint2 < 0 || pRecord->mJoint2 >= lCount || !mJoints[pRecord->mJoint2] )
+			return 0;
+
+		return pWorld->createJoint<GearJoint>(lName,lUnique)->init(mJoints[pRecord->mJoint1],mJoints[pRecord->mJoint2],pRecord->mRatio);
+	}
+
+	Actor *lActor1 = _getActor(pWorld,pRecord->mActor1);
+	Actor *lActor2 = _getActor(pWorld,pRecord->mActor2);
+
+	if( !lActor1 || !lActor1->getBody() || !lActor2 || !lActor2->getBody() )
+		return 0;
+
+	const b2Vec2 lAnchor1(pRecord->mAnchor1[0],pRecord->mAnchor1[1]);
+	const b2Vec2 lAnchor2(pRecord->mAnchor2[0],pRecord->mAnchor2[1]);
+
+	b2RevoluteJointDef lRevolute;
+	b2PrismaticJointDef lPrismatic;
+	b2DistanceJointDef lDistance;
+	b2PulleyJointDef lPulley;
+
+	b2JointDef *lDef = 0;
+	ActorJoint *lJoint = 0;
+
+	switch( pRecord->mType )
+	{
+		case e_revoluteJoint:
+			lRevolute.localAnchor1 = lAnchor1;
+			lRevolute.localAnchor2 = lAnchor2;
+			lRevolute.referenceAngle = pRecord->mReference;
+			lRevolute.enableLimit = pRecord->mEnableLimit;
+			lRevolute.lowerAngle = pRecord->mLower;
+			lRevolute.upperAngle = pRecord->mUpper;
+			lRevolute.enableMotor = pRecord->mEnableMotor;
+			lRevolute.motorSpeed = pRecord->mMotorSpeed;
+			lRevolute.maxMotorTorque = pRecord->mMaxMotor;
+
+			lDef = &lRevolute;
+			lJoint = pWorld->createJoint<ActorJoint>(lName,lUnique);
+			break;
+
+		case e_prismaticJoint:
+			lPrismatic.localAnchor1 = lAnchor1;
+			lPrismatic.localAnchor2 = lAnchor2;
+			lPrismatic.localAxis1.Set(pRecord->mAxis[0],pRecord->mAxis[1]);
+			lPrismatic.referenceAngle = pRecord->mReference;
+			lPrismatic.enableLimit = pRecord->mEnableLimit;
+			lPrismatic.lowerTranslation = pRecord->mLower;
+			lPrismatic.upperTranslation = pRecord->mUpper;
+			lPrismatic.enableMotor = pRecord->mEnableMotor;
+			lPrismatic.motorSpeed = pRecord->mMotorSpeed;
+			lPrismatic.maxMotorForce = pRecord->mMaxMotor;
+
+			lDef = &lPrismatic;
+			lJoint = pWorld->createJoint<PrismaticJoint>(lName,lUnique);
+			break;
+
+		case e_distanceJoint:
+			lDistance.localAnchor1 = lAnchor1;
+			lDistance.localAnchor2 = lAnchor2;
+			lDistance.length = pRecord->mLength;
+			lDistance.frequencyHz = pRecord->mFrequency;
+			lDistance.dampingRatio = pRecord->mDamping;
+
+			lDef = &lDistance;
+			lJoint = pWorld->createJoint<DistanceJoint>(lName,lUnique);
+			break;
+
+		case e_pulleyJoint:
+			lPulley.localAnchor1 = lAnchor1;
+			lPulley.localAnchor2 = lAnchor2;
+			lPulley.groundAnchor1.Set(pRecord->mGround1[0],pRecord->mGround1[1]);
+			lPulley.groundAnchor2.Set(pRecord->mGround2[0],pRecord->mGround2[1]);
+			// the whole constant goes into length1
+			lPulley.length1 = pRecord->mLength;
+			lPulley.length2 = 0.0f;
+			lPulley.maxLength1 = pRecord->mMaxLength1;
+			lPulley.maxLength2 = pRecord->mMaxLength2;
+			lPulley.ratio = pRecord->mRatio;
+
+			lDef = &lPulley;
+			lJoint = pWorld->createJoint<PulleyJoint>(lName,lUnique);
+			break;
+
+		default:
+			return 0;
+	}
+
+	lDef->body1 = lActor1->getBody();
+	lDef->body2 = lActor2->getBody();
+	lDef->collideConnected = (pRecord->mCollide != 0);
+
+	return lJoint->_create(lDef,lActor1,lActor2);
+}
+
+Actor *Scene::_getActor( World *pWorld, qint32 pIndex ) const
+{
+	if( pIndex < 0 )
+		return pWorld->getGroundActor();
+
+	return (pIndex < mActors.size())?mActors[pIndex]:0;
+}
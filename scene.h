@@ -0,0 +1,259 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <QtCore/QString>
+#include <QtCore/QFile>
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+#include <QtCore/QHash>
+
+#include "defines.h"
+#include "types.h"
+
+namespace GL {
+
+class World;
+class Actor;
+class ActorJoint;
+class Prefab;
+class Texture;
+
+//! Binary level file
+/*!
+	A header followed by flat sections of fixed size records:
+	a string table (names, textures, layers), the textures and
+	collision layers used, prefabs, actors, a pool of custom
+	shape vertices and joints. Records refer to each other by
+	index, so the file is used right where it's mapped.
+
+	save() captures everything in a World, open() maps a file
+	and load() creates its contents in a World: every texture
+	is resolved once, runs of actors spawned from the same
+	prefab go through a single World::spawn() and the bodies
+	of the whole level enter the broadphase as one batch.
+
+	Prefabs are looked up by name in the target World first,
+	so games can register their own (custom actor classes),
+	missing ones are created as plain Actor prefabs.
+*/
+class Scene
+{
+public:
+	Scene();
+	virtual ~Scene();
+
+	//! Write every actor, joint, layer and prefab of pWorld
+	virtual bool save( World *pWorld, const QString &pFileName );
+
+	//! Map a file written by save()
+	virtual bool open( const QString &pFileName );
+	virtual void close( void );
+	virtual bool isOpen( void ) const { return (mData); }
+
+	//! Create the scene in pWorld, returns the number of actors created
+	virtual int load( World *pWorld );
+
+	virtual int getActorCount( void ) const;
+	virtual int getJointCount( void ) const;
+
+protected:
+	enum
+	{
+		SC_STRINGS = 0,
+		SC_TEXTURES,
+		SC_LAYERS,
+		SC_PREFABS,
+		SC_ACTORS,
+		SC_VERTICES,
+		SC_JOINTS,
+		SC_COUNT
+	};
+
+	typedef struct s_section
+	{
+		quint32 mOffset;	// from the start of the file
+		quint32 mCount;
+		quint32 mRecordSize;
+	} t_section;
+
+	typedef struct s_header
+	{
+		quint32 mMagic;
+		quint32 mVersion;
+		quint32 mSize;
+
+		t_section mSections[SC_COUNT];
+	} t_header;
+
+	typedef struct s_layer
+	{
+		quint32 mName;		// string
+		quint32 mMask;		// layers it collides with
+	} t_layer;
+
+	//! Same as Actor::t_record, with indices instead of strings
+	typedef struct s_actor
+	{
+		quint32 mName;		// string, the base name
+		quint32 mSerial;	// 0 for a plain name
+		qint32 mTexture;	// -1 for none
+		qint32 mPrefab;		// -1 for none
+
+		t_point mPos;		// top left, screen space
+		t_point mSize;
+		t_point mOffsets;
+		float mRot;
+		float mZ;
+
+		quint32 mFlags;
+		qint32 mLayer;
+		qint32 mBlending;
+		t_vec4 mColor;
+
+		t_rect mFrameRect;
+		qint16 mNumFrames;
+		qint16 mFrame;
+		quint8 mFrameLoop;
+		quint8 mAnimate;
+		quint8 mPhysical;
+		quint8 mPad;
+
+		float mDensity;
+		float mFriction;
+		float mRestitution;
+		t_point mVelocity;	// world space
+		float mSpin;
+
+		//! S_CUSTOM shapes, a range of the vertex pool (screen space)
+		quint32 mFirstVertex;
+		quint32 mNumVertices;
+	} t_actor;
+
+	typedef struct s_prefab
+	{
+		quint32 mName;		// string
+		quint32 mPhysical;
+		t_actor mActor;		// the template actor
+	} t_prefab;
+
+	//! Any joint type, anchors are local to the bodies (world space units)
+	typedef struct s_joint
+	{
+		quint32 mName;		// string, the base name
+		quint32 mSerial;
+		qint32 mType;		// b2JointType
+		qint32 mActor1;		// -1 for the ground
+		qint32 mActor2;
+		qint32 mJoint1;		// gears only
+		qint32 mJoint2;
+
+		quint8 mCollide;
+		quint8 mEnableLimit;
+		quint8 mEnableMotor;
+		quint8 mPad;
+
+		t_point mAnchor1;
+		t_point mAnchor2;
+		t_point mGround1;	// pulleys only
+		t_point mGround2;
+		t_point mAxis;		// prismatic only
+
+		float mReference;	// reference angle
+		float mLower;		// limits
+		float mUpper;
+		float mMotorSpeed;
+		float mMaxMotor;	// torque or force
+
+		float mLength;		// distance, or pulley length constant
+		float mFrequency;
+		float mDamping;
+		float mRatio;
+		float mMaxLength1;
+		float mMaxLength2;
+	} t_joint;
+
+	static quint32 _getRecordSize( int pSection );
+
+	//! Records of a section, 0 if it's empty
+	virtual const void *_getSection( int pSection ) const;
+	virtual int _getCount( int pSection ) const;
+	virtual QString _getString( quint32 pIndex ) const;
+
+	// saving
+	virtual quint32 _addString( const QString &pString );
+	virtual qint32 _addTexture( Texture *pTexture );
+	virtual void _saveActor( const Actor *pActor, t_actor *pRecord );
+	virtual bool _saveJoint( ActorJoint *pJoint, t_joint *pRecord );
+	virtual void _append( QByteArray *pData, t_header *pHeader, int pSection,
+						  const void *pRecords, int pCount );
+
+	// loading
+	virtual Prefab *_loadPrefab( World *pWorld, const t_prefab *pRecord );
+	//! Set up a new actor from pRecord (its body too with pBody)
+	virtual void _loadActor( Actor *pActor, const t_actor *pRecord, bool pBody );
+	//! Whatever a spawned actor doesn't share with its prefab
+	virtual void _loadSpawned( Actor *pActor, const t_actor *pRecord );
+	virtual ActorJoint *_loadJoint( World *pWorld, const t_joint *pRecord );
+	virtual Actor *_getActor( World *pWorld, qint32 pIndex ) const;
+
+protected:
+	//! The mapped file (or a copy of it, if it couldn't be mapped)
+	QFile mFile;
+	const uchar *mData;
+	qint64 mSize;
+	QByteArray mBuffer;
+
+	//! Scratch tables, only valid during save() / load()
+	QHash<QString, quint32> mStringIndex;
+	QVector<QByteArray> mStrings;
+	QHash<Texture *, qint32> mTextureIndex;
+	QVector<quint32> mTextureNames;
+	QByteArray mVertices;
+	QHash<const Actor *, qint32> mActorIndex;
+	QHash<const ActorJoint *, qint32> mJointIndex;
+
+	QVector<Texture *> mTextures;
+	QVector<int> mLayers;
+	QVector<Prefab *> mPrefabs;
+	QVector<Actor *> mActors;
+	QVector<ActorJoint *> mJoints;
+};
+
+/*GL*/ }
+
+#endif // SCENE_H
@@ -0,0 +1,223 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#include "spritebatch.h"
+#include "texture.h"
+#include "actor.h"
+
+#include <string.h>
+
+using namespace GL;
+
+SpriteBatch::SpriteBatch() : mPositions(0),
+							 mTexCoords(0),
+							 mColors(0),
+							 mIndices(0),
+							 mCount(0),
+							 mDrawCalls(0),
+							 mStateChanges(0),
+							 mSprites(0)
+{
+	mPositions = new b2Vec2[WORLD_BATCH_SIZE * 4];
+	mTexCoords = new t_point[WORLD_BATCH_SIZE * 4];
+	mColors = new GLubyte[WORLD_BATCH_SIZE * 4 * 4];
+	mIndices = new GLushort[WORLD_BATCH_SIZE * 6];
+
+	// same triangles as the fan Actor::_draw() uses
+	for(int i=0;i<WORLD_BATCH_SIZE;i++)
+	{
+		GLushort *lIndex = mIndices + i * 6;
+		const GLushort lFirst = (GLushort)(i * 4);
+
+		lIndex[0] = lFirst;
+		lIndex[1] = lFirst + 1;
+		lIndex[2] = lFirst + 2;
+		lIndex[3] = lFirst;
+		lIndex[4] = lFirst + 2;
+		lIndex[5] = lFirst + 3;
+	}
+}
+
+SpriteBatch::~SpriteBatch()
+{
+	delete [] mPositions;
+	delete [] mTexCoords;
+	delete [] mColors;
+	delete [] mIndices;
+}
+
+void SpriteBatch::begin( void )
+{
+	mRuns.clear();
+	mCount = 0;
+
+	mDrawCalls = 0;
+	mStateChanges = 0;
+	mSprites = 0;
+}
+
+void SpriteBatch::add( Texture *pTexture, int pBlending,
+					   const t_point *pCorners, const t_point *pTexCoords,
+					   const t_vec4 pColor, const t_point pPos, float pRot )
+{
+	if( mCount == WORLD_BATCH_SIZE )
+		flush();
+
+	// a new run whenever the state changes
+	if( mRuns.isEmpty() || mRuns.back().mTexture != pTexture || mRuns.back().mBlending != pBlending )
+	{
+		t_run lRun = { pTexture, pBlending, mCount, 0 };
+		mRuns.push_back(lRun);
+	}
+
+	mRuns.back().mCount++;
+
+	const int lFirst = mCount * 4;
+
+	// all four corners in one go
+	b2XForm lXForm;
+	lXForm.position.Set(pPos[0],pPos[1]);
+	lXForm.R.Set(D2R(pRot));
+
+	b2MulBatch(lXForm,reinterpret_cast<const b2Vec2 *>(pCorners),mPositions + lFirst,4);
+
+	memcpy(mTexCoords + lFirst,pTexCoords,4 * sizeof(t_point));
+
+	GLubyte lColor[4];
+	for(int i=0;i<4;i++)
+		lColor[i] = (GLubyte)(qBound(0.0f,pColor[i],1.0f) * 255.0f + 0.5f);
+
+	GLubyte *lColors = mColors + lFirst * 4;
+	for(int i=0;i<4;i++)
+		memcpy(lColors + i * 4,lColor,sizeof(lColor));
+
+	mCount++;
+	mSprites++;
+}
+
+void SpriteBatch::flush( void )
+{
+	if( !mCount )
+		return;
+
+#ifndef WORLD_HEADLESS
+#ifndef WORLD_VERTEX_ARRAYS
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+#endif
+	glEnableClientState(GL_COLOR_ARRAY);
+
+	glVertexPointer(2,GL_FLOAT,0,mPositions);
+	glTexCoordPointer(2,GL_FLOAT,0,mTexCoords);
+	glColorPointer(4,GL_UNSIGNED_BYTE,0,mColors);
+#endif
+
+	// what the per actor path leaves behind
+	Texture *lTexture = 0;
+	int lBlending = Actor::B_NONE;
+
+	QVector<t_run>::const_iterator lIt	= mRuns.constBegin();
+	QVector<t_run>::const_iterator lEnd	= mRuns.constEnd();
+
+	for( ; lIt!= lEnd; ++lIt )
+	{
+		if( lIt->mTexture != lTexture )
+		{
+#ifndef WORLD_HEADLESS
+			if( lIt->mTexture )
+				lIt->mTexture->enable();
+			else
+				lTexture->disable();
+#endif
+			lTexture = lIt->mTexture;
+			mStateChanges++;
+		}
+
+		if( lIt->mBlending != lBlending )
+		{
+#ifndef WORLD_HEADLESS
+			if( lIt->mBlending == Actor::B_NONE )
+				glDisable(GL_BLEND);
+			else
+			{
+				if( lBlending == Actor::B_NONE )
+					glEnable(GL_BLEND);
+
+				glBlendFunc(GL_SRC_ALPHA,lIt->mBlending);
+			}
+#endif
+			lBlending = lIt->mBlending;
+			mStateChanges++;
+		}
+
+#ifndef WORLD_HEADLESS
+		glDrawElements(GL_TRIANGLES,lIt->mCount * 6,GL_UNSIGNED_SHORT,mIndices + lIt->mFirst * 6);
+#endif
+		mDrawCalls++;
+	}
+
+	// back to the defaults
+	if( lTexture )
+	{
+#ifndef WORLD_HEADLESS
+		lTexture->disable();
+#endif
+		mStateChanges++;
+	}
+
+	if( lBlending != Actor::B_NONE )
+	{
+#ifndef WORLD_HEADLESS
+		glDisable(GL_BLEND);
+#endif
+		mStateChanges++;
+	}
+
+#ifndef WORLD_HEADLESS
+	glDisableClientState(GL_COLOR_ARRAY);
+#ifndef WORLD_VERTEX_ARRAYS
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+#endif
+#endif
+
+	mRuns.clear();
+	mCount = 0;
+}
+
+void SpriteBatch::end( void )
+{
+	flush();
+}
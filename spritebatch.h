@@ -0,0 +1,128 @@
+/*=============================================================================
+ Copyright (c) 2009, Mihail Szabolcs
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or
+ without modification, are permitted provided that the following
+ conditions are met:
+
+   * 	Redistributions of source code must retain the above copyright
+		notice, this list of conditions and the following disclaimer.
+
+   * 	Redistributions in binary form must reproduce the above copyright
+		notice, this list of conditions and the following disclaimer in
+		the documentation and/or other materials provided with the
+		distribution.
+
+   * 	Neither the name of the Prototype2D nor the names of its contributors
+		may be used to endorse or promote products derived from this
+		software without specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+	OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+	THE POSSIBILITY OF SUCH DAMAGE.
+
+	This file is part of Prototype2D.
+
+==============================================================================*/
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include <QtOpenGL>
+#include <QtCore/QVector>
+
+#include "Box2D/Box2D.h"
+
+#include "types.h"
+#include "defines.h"
+
+namespace GL {
+
+class Texture;
+
+//! Draws sprites in as few GL calls as possible
+/*!
+	add() transforms the corners of a sprite on the CPU
+	(b2MulBatch(), SSE when available) and appends them
+	to one streaming vertex array, consecutive sprites with
+	the same texture and blending share a run. flush()
+	draws every run with a single indexed glDrawElements()
+	and only touches the GL state between runs.
+
+	At most WORLD_BATCH_SIZE sprites are queued, a full
+	batch is flushed on its own.
+*/
+class SpriteBatch
+{
+public:
+	SpriteBatch();
+	virtual ~SpriteBatch();
+
+	//! Start a new frame (resets the counters)
+	virtual void begin( void );
+
+	//! Queue a sprite
+	/*!
+		pCorners and pTexCoords are in GL_TRIANGLE_FAN order
+		(see Actor::_draw()), pPos and pRot (degrees) place
+		them like glTranslatef() and glRotatef() would. A 0
+		texture draws untextured, pBlending is an Actor::t_blend.
+	*/
+	virtual void add( Texture *pTexture, int pBlending,
+					  const t_point *pCorners, const t_point *pTexCoords,
+					  const t_vec4 pColor, const t_point pPos, float pRot );
+
+	//! Draw everything queued so far
+	/*!
+		Leaves the GL state the way the per actor path
+		expects it (no texture bound, blending off), so
+		both can be mixed, at the price of a flush.
+	*/
+	virtual void flush( void );
+	//! Same as flush(), at the end of a frame
+	virtual void end( void );
+
+	//! Draw calls and sprites since begin()
+	virtual int getDrawCalls( void ) const { return mDrawCalls; }
+	virtual int getSpriteCount( void ) const { return mSprites; }
+	//! Texture binds and blend changes since begin()
+	virtual int getStateChanges( void ) const { return mStateChanges; }
+
+protected:
+	//! Sprites sharing texture and blending
+	typedef struct s_run
+	{
+		Texture *mTexture;
+		int mBlending;
+		int mFirst; // first sprite
+		int mCount;
+	} t_run;
+
+	QVector<t_run> mRuns;
+
+	//! Vertex streams, 4 vertices per sprite
+	b2Vec2 *mPositions;
+	t_point *mTexCoords;
+	GLubyte *mColors;
+
+	//! Two triangles per sprite, built once
+	GLushort *mIndices;
+
+	int mCount;
+
+	int mDrawCalls;
+	int mStateChanges;
+	int mSprites;
+};
+
+/* GL */ }
+
+#endif // SPRITEBATCH_H
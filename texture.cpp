@@ -41,8 +41,12 @@
 
 using namespace GL;
 
-Texture::Texture(const QString &pFileName,bool pClamp) : mRefCount(1), mTextureId(0)
+Texture::Texture(const QString &pFileName,bool pClamp) : mRefCount(1), mWidth(0), mHeight(0), mTextureId(0)
 {
+	// textures are created on the GUI thread only
+	static unsigned int staticSerial = 0;
+	mSerial = ++staticSerial;
+
 	if( !pFileName.isEmpty() )
 		load( pFileName, pClamp );
 }
@@ -65,6 +69,14 @@ bool Texture::load( const QString &pFileName, bool pClamp )
 	if( !lImage.load( pFileName ) )
 		return false;
 
+#ifdef WORLD_HEADLESS // no GL context, just keep the size
+	mWidth = lImage.width();
+	mHeight = lImage.height();
+
+	Q_UNUSED(pClamp);
+	return true;
+#endif
+
 	lImageTemp = QGLWidget::convertToGLFormat( lImage );
 
 	// TODO: add support for resize to POWER of TWO
@@ -101,12 +113,16 @@ bool Texture::load( const QString &pFileName, bool pClamp )
 
 void Texture::enable( void )
 {
+#ifndef WORLD_HEADLESS
 	glBindTexture(GL_TEXTURE_2D,mTextureId);
+#endif
 }
 
 void Texture::disable( void )
 {
+#ifndef WORLD_HEADLESS
 	glBindTexture(GL_TEXTURE_2D,0);
+#endif
 }
 
 Texture *Texture::grab( void )
@@ -60,6 +60,11 @@ public:
 	virtual int getHeight( void ) const;
 
 	virtual unsigned int getTextureId( void ) const;
+	//! Process unique, never 0 (there's no GL id without a context)
+	virtual unsigned int getSerial( void ) const { return mSerial; }
+
+	//! Name it was found by (see TextureManager::find())
+	virtual const QString &getName( void ) const { return mName; }
 
 protected:
 	friend class TextureManager;
@@ -72,6 +77,9 @@ protected:
 	int mHeight;
 
 	unsigned int mTextureId;
+	unsigned int mSerial;
+
+	QString mName;
 };
 
 /* GL */ }
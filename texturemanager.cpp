@@ -87,7 +87,8 @@ Texture *TextureManager::find( const QString &pFileName )
 	}
 	else
 	{
-		// insert it
+		// insert it, remember the name it was asked for
+		lTexture->mName = pFileName;
 		mTextures.insert(lFileName,lTexture);
 		return lTexture;
 	}
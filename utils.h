@@ -36,9 +36,45 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <QtCore/qglobal.h>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
 namespace Utils
 {
+	//! High resolution time stamp in microseconds
+	/*!
+		Only the difference between two calls has a
+		meaning, use it to time (small) chunks of code.
+	*/
+	inline qint64 getTicks( void )
+	{
+#ifdef Q_OS_WIN
+		static LARGE_INTEGER lFreq = { { 0, 0 } };
+		LARGE_INTEGER lNow;
+
+		if( !lFreq.QuadPart )
+			QueryPerformanceFrequency(&lFreq);
+
+		QueryPerformanceCounter(&lNow);
+		return (qint64)((lNow.QuadPart * 1000000) / lFreq.QuadPart);
+#else
+		struct timeval lNow;
+		gettimeofday(&lNow,0);
+
+		return (qint64)lNow.tv_sec * 1000000 + lNow.tv_usec;
+#endif
+	}
 
+	//! Milliseconds elapsed since a getTicks() time stamp
+	inline float getElapsed( qint64 pTicks )
+	{
+		return (float)((getTicks() - pTicks) / 1000.0);
+	}
 }
 
 #endif // UTILS_H
@@ -36,37 +36,120 @@
 #include "world.h"
 #include "actor.h"
 #include "env.h"
+#include "utils.h"
+#include "texture.h"
 
 #include <QtAlgorithms>
 #include <QtCore/QDebug>
 
+#include <string.h>
+#include <math.h>
+
 using namespace GL;
 using namespace Sys;
 
 static Env *gEnv = &Env::getInstance();
 
-// Sort by Z Order functor to be used with qSort
-struct sortByZOrder
+// Flat layout used by saveState / restoreState
+struct t_stateHeader
 {
-	bool operator()(const Actor *a, const Actor *b)
-	{
-		return (a->getZOrder() < b->getZOrder());
-	}
+	int mSize;
+	int mNumActors;
+	int mPhysXOffset;
+
+	float mAccumulator;
+	float mAlpha;
 };
 
-World::World() : mNumContacts(0),
+// actors by handle, a recycled block might hold another one by now
+struct t_actorState
+{
+	t_handle mHandle;
+	Actor::t_state mState;
+};
+
+// keep every block pointer aligned
+static int _alignState( int pSize )
+{
+	const int lAlign = sizeof(void *);
+	return (pSize + lAlign - 1) & ~(lAlign - 1);
+}
+
+// culling grid cells covered by a circle
+static void _getCells( const t_point pCenter, float pRadius, int *pRect )
+{
+	pRect[0] = (int)floorf((pCenter[0] - pRadius) / WORLD_CULL_CELL);
+	pRect[1] = (int)floorf((pCenter[1] - pRadius) / WORLD_CULL_CELL);
+	pRect[2] = (int)floorf((pCenter[0] + pRadius) / WORLD_CULL_CELL);
+	pRect[3] = (int)floorf((pCenter[1] + pRadius) / WORLD_CULL_CELL);
+}
+
+static inline quint32 _getCellKey( int pX, int pY )
+{
+	return ((quint32)(pX & 0xFFFF) << 16) | (quint32)(pY & 0xFFFF);
+}
+
+// render queue key, see World::t_renderItem
+static inline quint64 _getRenderKey( quint64 pLayer, int pBlend, const Texture *pTexture, int pDepth )
+{
+	const quint64 lTexture = (pTexture)?pTexture->getSerial():0;
+
+	return ((pLayer & 0xFFFFFF) << 40) | ((quint64)(pBlend & 0xF) << 36) |
+		   ((lTexture & 0xFFFFF) << 16) | (quint64)qMin(pDepth,0xFFFF);
+}
+
+// radius around the drawing position the sprite never leaves
+static inline float _getCullRadius( float pHW, float pHH )
+{
+	return sqrtf(pHW * pHW + pHH * pHH);
+}
+
+World::World() : mContacts(gEnv->mNumContactEvents),
+				 mDrawSeq(0),
+				 mAccumulator(0.0f),
+				 mAlpha(1.0f),
+				 mThread(0),
+				 mPendingSteps(0),
+				 mStepping(false),
+				 mPhysicsTime(0.0f),
+				 mUpdateTime(0.0f),
 				 mZOrder(0.0f),
 				 mWorld(0),
 				 mMouseJoint(0),
 				 mActor(0),
-				 mGround(0)
+				 mGround(0),
+				 mCulling(true),
+				 mDrawn(0),
+				 mBatching(true),
+				 mDrawCalls(0),
+				 mStateChanges(0),
+				 mSorting(true),
+				 mCullStamp(0),
+				 mCullMargin(0.0f)
 {
 	// set default physics simulation params
 	setPhysicsParams(gEnv->mTimeStep,gEnv->mIterations);
 
-	// set default physics bounds
+	// nothing stepped yet
+	mProfile.SetZero();
+
+	// everything collides with everything
+	for(int i=0;i<WORLD_MAX_LAYERS;i++)
+		mLayerMasks[i] = 0xFFFF;
+
+	mLayers.push_back("Default");
+
+	// camera on the middle of the screen (sets the view rect)
+	mZoom = 1.0f;
+	setCamera(gEnv->mSWidth / 2.0f,gEnv->mSHeight / 2.0f);
+	mCullShapes.resize(256);
+
+	// set default physics bounds (the level, at least the screen)
+	const float lW = qMax(gEnv->mSWidth,gEnv->mLevelWidth);
+	const float lH = qMax(gEnv->mSHeight,gEnv->mLevelHeight);
+
 	mWorldAABB.lowerBound.Set(S2W(-100.0f, -100.0f));
-	mWorldAABB.upperBound.Set(S2W(gEnv->mSWidth+100,gEnv->mSHeight+100));
+	mWorldAABB.upperBound.Set(S2W((lW+100),(lH+100)));
 
 	// set default gravity
 	b2Vec2 lGravity(gEnv->mGravity[0],gEnv->mGravity[1]);
@@ -85,61 +168,194 @@ World::World() : mNumContacts(0),
 	// Make sure to store it as User Data
 	mGroundBody->SetUserData(mGround);
 
-	// Alloc initial number of contact points
-	_allocContacts(gEnv->mNumContactPoints);
-
 	// Add Itself as Contact Listener
 	mWorld->SetContactListener(this);
+
+	// Step on a worker thread if requested
+	setPipelined(gEnv->mPipelined);
 }
 
 World::~World()
 {
-	// DeAlloc the number of contact points
-	_deallocContacts();
+	// Stop the physics worker first
+	setPipelined(false);
 
-	removeAll();
+	// b2World frees whatever is left in bulk
+	_releaseAll();
 
 	if( mGround ) /// do we have a ground? FOR SURE!
 	{
 		// don't delete the actual
 		// ground body ... LOL
 		mGround->setBody(0);
-		mGround->setHasJoints(false);
 
 		delete mGround;
 	}
 
+	// after the actors, they may share texture coordinates
+	PrefabIndex::iterator lIt = mPrefabs.begin();
+	PrefabIndex::iterator lEnd = mPrefabs.end();
+
+	for(; lIt != lEnd; ++lIt)
+		delete lIt.value();
+
 	if( mWorld )
 		delete mWorld;
+
+	for(int i=0;i<mHot.size();i++)
+		delete [] mHot[i];
 }
 
 void World::Add(const b2ContactPoint *pPoint)
 {
-	//! queue only a predefined number of contact points
-	if( mNumContacts == gEnv->mNumContactPoints )
+	mContacts.record(ContactEvent::E_BEGIN,pPoint);
+}
+
+void World::Persist(const b2ContactPoint *pPoint)
+{
+	mContacts.record(ContactEvent::E_PERSIST,pPoint);
+}
+
+void World::Remove(const b2ContactPoint *pPoint)
+{
+	mContacts.record(ContactEvent::E_END,pPoint);
+}
+
+void World::Result(const b2ContactResult *pResult)
+{
+	mContacts.record(pResult);
+}
+
+void World::setContactTypes( int pTypes )
+{
+	sync();
+	mContacts.setTypes(pTypes);
+}
+
+void World::setContactFilter( unsigned long pFlags )
+{
+	sync();
+	mContacts.setFilter(pFlags);
+}
+
+int World::addLayer( const QString &pName )
+{
+	Q_ASSERT( !pName.isEmpty() );
+
+	int lLayer = getLayer(pName);
+
+	if( lLayer >= 0 )
+		return lLayer;
+
+	if( mLayers.size() == WORLD_MAX_LAYERS )
+		return -1;
+
+	mLayers.push_back(pName);
+	return mLayers.size()-1;
+}
+
+int World::getLayer( const QString &pName ) const
+{
+	return mLayers.indexOf(pName);
+}
+
+QString World::getLayerName( int pLayer ) const
+{
+	if( pLayer < 0 || pLayer >= mLayers.size() )
+		return QString();
+
+	return mLayers[pLayer];
+}
+
+void World::setLayersCollide( int pLayer1, int pLayer2, bool pCollide )
+{
+	Q_ASSERT( pLayer1 >= 0 && pLayer1 < WORLD_MAX_LAYERS );
+	Q_ASSERT( pLayer2 >= 0 && pLayer2 < WORLD_MAX_LAYERS );
+
+	if( layersCollide(pLayer1,pLayer2) == pCollide )
+		return;
+
+	//! the matrix is symmetric
+	if( pCollide )
+	{
+		mLayerMasks[pLayer1] |= BIT(pLayer2);
+		mLayerMasks[pLayer2] |= BIT(pLayer1);
+	}
+	else
+	{
+		mLayerMasks[pLayer1] &= ~BIT(pLayer2);
+		mLayerMasks[pLayer2] &= ~BIT(pLayer1);
+	}
+
+	//! update everything already simulated on these layers
+	ActorArray::iterator lIt	= mActors.begin();
+	ActorArray::iterator lEnd	= mActors.end();
+
+	for( ; lIt!= lEnd; ++lIt )
+	{
+		Actor *lActor = (*lIt);
+
+		if( lActor->getBody() && (lActor->getLayer() == pLayer1 || lActor->getLayer() == pLayer2) )
+			refilterActor(lActor);
+	}
+}
+
+void World::setLayersCollide( const QString &pLayer1, const QString &pLayer2, bool pCollide )
+{
+	int lLayer1 = addLayer(pLayer1);
+	int lLayer2 = addLayer(pLayer2);
+
+	if( lLayer1 < 0 || lLayer2 < 0 )
+	{
+		qDebug() << "Warning: [World] No room for layers " << pLayer1 << " and " << pLayer2;
 		return;
+	}
+
+	setLayersCollide(lLayer1,lLayer2,pCollide);
+}
+
+bool World::layersCollide( int pLayer1, int pLayer2 ) const
+{
+	Q_ASSERT( pLayer1 >= 0 && pLayer1 < WORLD_MAX_LAYERS );
+	Q_ASSERT( pLayer2 >= 0 && pLayer2 < WORLD_MAX_LAYERS );
+
+	return (mLayerMasks[pLayer1] & BIT(pLayer2));
+}
+
+void World::getLayerFilter( int pLayer, b2FilterData *pFilter ) const
+{
+	Q_ASSERT( pLayer >= 0 && pLayer < WORLD_MAX_LAYERS );
+	Q_ASSERT( pFilter != 0 );
+
+	pFilter->categoryBits = BIT(pLayer);
+	pFilter->maskBits = mLayerMasks[pLayer];
+	pFilter->groupIndex = 0;
+}
+
+void World::refilterActor( Actor *pActor )
+{
+	Q_ASSERT( pActor != 0 );
 
-	// Current
-	ContactPoint *lContact = mContacts[mNumContacts];
+	b2Body *lBody = pActor->getBody();
 
-	// Get Bodies
-	b2Body *lBody1 = pPoint->shape1->GetBody();
-	b2Body *lBody2 = pPoint->shape2->GetBody();
+	if( !lBody )
+		return;
 
-	// Copy Over
-	lContact->mActor1 = static_cast<Actor *>(lBody1->GetUserData());
-	lContact->mActor2 = static_cast<Actor *>(lBody2->GetUserData());
+	sync();
 
-	// Position (convert to Screen Space)
-	lContact->mPos[0] = W2S_(pPoint->position.x);
-	lContact->mPos[1] = W2S_(pPoint->position.y);
+	b2FilterData lFilter;
+	getLayerFilter(pActor->getLayer(),&lFilter);
 
-	// Inc
-	mNumContacts++;
+	for(b2Shape *lShape = lBody->GetShapeList(); lShape; lShape = lShape->GetNext())
+	{
+		lShape->SetFilterData(lFilter);
+		mWorld->Refilter(lShape);
+	}
 }
 
 void World::setGravity( float pX, float pY )
 {
+	sync();
 	mWorld->SetGravity(b2Vec2(pX,pY));
 }
 
@@ -154,13 +370,88 @@ void World::setPhysicsParams( float pTimeStep, int pIters )
 	mIters = pIters;
 }
 
+void World::setPipelined( bool pPipelined )
+{
+	if( pPipelined == isPipelined() )
+		return;
+
+	if( mThread )
+	{
+		sync();
+
+		delete mThread;
+		mThread = 0;
+
+		// give back the steps that never started
+		mAccumulator += mPendingSteps * mTimeStep;
+		mPendingSteps = 0;
+
+		qDebug() << "Success: [World] Stepping physics on the GUI thread";
+		return;
+	}
+
+	mThread = new PhysicsThread(mWorld,&mContacts);
+	qDebug() << "Success: [World] Stepping physics on a worker thread";
+}
+
+void World::sync( void )
+{
+	if( mStepping )
+		_finishStep();
+}
+
 void World::updatePhysics( void )
 {
+	qint64 lTicks = Utils::getTicks();
+	_updatePhysics();
+	mPhysicsTime = Utils::getElapsed(lTicks);
+}
+
+void World::_updatePhysics( void )
+{
+	mProfile.SetZero();
+
+	//! pick up the results of the previous batch
+	if( mThread )
+	{
+		_startStep(); // nothing rendered in between? step now
+		_finishStep();
+	}
+
+	//! accumulate real time, but never more than we can catch up with
+	mAccumulator += _getElapsed();
+
+	const float lMaxTime = mTimeStep * gEnv->mMaxSteps;
+	if( mAccumulator > lMaxTime )
+		mAccumulator = lMaxTime;
+
+	int lSteps = (int)(mAccumulator / mTimeStep);
+
+	if( mThread ) // taken on the worker during the next render()
+	{
+		mPendingSteps = lSteps;
+		mAccumulator -= lSteps * mTimeStep;
+		mAlpha = (gEnv->mInterpolate)?(mAccumulator / mTimeStep):1.0f;
+		return;
+	}
+
 	//! reset all contact points prior stepping
 	_resetContacts();
 
-	//! Step Box2D
-	mWorld->Step(mTimeStep,mIters);
+	for(int i=0;i<lSteps;i++)
+	{
+		//! keep the state before the last step for interpolation
+		if( i == lSteps-1 )
+			_storeTransforms();
+
+		//! Step Box2D
+		mWorld->Step(mTimeStep,mIters);
+		mContacts.endStep();
+		mProfile.Accumulate(mWorld->GetProfile());
+		mAccumulator -= mTimeStep;
+	}
+
+	mAlpha = (gEnv->mInterpolate)?(mAccumulator / mTimeStep):1.0f;
 
 	//! Dispatch all queued up contact points
 	_dispatchContacts();
@@ -168,42 +459,54 @@ void World::updatePhysics( void )
 
 bool World::removeActor( const QString &pName )
 {
-	if( pName.isEmpty() || mActors.empty() || pName == "Ground" )
+	if( pName.isEmpty() || pName == "Ground" )
 		return false;
 
-	ActorArray::iterator lIt = _findActor(pName);
-	if( lIt != mActors.end() )
-	{
-		Actor *lActor = (*lIt);
-
-		// remove it from the world
-		mActors.erase(lIt);
-
-		// delete the actual actor
-		delete lActor;
-		lActor = 0;
-
-		return true;
-	}
+	Actor *lActor = _findActor(pName);
+	if( !lActor )
+		return false;
 
-	return false;
+	return removeActor(lActor);
 }
 
 bool World::removeActor(Actor *pActor)
 {
 	Q_ASSERT( pActor != 0 );
-	return removeActor( pActor->getName() );
+
+	// not one of ours (or the ground)
+	if( findActor<Actor>(pActor->getHandle()) != pActor )
+		return false;
+
+	const int lOrder = mSlots[(int)(pActor->getHandle() & 0xFFFFFFFF)].mOrder;
+
+	_unregisterActor(pActor);
+
+	//! the last one takes its place, only mDrawOrder has to stay sorted
+	Actor *lLast = mActors.back();
+	mActors[lOrder] = lLast;
+	mActors.pop_back();
+
+	// removed later ones have no slot anymore
+	if( lLast != pActor && lLast->getHandle() )
+		mSlots[(int)(lLast->getHandle() & 0xFFFFFFFF)].mOrder = lOrder;
+
+	// delete the actual actor
+	delete pActor;
+
+	return true;
 }
 
 bool World::removeActorBody(Actor *pActor)
 {
 	Q_ASSERT( pActor != 0 );
 
+	sync();
+
 	b2Body *lBody = pActor->getBody();
 
 	if( lBody )
 	{
-		qDebug() << "Success: [World] Removing body for " << pActor->getName();
+		qDebug() << "Success: [World] Removing body for " << NameTable::getInstance().getBase(pActor->getNameId()) << NameTable::getSerial(pActor->getNameId());
 		mWorld->DestroyBody(lBody);
 		return true;
 	}
@@ -213,11 +516,26 @@ bool World::removeActorBody(Actor *pActor)
 
 void World::removeAll( void )
 {
-	removeAllActors(true);
+	sync();
+
+	_releaseAll();
+
+	// Drop all bodies, shapes, joints and contacts at once
+	mWorld->DestroyAll();
+
+	if( mGround )
+	{
+		mGround->setBody(mWorld->GetGroundBody());
+		mWorld->GetGroundBody()->SetUserData(mGround);
+	}
 }
 
 void World::removeAllActors( bool pRemoveJoints )
 {
+	// queued ones aren't in the list anymore
+	_flushRemoved();
+	_clearRecycled(true);
+
 	if( pRemoveJoints )
 		removeAllJoints();
 
@@ -232,8 +550,6 @@ void World::removeAllActors( bool pRemoveJoints )
 		for( ; lIt!= lEnd; ++lIt )
 		{
 			Actor *lActor = (*lIt);
-
-			lActor->setHasJoints(false);
 			lActor->setBody(0);
 
 			delete lActor;
@@ -244,6 +560,11 @@ void World::removeAllActors( bool pRemoveJoints )
 		for( ; lIt!= lEnd; ++lIt )
 		{
 			Actor *lActor = (*lIt);
+
+			// the joints stay, without this actor
+			while( lActor->hasJoints() )
+				lActor->mJoints.last()->_detach(lActor);
+
 			lActor->setBody(0);
 
 			delete lActor;
@@ -251,20 +572,20 @@ void World::removeAllActors( bool pRemoveJoints )
 	}
 
 	mActors.clear();
+	mRemoved.clear();
+
+	_clearRegistry();
 }
 
 void World::removeAllJoints( void )
 {
-	// Clean-Up Joint Data
-	if( mWorld->GetJointCount() )
+	sync();
+
+	// deleting a joint destroys its b2Joint (and its gears)
+	for(int i=0;i<mJointSlots.size();i++)
 	{
-		b2Joint *lJoint = mWorld->GetJointList();
-		while( lJoint )
-		{
-			// remove just userData (autorelease==false)
-			_removeJointData( lJoint );
-			lJoint = lJoint->GetNext();
-		}
+		if( mJointSlots[i].mJoint )
+			delete mJointSlots[i].mJoint;
 	}
 }
 
@@ -273,340 +594,1494 @@ int World::getCount( void ) const
 	return mActors.size();
 }
 
-void World::sortByZorder( void )
+void World::getActors( QVector<Actor *> *pActors ) const
 {
-	if( mActors.empty() )
-		return;
+	Q_ASSERT( pActors != 0 );
 
-	qDebug() << "Success: [World] Sorting " << mActors.size() << " actors by Z order";
-	qSort(mActors.begin(),mActors.end(),sortByZOrder());
+	pActors->clear();
+	pActors->reserve(mActors.size());
+
+	// removed ones wait in the list until the next update()
+	for(int i=0;i<mActors.size();i++)
+	{
+		if( mActors[i]->getHandle() )
+			pActors->push_back(mActors[i]);
+	}
 }
 
-void World::render( void )
+void World::getDrawn( QVector<Actor *> *pActors ) const
 {
-	if( mActors.empty() )
-		return;
+	Q_ASSERT( pActors != 0 );
 
-	ActorArray::iterator lIt	= mActors.begin();
-	ActorArray::iterator lEnd	= mActors.end();
+	pActors->resize(mQueue.size());
 
-	for( ; lIt!= lEnd; ++lIt )
-		(*lIt)->render();
+	for(int i=0;i<mQueue.size();i++)
+		(*pActors)[i] = mQueue[i].mActor;
 }
 
-void World::update( void )
+void World::sortByZorder( void )
 {
-	if( mActors.empty() )
-		return;
+	// nothing to do, mDrawOrder never goes out of order
+}
+
+bool World::saveState( QByteArray *pState )
+{
+	Q_ASSERT( pState != 0 );
+
+	sync();
+
+	const int lActors = _alignState(sizeof(t_stateHeader)) + mActors.size() * sizeof(t_actorState);
+	const int lSize = lActors + mWorld->GetStateSize();
 
-	// update physics world
-	updatePhysics();
+	pState->resize(lSize);
+
+	char *lData = pState->data();
+	t_stateHeader *lHeader = reinterpret_cast<t_stateHeader *>(lData);
+
+	lHeader->mSize = lSize;
+	lHeader->mNumActors = mActors.size();
+	lHeader->mPhysXOffset = lActors;
+	lHeader->mAccumulator = mAccumulator;
+	lHeader->mAlpha = mAlpha;
+
+	t_actorState *lState = reinterpret_cast<t_actorState *>(lData + _alignState(sizeof(t_stateHeader)));
 
 	ActorArray::iterator lIt	= mActors.begin();
 	ActorArray::iterator lEnd	= mActors.end();
 
-	for( ; lIt!= lEnd; ++lIt )
+	for( ; lIt!= lEnd; ++lIt, ++lState )
 	{
-		//updatePhysics();
-
-		Actor *lActor = (*lIt);
-
-		//! Remove frozen actors automatically :)
-		if( lActor->isFrozen() )
-		{
-			removeActor(lActor);
-		}
-		else // update as necessary
-		{
-			lActor->update();
-		}
+		lState->mHandle = (*lIt)->getHandle();
+		(*lIt)->saveState(&lState->mState);
 	}
+
+	mWorld->SaveState(lData + lActors);
+	return true;
 }
 
-bool World::grabActor(int pX, int pY)
+bool World::restoreState( const QByteArray &pState )
 {
-	if( mMouseJoint )
-		return false;
+	sync();
 
-	b2AABB lAABB;
+	if( pState.size() < (int) sizeof(t_stateHeader) )
+		return false;
 
-	b2Vec2 lPos(S2W(pX,pY));
-	b2Vec2 lDis(0.001f,0.001f);
+	const char *lData = pState.constData();
+	const t_stateHeader *lHeader = reinterpret_cast<const t_stateHeader *>(lData);
 
-	lAABB.lowerBound = lPos - lDis;
-	lAABB.upperBound = lPos + lDis;
+	if( lHeader->mSize != pState.size() || lHeader->mNumActors != mActors.size() )
+	{
+		qDebug() << "Error: [World] State doesn't match the current actors";
+		return false;
+	}
 
-	// Query the world for overlapping shapes.
-	const int lMaxCount = 10;
-	b2Shape *lShapes[lMaxCount];
-	b2Body *lBody = 0;
+	const t_actorState *lState = reinterpret_cast<const t_actorState *>(lData + _alignState(sizeof(t_stateHeader)));
 
-	int lCount = mWorld->Query(lAABB, lShapes, lMaxCount);
-	for (int i = 0; i < lCount; ++i)
+	// same number, all still alive: the very same actors
+	for(int i=0;i<lHeader->mNumActors;i++)
 	{
-		b2Body* lShapeBody = lShapes[i]->GetBody();
-		if (lShapeBody->IsStatic() == false && lShapeBody->GetMass() > 0.0f)
+		if( !findActor<Actor>(lState[i].mHandle) )
 		{
-			bool lIsInside = lShapes[i]->TestPoint(lShapeBody->GetXForm(), lPos);
-			if (lIsInside)
-			{
-				lBody = lShapes[i]->GetBody();
-				break;
-			}
+			qDebug() << "Error: [World] State doesn't match the current actors";
+			return false;
 		}
 	}
 
-	if (lBody)
+	//! bodies and joints have to match as well
+	if( !mWorld->LoadState(lData + lHeader->mPhysXOffset, lHeader->mSize - lHeader->mPhysXOffset) )
 	{
-		b2MouseJointDef lMouseJDef;
-		lMouseJDef.body1 = mWorld->GetGroundBody();
-		lMouseJDef.body2 = lBody;
-		lMouseJDef.target = lPos;
-		lMouseJDef.maxForce = 1000.0f * lBody->GetMass();
-
-		mMouseJoint = static_cast<b2MouseJoint*>(mWorld->CreateJoint(&lMouseJDef));
-		lBody->WakeUp();
+		qDebug() << "Error: [World] State doesn't match the current bodies";
+		return false;
+	}
 
-		mActor = static_cast<Actor *>(lBody->GetUserData());
+	for(int i=0;i<lHeader->mNumActors;i++)
+		findActor<Actor>(lState[i].mHandle)->restoreState(&lState[i].mState);
 
-		return true;
-	}
+	mAccumulator = lHeader->mAccumulator;
+	mAlpha = lHeader->mAlpha;
 
-	return false;
+	return true;
 }
 
-void World::moveActor(int pX, int pY)
+void World::render( void )
 {
-	if( mMouseJoint )
-	{
-		mMouseJoint->SetTarget(b2Vec2(S2W(pX,pY)));
-	}
-}
+	//! the broadphase can't be queried once a step is in flight
+	if( mCulling )
+		_cullActors();
 
-void World::dropActor(void)
-{
-	if( mMouseJoint )
+	//! overlap the pending steps with drawing
+	_startStep();
+
+#ifndef WORLD_HEADLESS // look through the camera
+	glPushMatrix();
+	glTranslatef(gEnv->mSWidth / 2.0f,gEnv->mSHeight / 2.0f,0.0f);
+	glScalef(mZoom,mZoom,1.0f);
+	glTranslatef(-mCamera[0],-mCamera[1],0.0f);
+#endif
+
+	_buildQueue();
+
+	QVector<t_renderItem>::const_iterator lIt	= mQueue.constBegin();
+	QVector<t_renderItem>::const_iterator lEnd	= mQueue.constEnd();
+
+	if( mBatching )
 	{
-		mWorld->DestroyJoint(mMouseJoint);
-		mMouseJoint = 0;
-		mActor = 0;
+		mBatch.begin();
+
+		for( ; lIt!= lEnd; ++lIt )
+			lIt->mActor->batch(&mBatch);
+
+		// still under the camera transform
+		mBatch.end();
+
+		mDrawCalls = mBatch.getDrawCalls();
+		mStateChanges = mBatch.getStateChanges();
+	}
+	else
+	{
+		mDrawCalls = 0;
+		mStateChanges = 0;
+
+		for( ; lIt!= lEnd; ++lIt )
+		{
+			Actor *lActor = lIt->mActor;
+			lActor->render();
+
+			if( lActor->isFlag(Actor::V_HIDDEN) )
+				continue;
+
+			mDrawCalls++;
+			mStateChanges += lActor->getStateChanges();
+		}
 	}
+
+	mDrawn = mQueue.size();
+
+#ifndef WORLD_HEADLESS
+	glPopMatrix();
+#endif
 }
 
-ActorJoint *World::createJoint(const QString &pName, Actor *pA1,
-							   Actor *pA2, const float pX, const float pY, bool pUnique)
+void World::setCamera( float pX, float pY )
 {
-	Q_ASSERT( !pName.isEmpty() );
+	mCamera[0] = pX;
+	mCamera[1] = pY;
 
-	QString lName = pName;
+	// whatever fits on the screen
+	const float lW = gEnv->mSWidth / mZoom;
+	const float lH = gEnv->mSHeight / mZoom;
 
-	if( pUnique )
-		lName = _getUnique(pName);
+	setViewRect(pX - lW / 2,pY - lH / 2,lW,lH);
+}
 
-	return (new ActorJoint(lName,this))->init(pA1,pA2,pX,pY);
+void World::moveCamera( float pDX, float pDY )
+{
+	setCamera(mCamera[0] + pDX,mCamera[1] + pDY);
 }
 
-ActorJoint *World::createJoint( const QString &pName, Actor *pA1,
-								Actor *pA2, bool pUnique )
+void World::setZoom( float pZoom )
 {
-	Q_ASSERT( !pName.isEmpty() );
+	Q_ASSERT( pZoom > 0.0f );
 
-	QString lName = pName;
+	mZoom = pZoom;
+	setCamera(mCamera[0],mCamera[1]);
+}
 
-	if( pUnique )
-		lName = _getUnique(pName);
+void World::getCamera( t_point *pPos ) const
+{
+	Q_ASSERT( pPos != 0 );
 
-	return (new ActorJoint(lName,this))->init(pA1,pA2);
+	(*pPos)[0] = mCamera[0];
+	(*pPos)[1] = mCamera[1];
 }
 
-bool World::removeJoint( b2Joint *pJoint )
+void World::toWorld( float pX, float pY, t_point *pPos ) const
 {
-	Q_ASSERT( pJoint !=  0);
+	Q_ASSERT( pPos != 0 );
 
-	ActorJoint *lJoint = static_cast<ActorJoint *>(pJoint->GetUserData());
-	if( lJoint )
-		delete lJoint;
+	(*pPos)[0] = mCamera[0] + (pX - gEnv->mSWidth / 2.0f) / mZoom;
+	(*pPos)[1] = mCamera[1] + (pY - gEnv->mSHeight / 2.0f) / mZoom;
+}
 
-	return true;
+void World::setViewRect( float pX, float pY, float pW, float pH )
+{
+	mViewRect[0] = pX;
+	mViewRect[1] = pY;
+	mViewRect[2] = pW;
+	mViewRect[3] = pH;
 }
 
-bool World::removeJoint( const QString &pName )
+void World::getViewRect( t_rect *pRect ) const
+{
+	Q_ASSERT( pRect != 0 );
+	memcpy(pRect,mViewRect,sizeof(t_rect));
+}
+
+void World::_cullActors( void )
 {
-	if( mWorld->GetJointCount() )
+	mVisible.clear();
+
+	// wrapped around, nobody may look visible already
+	if( !++mCullStamp )
 	{
-		unsigned int lHash = qHash(pName);
+		ActorArray::iterator lIt	= mActors.begin();
+		ActorArray::iterator lEnd	= mActors.end();
 
-		b2Joint *lJoint = mWorld->GetJointList();
-		while( lJoint )
-		{
-			ActorJoint *lActor = static_cast<ActorJoint *>(lJoint->GetUserData());
+		for( ; lIt!= lEnd; ++lIt )
+			(*lIt)->mCullStamp = 0;
+
+		mCullStamp = 1;
+	}
+
+	//! catch up with everything moved since the last update()
+	_updateGrid();
+
+	const float lX0 = mViewRect[0];
+	const float lY0 = mViewRect[1];
+	const float lX1 = mViewRect[0] + mViewRect[2];
+	const float lY1 = mViewRect[1] + mViewRect[3];
+
+	//! physical actors, straight from the broadphase
+	b2AABB lAABB;
+	lAABB.lowerBound.Set(S2W((lX0 - mCullMargin),(lY0 - mCullMargin)));
+	lAABB.upperBound.Set(S2W((lX1 + mCullMargin),(lY1 + mCullMargin)));
+
+	int32 lCount;
+	while( (lCount = mWorld->Query(lAABB,mCullShapes.data(),mCullShapes.size())) == mCullShapes.size() )
+		mCullShapes.resize(mCullShapes.size() * 2);
+
+	for(int i=0;i<lCount;i++)
+	{
+		Actor *lActor = static_cast<Actor *>(mCullShapes[i]->GetBody()->GetUserData());
+
+		if( lActor )
+			_cullActor(lActor,false);
+	}
+
+	//! the rest by grid cell
+	const t_point lCenter = { (lX0 + lX1) / 2, (lY0 + lY1) / 2 };
+	int lRect[4];
 
-			if( !lActor )
+	_getCells(lCenter,qMax(lX1 - lX0,lY1 - lY0) / 2,lRect);
+
+	for(int y=lRect[1];y<=lRect[3];y++)
+	{
+		for(int x=lRect[0];x<=lRect[2];x++)
+		{
+			CullGrid::const_iterator lCell = mGrid.find(_getCellKey(x,y));
+			if( lCell == mGrid.end() )
 				continue;
 
-			if( lHash == lActor->getId() )
-				return removeJoint(lJoint);
+			const QVector<Actor *> &lActors = lCell.value();
 
-			lJoint = lJoint->GetNext();
+			for(int i=0;i<lActors.size();i++)
+				_cullActor(lActors[i],true);
 		}
 	}
 
-	return false;
+	for(int i=0;i<mGridLarge.size();i++)
+		_cullActor(mGridLarge[i],true);
+
+	//! back into draw order
+	qSort(mVisible.begin(),mVisible.end());
 }
 
-bool World::removeJoint( Actor *pActor )
+void World::_buildQueue( void )
 {
-	Q_ASSERT( pActor != 0 );
+	// resized rather than cleared, keeps the memory from frame to frame
+	mQueue.resize((mCulling)?mVisible.size():mDrawOrder.size());
+	t_renderItem *lItem = mQueue.data();
 
-	b2Body *lBody = pActor->getBody();
+	if( mCulling )
+	{
+		QVector<t_drawItem>::const_iterator lIt		= mVisible.constBegin();
+		QVector<t_drawItem>::const_iterator lEnd	= mVisible.constEnd();
 
-	if( !pActor->hasJoints() || !lBody )
+		for( ; lIt!= lEnd; ++lIt, ++lItem )
+		{
+			lItem->mKey = 0;
+			lItem->mActor = lIt->mActor;
+		}
+	}
+	else
 	{
-		qDebug() << "Success: [World] No associated joints with " << pActor->getName();
-		return true;
+		DrawOrder::const_iterator lIt	= mDrawOrder.constBegin();
+		DrawOrder::const_iterator lEnd	= mDrawOrder.constEnd();
+
+		for( ; lIt!= lEnd; ++lIt, ++lItem )
+		{
+			lItem->mKey = 0;
+			lItem->mActor = lIt.value();
+		}
 	}
 
-	if( mWorld->GetJointCount() )
+	if( !mSorting || mQueue.size() < 2 )
+		return;
+
+	quint64 lLayer = 0;
+	int lFirst = 0;
+	int lBlend = 0;
+	bool lFree = false;
+
+	for(int i=0;i<=mQueue.size();i++)
 	{
-		b2Joint *lJoint = mWorld->GetJointList();
-		while( lJoint )
+		Actor *lActor = (i < mQueue.size())?mQueue[i].mActor:0;
+		int lActorBlend = 0;
+		bool lActorFree = false;
+
+		if( lActor )
+		{
+			// opaque, source alpha or additive
+			lActorBlend = (lActor->mBlending == Actor::B_NONE)?0:((lActor->mBlending == Actor::B_ONE)?2:1);
+			lActorFree = (lActorBlend != 1);
+		}
+
+		// same render layer and both free to move, still the same run
+		if( lActor && i > 0 && lFree && lActorFree && lActorBlend == lBlend && _sameRenderLayer(mQueue[lFirst].mActor,lActor) )
 		{
-			b2Joint *lPrevJoint = lJoint;
-			lJoint = lJoint->GetNext();
+			mQueue[i].mKey = _getRenderKey(lLayer,lActorBlend,lActor->mTexture,i - lFirst);
+			continue;
+		}
 
-			b2Body *lBody1 = lPrevJoint->GetBody1();
-			b2Body *lBody2 = lPrevJoint->GetBody2();
+		// the layer is over, bring its textures together
+		if( i - lFirst > 1 )
+			qSort(mQueue.begin() + lFirst,mQueue.begin() + i);
 
-			ActorJoint *lActorJoint = static_cast<ActorJoint *>(lPrevJoint->GetUserData());
+		if( !lActor )
+			break;
 
-			if( lBody1 == lBody || lBody2 == lBody )
-			{
-				qDebug() << "Success: [World] Removing joint " << lActorJoint->getName() << " associated with " << pActor->getName();
-				removeJoint(lPrevJoint);
-			}
-		}
+		lLayer++;
+		lFirst = i;
+		lBlend = lActorBlend;
+		lFree = lActorFree;
 
-		return true;
+		mQueue[i].mKey = _getRenderKey(lLayer,lActorBlend,lActor->mTexture,0);
 	}
+}
 
-	return false;
+bool World::_sameRenderLayer( const Actor *pA, const Actor *pB ) const
+{
+	if( pA->mRenderLayer != pB->mRenderLayer )
+		return false;
+
+	if( pA->mRenderLayer != Actor::R_DEFAULT )
+		return true;
+
+	// different Z-Orders are the painter's order
+	return pA->mZ == pB->mZ;
 }
 
-bool World::removeJoint( const ActorJoint *pJoint )
+void World::_updateGrid( void )
 {
-	Q_ASSERT( pJoint != 0 );
+	QVector<t_handle>::const_iterator lIt	= mGridDirty.constBegin();
+	QVector<t_handle>::const_iterator lEnd	= mGridDirty.constEnd();
+
+	for( ; lIt!= lEnd; ++lIt )
+	{
+		// removed meanwhile
+		Actor *lActor = findActor<Actor>(*lIt);
+		if( !lActor )
+			continue;
+
+		lActor->mGridDirty = false;
+
+		_gridRemove(lActor);
+		if( !lActor->getBody() )
+			_gridInsert(lActor);
+	}
 
-	return removeJoint(pJoint->getJoint());
+	mGridDirty.clear();
 }
 
-void World::_allocContacts(unsigned short pNumContacts)
+void World::_cullActor( Actor *pActor, bool pTest )
 {
-	Q_ASSERT( pNumContacts != 0 );
+	// ground and removed actors, or found in another cell already
+	if( !pActor->mHandle || pActor->mCullStamp == mCullStamp )
+		return;
+
+	pActor->mCullStamp = mCullStamp;
 
-	if( !mContacts.isEmpty() )
+	if( pActor->isFlag(Actor::V_HIDDEN) )
 		return;
 
-	for(unsigned short i=0;i<pNumContacts;i++)
+	// cells are coarse, check the actor itself
+	if( pTest )
 	{
-		ContactPoint *lPoint = new ContactPoint;
-		lPoint->mActor1 = 0;
-		lPoint->mActor2 = 0;
+		const float *lPos = pActor->mHot->mDPos;
+		const float lR = _getCullRadius(pActor->mHSize[0],pActor->mHSize[1]);
 
-		mContacts.push_back(lPoint);
+		if( lPos[0] + lR < mViewRect[0] || lPos[0] - lR > mViewRect[0] + mViewRect[2] ||
+			lPos[1] + lR < mViewRect[1] || lPos[1] - lR > mViewRect[1] + mViewRect[3] )
+			return;
 	}
 
-	qDebug() << "Allocated Contact Points Queue with a size of " << pNumContacts;
+	t_drawItem lItem = { { pActor->getZOrder(), pActor->mDrawSeq }, pActor };
+	mVisible.push_back(lItem);
 }
 
-void World::_resetContacts( void )
+void World::_invalidateActor( Actor *pActor )
 {
-	if( mContacts.isEmpty() )
-		return;
+	Q_ASSERT( pActor != 0 );
+	mGridDirty.push_back(pActor->mHandle);
+}
+
+void World::_growCullMargin( float pMargin )
+{
+	if( pMargin > mCullMargin )
+		mCullMargin = pMargin;
+}
+
+void World::_gridInsert( Actor *pActor )
+{
+	Q_ASSERT( !pActor->mInGrid );
 
-	ContactArray::iterator lIt	= mContacts.begin();
-	ContactArray::iterator lEnd	= mContacts.end();
+	int *lRect = pActor->mGridRect;
+	_getCells(pActor->mHot->mDPos,_getCullRadius(pActor->mHSize[0],pActor->mHSize[1]),lRect);
 
-	for( ; lIt!= lEnd; ++lIt )
+	pActor->mInGrid = true;
+
+	if( (lRect[2] - lRect[0] + 1) * (lRect[3] - lRect[1] + 1) > WORLD_CULL_MAX_CELLS )
 	{
-		ContactPoint *lPoint = (*lIt);
-		lPoint->mActor1 = 0;
-		lPoint->mActor2 = 0;
+		mGridLarge.push_back(pActor);
+		return;
 	}
 
-	mNumContacts = 0;
+	for(int y=lRect[1];y<=lRect[3];y++)
+		for(int x=lRect[0];x<=lRect[2];x++)
+			mGrid[_getCellKey(x,y)].push_back(pActor);
 }
 
-void World::_dispatchContacts( void )
+void World::_gridRemove( Actor *pActor )
 {
-	if( mContacts.isEmpty() )
+	if( !pActor->mInGrid )
+		return;
+
+	const int *lRect = pActor->mGridRect;
+	pActor->mInGrid = false;
+
+	if( (lRect[2] - lRect[0] + 1) * (lRect[3] - lRect[1] + 1) > WORLD_CULL_MAX_CELLS )
+	{
+		mGridLarge.remove(mGridLarge.indexOf(pActor));
 		return;
+	}
 
-	//! Emit signals
-	for(unsigned short i=0;i<mNumContacts;i++)
-		emit onCollision(mContacts[i]);
+	for(int y=lRect[1];y<=lRect[3];y++)
+	{
+		for(int x=lRect[0];x<=lRect[2];x++)
+		{
+			CullGrid::iterator lCell = mGrid.find(_getCellKey(x,y));
+			Q_ASSERT( lCell != mGrid.end() );
+
+			// order within a cell doesn't matter
+			QVector<Actor *> &lActors = lCell.value();
+			lActors[lActors.indexOf(pActor)] = lActors.last();
+			lActors.pop_back();
+
+			if( lActors.isEmpty() )
+				mGrid.erase(lCell);
+		}
+	}
+}
+
+void World::update( void )
+{
+	qint64 lTicks = Utils::getTicks();
+	_update();
+	mUpdateTime = Utils::getElapsed(lTicks);
 }
 
-void World::_deallocContacts( void )
+void World::_update( void )
 {
-	if( mContacts.isEmpty() )
+	if( mActors.empty() )
 		return;
 
-	ContactArray::iterator lIt	= mContacts.begin();
-	ContactArray::iterator lEnd	= mContacts.end();
+	//! all body transforms in one tight pass
+	_pullTransforms();
+
+	ActorArray::iterator lIt	= mActors.begin();
+	ActorArray::iterator lEnd	= mActors.end();
 
 	for( ; lIt!= lEnd; ++lIt )
-		delete (*lIt);
+	{
+		Actor *lActor = (*lIt);
 
-	mContacts.clear();
+		//! Recycle frozen actors automatically :)
+		if( lActor->isFrozen() )
+		{
+			retireActor(lActor);
+		}
+		else // update as necessary
+		{
+			lActor->update();
+		}
+	}
 
-	qDebug() << "DeAllocated Contact Points Queue ...";
+	// everything removed during this frame goes at once
+	_flushRemoved();
+
+	// and whatever moved goes into its new cells
+	_updateGrid();
 }
 
-QString World::_getUnique( const QString &pName )
+bool World::removeActorLater( Actor *pActor )
 {
-	if( pName.isEmpty() )
-		return pName;
+	Q_ASSERT( pActor != 0 );
 
-	return pName+"_"+QString::number(clock()+getCount()+rand()%16000);
+	// not one of ours, the ground or already queued
+	if( !_unregisterActor(pActor) )
+		return false;
+
+	mRemoved.push_back(pActor);
+	return true;
 }
 
-bool World::_removeJointData( b2Joint *pJoint )
+bool World::retireActor( Actor *pActor )
 {
-	Q_ASSERT( pJoint != 0 );
+	Q_ASSERT( pActor != 0 );
 
-	if( !pJoint->GetUserData() )
+	// not one of ours, the ground or already queued
+	if( !_unregisterActor(pActor) )
 		return false;
 
-	ActorJoint *lJoint = static_cast<ActorJoint *>(pJoint->GetUserData());
+	mRetired.push_back(pActor);
+	return true;
+}
+
+int World::getRecycledCount( void ) const
+{
+	int lCount = 0;
+
+	RecycleBin::const_iterator lIt	= mRecycled.constBegin();
+	RecycleBin::const_iterator lEnd	= mRecycled.constEnd();
+
+	for( ; lIt!= lEnd; ++lIt )
+		lCount += lIt.value().size();
+
+	return lCount;
+}
+
+Actor *World::_reviveActor( const QString &pName, float pX, float pY, float pRot )
+{
+	t_name lName = NameTable::getInstance().find(pName);
+
+	RecycleBin::iterator lBin = (lName)?mRecycled.find(NameTable::getBaseName(lName)):mRecycled.end();
+
+	if( lBin == mRecycled.end() || lBin.value().isEmpty() )
+		return 0;
+
+	Actor *lActor = lBin.value().back();
+	lBin.value().pop_back();
 
-	if(lJoint)
+	// its body goes back into the broadphase
+	if( lActor->getBody() )
+		sync();
+
+	lActor->setZOrder(mZOrder);
+	lActor->mAutoZ = true;
+	lActor->_revive(pX,pY,pRot);
+
+	// same as createActor()
+	_registerActor(lActor);
+
+	mZOrder += 0.000001;
+	return lActor;
+}
+
+void World::_clearRecycled( bool pDestroyBodies )
+{
+	if( mRecycled.isEmpty() )
+		return;
+
+	QVector<b2Body *> lBodies;
+
+	RecycleBin::iterator lIt	= mRecycled.begin();
+	RecycleBin::iterator lEnd	= mRecycled.end();
+
+	for( ; lIt!= lEnd; ++lIt )
 	{
-		//
-		qDebug() << "Success: [World] Pre-Removing joint " << lJoint->getName();
-		delete lJoint;
+		QVector<Actor *> &lActors = lIt.value();
 
-		// clean-user data
-		pJoint->SetUserData(0);
+		for(int i=0;i<lActors.size();i++)
+		{
+			if( lActors[i]->getBody() )
+				lBodies.push_back(lActors[i]->getBody());
+		}
+	}
 
-		return true;
+	// one batch, inactive bodies have nothing in the broadphase anyway
+	if( pDestroyBodies && !lBodies.isEmpty() )
+	{
+		sync();
+		mWorld->DestroyBodies(lBodies.data(),lBodies.size());
 	}
 
-	return false;
+	for( lIt = mRecycled.begin(); lIt!= lEnd; ++lIt )
+	{
+		QVector<Actor *> &lActors = lIt.value();
+
+		for(int i=0;i<lActors.size();i++)
+		{
+			lActors[i]->setBody(0);
+			delete lActors[i];
+		}
+	}
+
+	mRecycled.clear();
 }
 
-World::ActorArray::iterator World::_findActor(const QString &pName)
+void World::_flushRemoved( void )
 {
-	if( pName.isEmpty() || mActors.empty() )
-		return mActors.end();
+	if( mRemoved.isEmpty() && mRetired.isEmpty() )
+		return;
 
-	unsigned int lHash = qHash(pName);
+	sync();
 
-	ActorArray::iterator lIt	= mActors.begin();
-	ActorArray::iterator lEnd	= mActors.end();
+	QVector<Actor *>::const_iterator lIt	= mRetired.constBegin();
+	QVector<Actor *>::const_iterator lEnd	= mRetired.constEnd();
+
+	for( ; lIt!= lEnd; ++lIt )
+	{
+		Actor *lActor = (*lIt);
+		QVector<Actor *> &lBin = mRecycled[NameTable::getBaseName(lActor->getNameId())];
+
+		// a full bin, it goes for good
+		if( lBin.size() >= WORLD_MAX_RECYCLED )
+		{
+			mRemoved.push_back(lActor);
+			continue;
+		}
+
+		if( lActor == mActor )
+			_dropActor();
+
+		// no joints on inactive bodies
+		if( lActor->hasJoints() )
+			removeJoint(lActor);
+
+		if( lActor->getBody() )
+			lActor->getBody()->SetActive(false);
+
+		lBin.push_back(lActor);
+	}
+
+	mRetired.clear();
+
+	QVector<b2Body *> lBodies;
+	lBodies.reserve(mRemoved.size());
+
+	lIt		= mRemoved.constBegin();
+	lEnd	= mRemoved.constEnd();
 
 	for( ; lIt!= lEnd; ++lIt )
-		if( (*lIt)->getId() == lHash )
-			return lIt;
+	{
+		Actor *lActor = (*lIt);
+
+		// the mouse joint goes with the body
+		if( lActor == mActor )
+			_dropActor();
+
+		// joint wrappers go first
+		if( lActor->hasJoints() )
+			removeJoint(lActor);
+
+		if( lActor->getBody() )
+		{
+			lBodies.push_back(lActor->getBody());
+			lActor->setBody(0);
+		}
+	}
+
+	// one batch for the broadphase
+	if( !lBodies.isEmpty() )
+		mWorld->DestroyBodies(lBodies.data(),lBodies.size());
+
+	// drop them from the list in a single pass (keeping the update order),
+	// unregistered actors are the ones which have been removed
+	int lKept = 0;
+	for(int i=0;i<mActors.size();i++)
+	{
+		const t_handle lHandle = mActors[i]->getHandle();
+
+		if( !lHandle )
+			continue;
+
+		mSlots[(int)(lHandle & 0xFFFFFFFF)].mOrder = lKept;
+		mActors[lKept++] = mActors[i];
+	}
+
+	mActors.erase(mActors.begin()+lKept,mActors.end());
+
+	// no bodies left, nothing for the destructors to clean-up
+	for( lIt = mRemoved.constBegin(); lIt!= lEnd; ++lIt )
+		delete (*lIt);
+
+	mRemoved.clear();
+}
+
+bool World::grabActor(int pX, int pY)
+{
+	t_point lPos;
+	toWorld(pX,pY,&lPos);
+
+	//! a query, the caller wants the answer now
+	sync();
+
+	return _grabActor(lPos[0],lPos[1]);
+}
+
+void World::moveActor(int pX, int pY)
+{
+	t_point lPos;
+	toWorld(pX,pY,&lPos);
+
+	if( mStepping )
+	{
+		t_input lInput = { t_input::I_MOVE, lPos[0], lPos[1] };
+		mInput.push_back(lInput);
+		return;
+	}
+
+	_moveActor(lPos[0],lPos[1]);
+}
+
+void World::dropActor(void)
+{
+	if( mStepping )
+	{
+		t_input lInput = { t_input::I_DROP, 0, 0 };
+		mInput.push_back(lInput);
+		return;
+	}
+
+	_dropActor();
+}
+
+bool World::_grabActor(float pX, float pY)
+{
+	if( mMouseJoint )
+		return false;
+
+	b2AABB lAABB;
+
+	b2Vec2 lPos(S2W(pX,pY));
+	b2Vec2 lDis(0.001f,0.001f);
+
+	lAABB.lowerBound = lPos - lDis;
+	lAABB.upperBound = lPos + lDis;
+
+	// Query the world for overlapping shapes.
+	const int lMaxCount = 10;
+	b2Shape *lShapes[lMaxCount];
+	b2Body *lBody = 0;
+
+	int lCount = mWorld->Query(lAABB, lShapes, lMaxCount);
+	for (int i = 0; i < lCount; ++i)
+	{
+		b2Body* lShapeBody = lShapes[i]->GetBody();
+		if (lShapeBody->IsStatic() == false && lShapeBody->GetMass() > 0.0f)
+		{
+			bool lIsInside = lShapes[i]->TestPoint(lShapeBody->GetXForm(), lPos);
+			if (lIsInside)
+			{
+				lBody = lShapes[i]->GetBody();
+				break;
+			}
+		}
+	}
+
+	if (lBody)
+	{
+		b2MouseJointDef lMouseJDef;
+		lMouseJDef.body1 = mWorld->GetGroundBody();
+		lMouseJDef.body2 = lBody;
+		lMouseJDef.target = lPos;
+		lMouseJDef.maxForce = 1000.0f * lBody->GetMass();
+
+		mMouseJoint = static_cast<b2MouseJoint*>(mWorld->CreateJoint(&lMouseJDef));
+		lBody->WakeUp();
+
+		mActor = static_cast<Actor *>(lBody->GetUserData());
+
+		return true;
+	}
+
+	return false;
+}
+
+void World::_moveActor(float pX, float pY)
+{
+	if( mMouseJoint )
+	{
+		mMouseJoint->SetTarget(b2Vec2(S2W(pX,pY)));
+	}
+}
+
+void World::_dropActor(void)
+{
+	if( mMouseJoint )
+	{
+		mWorld->DestroyJoint(mMouseJoint);
+		mMouseJoint = 0;
+		mActor = 0;
+	}
+}
+
+ActorJoint *World::createJoint(const QString &pName, Actor *pA1,
+							   Actor *pA2, const float pX, const float pY, bool pUnique)
+{
+	return createJoint<ActorJoint>(pName,pUnique)->init(pA1,pA2,pX,pY);
+}
+
+ActorJoint *World::createJoint( const QString &pName, Actor *pA1,
+								Actor *pA2, bool pUnique )
+{
+	return createJoint<ActorJoint>(pName,pUnique)->init(pA1,pA2);
+}
+
+bool World::removeJoint( b2Joint *pJoint )
+{
+	Q_ASSERT( pJoint !=  0);
+
+	sync();
+
+	ActorJoint *lJoint = static_cast<ActorJoint *>(pJoint->GetUserData());
+	if( lJoint )
+		delete lJoint;
+
+	return true;
+}
+
+bool World::removeJoint( const QString &pName )
+{
+	ActorJoint *lJoint = findJoint(pName);
+
+	if( !lJoint )
+		return false;
+
+	return removeJoint(lJoint);
+}
+
+Prefab *World::findPrefab( const QString &pName ) const
+{
+	t_name lName = NameTable::getInstance().find(pName);
+
+	return (lName)?mPrefabs.value(lName):0;
+}
+
+int World::spawn( Prefab *pPrefab, const t_point *pPositions, int pCount, Actor **pActors )
+{
+	Q_ASSERT( pPrefab != 0 );
+	Q_ASSERT( pPositions != 0 || pCount == 0 );
+
+	if( pCount <= 0 )
+		return 0;
+
+	const bool lPhysical = pPrefab->isPhysical();
+
+	// bodies are created right away
+	if( lPhysical )
+		sync();
+
+	// once for the whole batch
+	pPrefab->build();
+
+	NameTable &lNames = NameTable::getInstance();
+
+	mSlots.reserve(mSlots.size()+pCount);
+	mActorIndex.reserve(mActorIndex.size()+pCount);
+
+	// the broadphase takes all the new shapes at once
+	if( lPhysical )
+		mWorld->BeginCreate();
+
+	for(int i=0;i<pCount;i++)
+	{
+		// unnamed, the unique name is set right away
+		Actor *lActor = pPrefab->create(this,QString());
+
+		// set up before it's registered, nothing to re-index
+		lActor->_setNameId(lNames.unique(pPrefab->getNameId()));
+		lActor->_applyPrefab(pPrefab,pPositions[i][0],pPositions[i][1]);
+
+		// next in line like createActor(), unless the template has a Z-Order of its own
+		if( pPrefab->getActor()->mAutoZ )
+		{
+			lActor->setZOrder(mZOrder);
+			lActor->mAutoZ = true;
+
+			mZOrder += 0.000001;
+		}
+
+		_registerActor(lActor);
+
+		if( pActors )
+			pActors[i] = lActor;
+	}
+
+	if( lPhysical )
+		mWorld->EndCreate();
+
+	qDebug() << "Success: [World] " << pCount << " x " << pPrefab->getName() << " spawned";
+
+	return pCount;
+}
+
+ActorJoint *World::findJoint( const QString &pName ) const
+{
+	NameTable &lNames = NameTable::getInstance();
+
+	// same as _findActor()
+	t_name lName = lNames.find(pName);
+	ActorJoint *lJoint = (lName)?mJointIndex.value(lName):0;
+
+	if( !lJoint && (lName = lNames.findUnique(pName)) )
+		lJoint = mJointIndex.value(lName);
+
+	return lJoint;
+}
+
+ActorJoint *World::findJoint( t_handle pHandle ) const
+{
+	const int lIndex = (int)(pHandle & 0xFFFFFFFF);
+	const unsigned int lGeneration = (unsigned int)(pHandle >> 32);
+
+	if( lIndex >= mJointSlots.size() || mJointSlots[lIndex].mGeneration != lGeneration )
+		return 0;
+
+	return mJointSlots[lIndex].mJoint;
+}
+
+bool World::removeJoint( Actor *pActor )
+{
+	Q_ASSERT( pActor != 0 );
+
+	if( !pActor->hasJoints() )
+	{
+		qDebug() << "Success: [World] No associated joints with " << NameTable::getInstance().getBase(pActor->getNameId()) << NameTable::getSerial(pActor->getNameId());
+		return true;
+	}
+
+	sync();
+
+	// each one takes itself (and its gears) off the list
+	while( pActor->hasJoints() )
+	{
+		ActorJoint *lJoint = pActor->mJoints.last();
+
+		qDebug() << "Success: [World] Removing joint " << lJoint->getName() << " associated with " << NameTable::getInstance().getBase(pActor->getNameId()) << NameTable::getSerial(pActor->getNameId());
+		delete lJoint;
+	}
+
+	return true;
+}
+
+bool World::removeJoint( const ActorJoint *pJoint )
+{
+	Q_ASSERT( pJoint != 0 );
+
+	if( findJoint(pJoint->getHandle()) != pJoint )
+		return false;
+
+	sync();
+
+	delete pJoint;
+	return true;
+}
+
+void World::_resetContacts( void )
+{
+	mContacts.clear();
+}
+
+void World::_dispatchContacts( void )
+{
+	if( !mContacts.getNumEvents() )
+		return;
+
+	mContacts.lock();
+
+	//! One signal per step
+	for(int i=0;i<mContacts.getNumSteps();i++)
+	{
+		int lNumEvents = 0;
+		const ContactEvent *lEvents = mContacts.getStep(i,&lNumEvents);
+
+		if( lNumEvents )
+			emit onContacts(lEvents,lNumEvents);
+	}
+
+	mContacts.unlock();
+}
+
+float World::_getElapsed( void )
+{
+	//! simulated clock
+	if( gEnv->mFixedFrameTime > 0.0f )
+		return gEnv->mFixedFrameTime;
+
+	//! 1st call, start the clock and take a single step
+	if( mClock.isNull() )
+	{
+		mClock.start();
+		return mTimeStep;
+	}
+
+	return (float)(mClock.restart() / 1000.0f);
+}
+
+void World::_storeTransforms( void )
+{
+	/*!
+		Bodies which didn't move since the last call already
+		have the same previous and current transform, the rest
+		gets both (they only differ once stepped again), then
+		the list starts over for the last step of the frame.
+	*/
+	b2Body **lBodies = mWorld->GetMovedBodies();
+	const int lCount = mWorld->GetMovedBodyCount();
+
+	for(int i=0;i<lCount;i++)
+	{
+		Actor *lActor = static_cast<Actor *>(lBodies[i]->GetUserData());
+
+		if( !lActor )
+			continue;
+
+		b2Vec2 lPos = lBodies[i]->GetPosition();
+		const float lX = W2S_(lPos.x);
+		const float lY = W2S_(lPos.y);
+		const float lRot = R2D(lBodies[i]->GetAngle());
+
+		lActor->storeTransform(lX,lY,lRot);
+		_pullTransform(lActor,lX,lY,lRot);
+	}
+
+	mWorld->ClearMovedBodies();
+}
+
+void World::_startStep( void )
+{
+	if( !mThread || !mPendingSteps )
+		return;
+
+	//! filled by the worker from the moved bodies
+	mTransforms.clear();
+
+	//! reset all contact points prior stepping
+	_resetContacts();
+
+	mStepping = true;
+	mThread->step(mPendingSteps,mTimeStep,mIters,&mTransforms);
+	mPendingSteps = 0;
+}
+
+void World::_finishStep( void )
+{
+	if( !mStepping )
+		return;
+
+	mThread->sync();
+	mStepping = false;
+
+	mProfile = mThread->getProfile();
+
+	//! swap in the transforms captured by the worker (see World::_storeTransforms())
+	TransformArray::const_iterator lIt	= mTransforms.constBegin();
+	TransformArray::const_iterator lEnd	= mTransforms.constEnd();
+
+	for( ; lIt!= lEnd; ++lIt )
+	{
+		lIt->mActor->storeTransform(lIt->mPos[0],lIt->mPos[1],lIt->mRot);
+		_pullTransform(lIt->mActor,lIt->mPos[0],lIt->mPos[1],lIt->mRot);
+	}
+
+	//! Dispatch all queued up contact points
+	_dispatchContacts();
+
+	//! Input which came in while stepping
+	_applyInput();
+}
+
+void World::_applyInput( void )
+{
+	if( mInput.isEmpty() )
+		return;
+
+	InputArray::const_iterator lIt	= mInput.constBegin();
+	InputArray::const_iterator lEnd	= mInput.constEnd();
+
+	for( ; lIt!= lEnd; ++lIt )
+	{
+		switch( lIt->mType )
+		{
+		case t_input::I_MOVE: _moveActor(lIt->mX,lIt->mY); break;
+		case t_input::I_DROP: _dropActor(); break;
+		}
+	}
+
+	mInput.clear();
+}
+
+Actor *World::_findActor( const QString &pName ) const
+{
+	NameTable &lNames = NameTable::getInstance();
+
+	// as given first, then as a unique name
+	t_name lName = lNames.find(pName);
+	Actor *lActor = (lName)?mActorIndex.value(lName):0;
+
+	if( !lActor && (lName = lNames.findUnique(pName)) )
+		lActor = mActorIndex.value(lName);
+
+	return lActor;
+}
+
+void World::_releaseAll( void )
+{
+	// Joint wrappers (b2Joints stay, they go with the world)
+	for(int i=0;i<mJointSlots.size();i++)
+	{
+		ActorJoint *lJoint = mJointSlots[i].mJoint;
+		if( !lJoint )
+			continue;
+
+		if( lJoint->getJoint() )
+			lJoint->getJoint()->SetUserData(0);
+
+		lJoint->release();
+		delete lJoint;
+	}
+
+	if( mGround )
+		mGround->mJoints.clear();
+
+	// Mouse joint goes as well
+	mMouseJoint = 0;
+	mActor = 0;
+	mInput.clear();
+
+	// Actors without bodies skip all PhysX clean-up
+	ActorArray::iterator lIt	= mActors.begin();
+	ActorArray::iterator lEnd	= mActors.end();
+
+	for( ; lIt!= lEnd; ++lIt )
+	{
+		Actor *lActor = (*lIt);
+
+		lActor->mJoints.clear();
+		lActor->setBody(0);
+
+		delete lActor;
+	}
+
+	// same for the ones waiting for removal
+	QVector<Actor *>::const_iterator lRIt	= mRemoved.constBegin();
+	QVector<Actor *>::const_iterator lREnd	= mRemoved.constEnd();
+
+	for( ; lRIt!= lREnd; ++lRIt )
+	{
+		(*lRIt)->mJoints.clear();
+		(*lRIt)->setBody(0);
+
+		delete (*lRIt);
+	}
+
+	for( lRIt = mRetired.constBegin(), lREnd = mRetired.constEnd(); lRIt!= lREnd; ++lRIt )
+	{
+		(*lRIt)->mJoints.clear();
+		(*lRIt)->setBody(0);
+
+		delete (*lRIt);
+	}
+
+	mRetired.clear();
+	_clearRecycled(false);
+
+	mActors.clear();
+	mTransforms.clear();
+	mContacts.clear();
+	mRemoved.clear();
+
+	_clearRegistry();
+}
+
+void World::_registerActor( Actor *pActor )
+{
+	Q_ASSERT( pActor != 0 );
+	Q_ASSERT( !pActor->mHandle );
+
+	int lIndex;
+
+	if( mFreeSlots.isEmpty() )
+	{
+		t_slot lSlot = { 0, 1, -1 };
+
+		lIndex = mSlots.size();
+		mSlots.push_back(lSlot);
+	}
+	else
+	{
+		lIndex = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+
+	t_slot &lSlot = mSlots[lIndex];
+	lSlot.mActor = pActor;
+
+	// updated last
+	lSlot.mOrder = mActors.size();
+	mActors.push_back(pActor);
+
+	// the hot data moves next to the other actors'
+	Actor::t_hot *lHot = _getHot(lIndex);
+	*lHot = *pActor->mHot;
+	pActor->mHot = lHot;
+
+	pActor->mHandle = ((t_handle)lSlot.mGeneration << 32) | (t_handle)lIndex;
+
+	mActorIndex.insertMulti(pActor->mNameId,pActor);
+
+	// goes on top of everything with the same Z-Order
+	pActor->mDrawSeq = mDrawSeq++;
+
+	t_drawKey lKey = { pActor->getZOrder(), pActor->mDrawSeq };
+	mDrawOrder.insert(lKey,pActor);
+
+	// goes into the culling grid on the next render()
+	pActor->_invalidateBounds();
+}
+
+bool World::_unregisterActor( Actor *pActor )
+{
+	Q_ASSERT( pActor != 0 );
+
+	if( findActor<Actor>(pActor->mHandle) != pActor )
+		return false;
+
+	const int lIndex = (int)(pActor->mHandle & 0xFFFFFFFF);
+
+	// invalidate all outstanding handles
+	t_slot &lSlot = mSlots[lIndex];
+	lSlot.mActor = 0;
+	lSlot.mGeneration++;
+
+	if( !lSlot.mGeneration ) // never hand out a 0 handle
+		lSlot.mGeneration = 1;
+
+	mFreeSlots.push_back(lIndex);
+	pActor->mHandle = 0;
+
+	_gridRemove(pActor);
+	pActor->mGridDirty = false;
+
+	// and back into the actor
+	Actor::t_hot *lHot = pActor->mHot;
+	pActor->mLocal = *lHot;
+	pActor->mHot = &pActor->mLocal;
+
+	lHot->mActor = 0;
+	lHot->mBody = 0;
+
+	// only this actor, there might be others with the same name
+	ActorIndex::iterator lIt = mActorIndex.find(pActor->mNameId);
+	for( ; lIt != mActorIndex.end() && lIt.key() == pActor->mNameId; ++lIt )
+	{
+		if( lIt.value() == pActor )
+		{
+			mActorIndex.erase(lIt);
+			break;
+		}
+	}
+
+	t_drawKey lKey = { pActor->getZOrder(), pActor->mDrawSeq };
+	mDrawOrder.remove(lKey);
+
+	return true;
+}
+
+void World::_renameActor( Actor *pActor, t_name pName )
+{
+	Q_ASSERT( pActor != 0 );
+
+	ActorIndex::iterator lIt = mActorIndex.find(pActor->mNameId);
+	for( ; lIt != mActorIndex.end() && lIt.key() == pActor->mNameId; ++lIt )
+	{
+		if( lIt.value() == pActor )
+		{
+			mActorIndex.erase(lIt);
+			break;
+		}
+	}
+
+	mActorIndex.insertMulti(pName,pActor);
+}
+
+void World::_reorderActor( Actor *pActor, float pZ )
+{
+	Q_ASSERT( pActor != 0 );
+
+	t_drawKey lKey = { pActor->getZOrder(), pActor->mDrawSeq };
+
+	if( lKey.mZ == pZ )
+		return;
+
+	mDrawOrder.remove(lKey);
+
+	lKey.mZ = pZ;
+	mDrawOrder.insert(lKey,pActor);
+}
+
+void World::_clearRegistry( void )
+{
+	// every outstanding handle goes stale
+	mFreeSlots.clear();
+
+	for(int i=0;i<mSlots.size();i++)
+	{
+		t_slot &lSlot = mSlots[i];
+
+		if( lSlot.mActor )
+		{
+			Actor::t_hot *lHot = _getHot(i);
+			lHot->mActor = 0;
+			lHot->mBody = 0;
+
+			lSlot.mActor = 0;
+			lSlot.mGeneration++;
+
+			if( !lSlot.mGeneration )
+				lSlot.mGeneration = 1;
+		}
+
+		mFreeSlots.push_back(i);
+	}
+
+	mActorIndex.clear();
+	mDrawOrder.clear();
+
+	mGrid.clear();
+	mGridLarge.clear();
+	mGridDirty.clear();
+}
+
+Actor::t_hot *World::_getHot( int pIndex )
+{
+	Q_ASSERT( pIndex >= 0 );
+
+	while( pIndex >= mHot.size() * WORLD_POOL_CHUNK )
+	{
+		Actor::t_hot *lChunk = new Actor::t_hot[WORLD_POOL_CHUNK];
+		memset(lChunk,0,sizeof(Actor::t_hot) * WORLD_POOL_CHUNK);
+
+		mHot.push_back(lChunk);
+	}
+
+	return &mHot[pIndex / WORLD_POOL_CHUNK][pIndex % WORLD_POOL_CHUNK];
+}
+
+void World::_pullTransforms( void )
+{
+	//! only bodies which moved, static and sleeping ones cost nothing
+	b2Body **lBodies = mWorld->GetMovedBodies();
+	const int lCount = mWorld->GetMovedBodyCount();
+
+	for(int i=0;i<lCount;i++)
+	{
+		Actor *lActor = static_cast<Actor *>(lBodies[i]->GetUserData());
+
+		if( !lActor )
+			continue;
+
+		b2Vec2 lPos = lBodies[i]->GetPosition();
+		_pullTransform(lActor,W2S_(lPos.x),W2S_(lPos.y),R2D(lBodies[i]->GetAngle()));
+	}
+}
+
+void World::_pullTransform( Actor *pActor, float pX, float pY, float pRot )
+{
+	Actor::t_hot *lHot = pActor->mHot;
+
+	if( lHot->mFlags & Actor::U_NOUPDATE )
+		return;
+
+	// same as Actor::update() would do
+	lHot->mPos[0] = lHot->mDPos[0] = pX;
+	lHot->mPos[1] = lHot->mDPos[1] = pY;
+	lHot->mRot = pRot;
+}
+
+void World::_registerJoint( ActorJoint *pJoint )
+{
+	Q_ASSERT( pJoint != 0 );
+	Q_ASSERT( !pJoint->mHandle );
+
+	int lIndex;
+
+	if( mFreeJointSlots.isEmpty() )
+	{
+		t_jointSlot lSlot = { 0, 1 };
+
+		lIndex = mJointSlots.size();
+		mJointSlots.push_back(lSlot);
+	}
+	else
+	{
+		lIndex = mFreeJointSlots.back();
+		mFreeJointSlots.pop_back();
+	}
+
+	t_jointSlot &lSlot = mJointSlots[lIndex];
+	lSlot.mJoint = pJoint;
+
+	pJoint->mHandle = ((t_handle)lSlot.mGeneration << 32) | (t_handle)lIndex;
+
+	mJointIndex.insertMulti(pJoint->mNameId,pJoint);
+}
+
+void World::_unregisterJoint( ActorJoint *pJoint )
+{
+	Q_ASSERT( pJoint != 0 );
+
+	if( findJoint(pJoint->mHandle) != pJoint )
+		return;
+
+	const int lIndex = (int)(pJoint->mHandle & 0xFFFFFFFF);
+
+	// invalidate all outstanding handles
+	t_jointSlot &lSlot = mJointSlots[lIndex];
+	lSlot.mJoint = 0;
+	lSlot.mGeneration++;
+
+	if( !lSlot.mGeneration )
+		lSlot.mGeneration = 1;
+
+	mFreeJointSlots.push_back(lIndex);
+	pJoint->mHandle = 0;
+
+	JointIndex::iterator lIt = mJointIndex.find(pJoint->mNameId);
+	for( ; lIt != mJointIndex.end() && lIt.key() == pJoint->mNameId; ++lIt )
+	{
+		if( lIt.value() == pJoint )
+		{
+			mJointIndex.erase(lIt);
+			break;
+		}
+	}
+}
+
+void World::_renameJoint( ActorJoint *pJoint, t_name pName )
+{
+	Q_ASSERT( pJoint != 0 );
+
+	JointIndex::iterator lIt = mJointIndex.find(pJoint->mNameId);
+	for( ; lIt != mJointIndex.end() && lIt.key() == pJoint->mNameId; ++lIt )
+	{
+		if( lIt.value() == pJoint )
+		{
+			mJointIndex.erase(lIt);
+			break;
+		}
+	}
 
-	return lEnd;
+	mJointIndex.insertMulti(pName,pJoint);
 }
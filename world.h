@@ -38,26 +38,28 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 #include <QtCore/QList>
+#include <QtCore/QVector>
 #include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QTime>
+#include <QtCore/QByteArray>
+#include <QtCore/QDebug>
 
 #include "Box2D/Box2D.h"
 
 #include "actor.h"
 #include "actorjoint.h"
+#include "prefab.h"
+#include "physicsthread.h"
+#include "contactbuffer.h"
+#include "spritebatch.h"
 
 namespace GL {
 
 class ActorJoint;
 
-struct ContactPoint
-{
-	Actor *mActor1;
-	Actor *mActor2;
-
-	t_point mPos;
-};
-
 class World : public QObject, private b2ContactListener
 {
 	Q_OBJECT
@@ -66,26 +68,78 @@ public:
 	World();
 	virtual ~World();
 
+	// b2ContactListener
 	void Add(const b2ContactPoint *pPoint);
+	void Persist(const b2ContactPoint *pPoint);
+	void Remove(const b2ContactPoint *pPoint);
+	void Result(const b2ContactResult *pResult);
+
+	//! Contact events delivered by onContacts()
+	/*!
+		pTypes is a mask of ContactEvent::t_type bits
+		(E_BEGIN | E_END by default), pFlags limits the
+		events to actors having any of these flags (0 = all).
+	*/
+	virtual void setContactTypes( int pTypes );
+	virtual void setContactFilter( unsigned long pFlags );
+
+	//! Collision layers
+	/*!
+		Up to WORLD_MAX_LAYERS named layers, one per Box2D
+		category bit, layer 0 ("Default") always exists.
+
+		Every pair of layers collides unless turned off with
+		setLayersCollide(), actors on layers which don't collide
+		are rejected by the broadphase filter before a contact
+		is ever allocated.
+	*/
+	virtual int addLayer( const QString &pName );
+	virtual int getLayer( const QString &pName ) const;
+	virtual QString getLayerName( int pLayer ) const;
+
+	virtual void setLayersCollide( int pLayer1, int pLayer2, bool pCollide );
+	virtual void setLayersCollide( const QString &pLayer1, const QString &pLayer2, bool pCollide );
+	virtual bool layersCollide( int pLayer1, int pLayer2 ) const;
+
+	//! Box2D filter of an actor on pLayer
+	virtual void getLayerFilter( int pLayer, b2FilterData *pFilter ) const;
+	//! Re-apply the layer filter to the shapes of an actor
+	virtual void refilterActor( Actor *pActor );
 
 	virtual void setGravity( float pX, float pY );
 	virtual void setGravity( float pY );
 
+	//! pUnique gives it a fresh serial, "Leaf" becomes "Leaf_12"
 	template <typename T>
 	T *createActor( const QString &pName, bool pUnique = false )
 	{
 		Q_ASSERT( !pName.isEmpty() );
 
-		QString lName = pName;
+		t_name lName = NameTable::getInstance().intern(pName);
 
 		if( pUnique )
-			lName = _getUnique(pName);
+			lName = NameTable::getInstance().unique(lName);
+
+		return createActor<T>(lName);
+	}
 
-		T *lActor = new T(lName,this);
+	//! Actor with an interned name (see NameTable)
+	template <typename T>
+	T *createActor( t_name pName )
+	{
+		Q_ASSERT( pName != 0 );
+
+		// no name yet, it's interned once below
+		T *lActor = new T(QString(),this);
+		lActor->_setNameId(pName);
 		lActor->setZOrder(mZOrder);
+		lActor->mAutoZ = true;
+
+		// base and serial, the full name is only built on demand
+		qDebug() << "Success: [Actor] " << NameTable::getInstance().getBase(pName) << NameTable::getSerial(pName) << " created";
 
 		// push it
-		mActors.push_back(lActor);
+		_registerActor(lActor);
 
 		// small increment to allow a large number
 		// of objects within a relatively small range
@@ -93,35 +147,238 @@ public:
 		return static_cast<T *>(lActor);
 	}
 
+	//! Archetype spawning actors of type T (see Prefab)
+	/*!
+		Owned by the World, names are unique, asking for
+		an existing one gives back that one.
+	*/
+	template <typename T>
+	Prefab *createPrefab( const QString &pName )
+	{
+		Q_ASSERT( !pName.isEmpty() );
+
+		Prefab *lPrefab = findPrefab(pName);
+
+		if( lPrefab )
+			return lPrefab;
+
+		lPrefab = new Prefab(pName,this,&Prefab::factory<T>);
+		mPrefabs.insert(lPrefab->getNameId(),lPrefab);
+
+		return lPrefab;
+	}
+
+	//! Prefab by name, 0 if there is none
+	Prefab *findPrefab( const QString &pName ) const;
+
+	//! pCount actors of pPrefab in one go
+	/*!
+		pPositions are top left corners (screen space), each
+		actor gets a unique name after the prefab and the
+		created ones are stored in pActors (if any).
+
+		The shape definition is built once for the whole
+		batch, the broadphase proxies are created in one go
+		and the World waits for the physics worker only once
+		too. Like createActor(), each one goes on top of the
+		ones before, unless the prefab's actor was given a
+		Z-Order by hand. Returns the number of actors created.
+	*/
+	int spawn( Prefab *pPrefab, const t_point *pPositions, int pCount, Actor **pActors = 0 );
+
 	virtual void setPhysicsParams( float pTimeStep, int pIters );
 	virtual void updatePhysics( void );
 
+	//! Interpolation factor between the last two physics steps
+	/*!
+		Goes from 0 (previous step) to 1 (current step), it's
+		the portion of a time step left in the accumulator
+		after the last updatePhysics().
+	*/
+	virtual float getAlpha( void ) const { return mAlpha; }
+
+	//! Pipelined physics
+	/*!
+		When enabled the steps taken by updatePhysics() run on
+		a worker thread during the next render(), actors are
+		drawn from their own copy of the transforms meanwhile.
+
+		Mouse joint input arriving while a step is in flight is
+		queued and applied before the next step.
+	*/
+	virtual void setPipelined( bool pPipelined );
+	virtual bool isPipelined( void ) const { return (mThread); }
+
+	//! Wait for the physics worker (if any) to finish
+	virtual void sync( void );
+
+	//! Time spent in the last updatePhysics() in ms
+	virtual float getPhysicsTime( void ) const { return mPhysicsTime; }
+	//! Time spent in the last update() in ms
+	virtual float getUpdateTime( void ) const { return mUpdateTime; }
+
+	//! Box2D profile of the steps taken by the last updatePhysics()
+	/*!
+		Phase timings are summed over all the steps of the frame,
+		so a frame that didn't step at all has a zero profile.
+	*/
+	virtual const b2Profile &getProfile( void ) const { return mProfile; }
+
+	//! Actor by name
+	/*!
+		Names are expected to be unique, if not the
+		most recently created actor is returned.
+	*/
 	template <typename T>
-	T *findActor( const QString &pName )
+	T *findActor( const QString &pName ) const
 	{
-		ActorArray::iterator lActor = _findActor(pName);
+		return static_cast<T*>(_findActor(pName));
+	}
 
-		if( lActor != mActors.end() )
-			return static_cast<T*>((*lActor));
+	//! Actor by handle, 0 if it has been removed since
+	template <typename T>
+	T *findActor( t_handle pHandle ) const
+	{
+		const int lIndex = (int)(pHandle & 0xFFFFFFFF);
+		const unsigned int lGeneration = (unsigned int)(pHandle >> 32);
 
-		return 0;
+		if( lIndex >= mSlots.size() || mSlots[lIndex].mGeneration != lGeneration )
+			return 0;
+
+		return static_cast<T*>(mSlots[lIndex].mActor);
 	}
 
 	virtual bool removeActor( const QString &pName );
 	virtual bool removeActor( Actor *pActor );
 	virtual bool removeActorBody( Actor *pActor );
 
+	//! Remove an actor at the end of the next update()
+	/*!
+		Safe while iterating actors, from contact handlers and
+		while a step is in flight. The actor can't be found
+		anymore right away, it's deleted when the queue is
+		flushed, with all bodies destroyed as one batch.
+	*/
+	virtual bool removeActorLater( Actor *pActor );
+
+	//! Recycle an actor instead of removing it
+	/*!
+		Same as removeActorLater(), but the actor keeps
+		everything, its body included (inactive, out of the
+		broadphase and the solver), and waits in a bin per
+		base name ("Leaf_12" goes to "Leaf") for
+		reviveActor(). Up to WORLD_MAX_RECYCLED per name,
+		the rest is removed. update() retires frozen actors.
+	*/
+	virtual bool retireActor( Actor *pActor );
+
+	//! A retired pName actor back at pX,pY (top left), 0 if there is none
+	/*!
+		Only the transform and the velocity are reset, it
+		goes on top like a new actor and gets a new handle.
+	*/
+	template <typename T>
+	T *reviveActor( const QString &pName, float pX, float pY, float pRot = 0.0f )
+	{
+		return static_cast<T *>(_reviveActor(pName,pX,pY,pRot));
+	}
+
+	//! Actors waiting in the recycle bins
+	virtual int getRecycledCount( void ) const;
+
 	virtual void removeAll( void );
 
 	virtual void removeAllActors( bool pRemoveJoints=false );
 	virtual void removeAllJoints( void );
 
 	virtual int getCount( void ) const;
+	//! Every live actor (not the ground), in update order
+	virtual void getActors( QVector<Actor *> *pActors ) const;
+	//! Obsolete, the draw order is kept up to date by setZOrder()
 	virtual void sortByZorder( void );
 
+	//! Save the whole simulation into a flat buffer
+	/*!
+		Actor state, bodies, joints and contact impulses are
+		copied as-is, so it's cheap enough to be used every frame
+		(rollback, "what-if" stepping, instant level resets).
+	*/
+	virtual bool saveState( QByteArray *pState );
+	//! Restore a buffer written by saveState()
+	/*!
+		Only works as long as the same actors and joints are
+		around, otherwise nothing is changed and false is returned.
+		Actors are matched by handle, bodies and joints by their
+		stamp, so new ones in reused memory don't pass for old.
+	*/
+	virtual bool restoreState( const QByteArray &pState );
+
 	virtual void render( void );
 	virtual void update( void );
 
+	//! Visible part of the world (screen space)
+	/*!
+		render() only draws actors overlapping it, physical
+		ones are found through the broadphase, the others
+		through a coarse grid. Defaults to the whole screen.
+	*/
+	virtual void setViewRect( float pX, float pY, float pW, float pH );
+	virtual void getViewRect( t_rect *pRect ) const;
+
+	//! Camera
+	/*!
+		World position (screen space units) shown in the
+		middle of the screen and a zoom factor, render()
+		draws through it and moving it moves the view rect.
+		Mouse input to grabActor() & co. is in window
+		coordinates and goes through the camera as well.
+	*/
+	virtual void setCamera( float pX, float pY );
+	virtual void moveCamera( float pDX, float pDY );
+	virtual void getCamera( t_point *pPos ) const;
+	virtual void setZoom( float pZoom );
+	virtual float getZoom( void ) const { return mZoom; }
+
+	//! Window to world position (see setCamera())
+	virtual void toWorld( float pX, float pY, t_point *pPos ) const;
+
+	//! Draw everything (no culling) when turned off
+	virtual void setCulling( bool pCulling ) { mCulling = pCulling; }
+	virtual bool isCulling( void ) const { return mCulling; }
+
+	//! Actors drawn by the last render()
+	virtual int getDrawnCount( void ) const { return mDrawn; }
+	//! Same, in the order they were drawn
+	virtual void getDrawn( QVector<Actor *> *pActors ) const;
+
+	//! Sprite batching
+	/*!
+		render() queues actors into a SpriteBatch (see
+		Actor::batch()), so runs of actors sharing texture
+		and blending take a single draw call. Turned off,
+		every actor draws itself with Actor::render().
+	*/
+	virtual void setBatching( bool pBatching ) { mBatching = pBatching; }
+	virtual bool isBatching( void ) const { return mBatching; }
+
+	//! Render state sorting
+	/*!
+		Within a render layer (see Actor::setRenderLayer()),
+		consecutive opaque (B_NONE) actors may be drawn in
+		any order, so may consecutive additive (B_ONE) ones,
+		render() sorts those by texture to keep the batches
+		long. Alpha blended actors and different layers keep
+		their order, so do different Z-Orders unless the
+		actors were put on a render layer of their own.
+	*/
+	virtual void setSorting( bool pSorting ) { mSorting = pSorting; }
+	virtual bool isSorting( void ) const { return mSorting; }
+
+	//! Draw calls issued by the last render()
+	virtual int getDrawCalls( void ) const { return mDrawCalls; }
+	//! Texture binds and blend changes made by the last render()
+	virtual int getStateChanges( void ) const { return mStateChanges; }
+
 	// PhysX drag-drop
 	virtual bool grabActor(int pX, int pY);
 	virtual void moveActor(int pX, int pY);
@@ -144,6 +401,27 @@ public:
 
 	virtual b2World *getPhysicsWorld( void ) const { return mWorld;	}
 
+	//! Joint of type T (see actorjoint.h), its init() creates the physics joint
+	template <typename T>
+	T *createJoint( const QString &pName, bool pUnique = false )
+	{
+		Q_ASSERT( !pName.isEmpty() );
+
+		sync();
+
+		t_name lName = NameTable::getInstance().intern(pName);
+
+		if( pUnique )
+			lName = NameTable::getInstance().unique(lName);
+
+		T *lJoint = new T(NameTable::getInstance().getBase(lName),this);
+		lJoint->_setNameId(lName);
+		_registerJoint(lJoint);
+
+		return lJoint;
+	}
+
+	//! Revolute joints
 	ActorJoint *createJoint( const QString &pName, Actor *pA1,
 								  Actor *pA2, const float pX, const float pY,
 								  bool pUnique = false );
@@ -151,46 +429,196 @@ public:
 	ActorJoint *createJoint( const QString &pName, Actor *pA1,
 								  Actor *pA2, bool pUnique = false );
 
+	//! Joint by name, 0 if there is none
+	ActorJoint *findJoint( const QString &pName ) const;
+	//! Joint by handle, 0 if it has been removed since
+	ActorJoint *findJoint( t_handle pHandle ) const;
+
+	virtual int getJointCount( void ) const { return mJointIndex.size(); }
+
 	bool removeJoint( b2Joint *pJoint );
 
 	bool removeJoint( const QString &pName );
+	//! All joints attached to pActor
 	bool removeJoint( Actor *pActor );
 	bool removeJoint( const ActorJoint *pJoint );
 
 signals:
-	void onCollision(const ContactPoint *pContactPoint);
+	//! Contact events of a single physics step
+	/*!
+		Emitted once per step (and only for steps which
+		recorded something), the span is valid only for
+		the duration of the call.
+	*/
+	void onContacts(const ContactEvent *pEvents, int pNumEvents);
 
 protected:
 	//! Why is this a list? and not a QHash?
 	/*!
-		A QList is used here to avoid name collisions
-		and make possible sorting by Z-Order.
+		Update order only, see mDrawOrder for drawing.
 	*/
 	typedef QList<Actor *> ActorArray;
-	//! Where is the joints array?
+
+	//! Holds queued up contact events after each step()
+	ContactBuffer mContacts;
+
+	//! Actor registry
+	/*!
+		Slots hand out the handles, a slot's generation
+		is bumped whenever its actor goes away. Names
+		are indexed separately (for actors and joints).
+	*/
+	typedef struct s_slot
+	{
+		Actor *mActor;
+		unsigned int mGeneration;
+		int mOrder; // index into mActors
+	} t_slot;
+
+	typedef QVector<t_slot> SlotArray;
+	SlotArray mSlots;
+	QVector<int> mFreeSlots;
+
+	typedef QHash<t_name, Actor *> ActorIndex;
+	ActorIndex mActorIndex;
+
+	typedef QHash<t_name, ActorJoint *> JointIndex;
+	JointIndex mJointIndex;
+
+	typedef QHash<t_name, Prefab *> PrefabIndex;
+	PrefabIndex mPrefabs;
+
+	//! Joint registry, same scheme as the actor slots
+	typedef struct s_jointSlot
+	{
+		ActorJoint *mJoint;
+		unsigned int mGeneration;
+	} t_jointSlot;
+
+	QVector<t_jointSlot> mJointSlots;
+	QVector<int> mFreeJointSlots;
+
+	//! Hot actor data (see Actor::t_hot)
 	/*!
-	  Because we don't draw or update joints "manually"
-	  there is no reason to mantain another array of pointers,
-	  so the internal b2World joint list is used.
+		One block per registry slot, allocated in chunks
+		which never move, so actors can point right into
+		them. Nothing walks them in slot order, the loops
+		go through the moved bodies or the actors.
 	*/
+	typedef QVector<Actor::t_hot *> HotChunks;
+	HotChunks mHot;
 
-	//! Holds queued up contact points after each step()
-	typedef QList<ContactPoint *> ContactArray;
+	//! Draw order
+	/*!
+		Actors by (Z-Order, creation sequence), inserting,
+		removing or moving an actor is O(log n) and render()
+		just walks the map, so there's nothing left to sort.
+	*/
+	typedef struct s_drawKey
+	{
+		float mZ;
+		unsigned int mSeq;
+
+		bool operator<( const s_drawKey &pOther ) const
+		{
+			if( mZ != pOther.mZ )
+				return (mZ < pOther.mZ);
+
+			return (mSeq < pOther.mSeq);
+		}
+	} t_drawKey;
 
-	ContactArray mContacts;
-	unsigned short mNumContacts;
+	typedef QMap<t_drawKey, Actor *> DrawOrder;
+	DrawOrder mDrawOrder;
+	unsigned int mDrawSeq;
+
+	//! Actors waiting for removal (see removeActorLater())
+	QVector<Actor *> mRemoved;
+
+	//! Actors waiting to be recycled (see retireActor())
+	QVector<Actor *> mRetired;
+
+	//! Retired actors by base name
+	typedef QHash<t_name, QVector<Actor *> > RecycleBin;
+	RecycleBin mRecycled;
+
+	//! Layer names and which layers each of them collides with
+	QStringList mLayers;
+	uint16 mLayerMasks[WORLD_MAX_LAYERS];
 
 protected:
-	virtual void _allocContacts(unsigned short pNumContacts);
 	virtual void _resetContacts( void );
 	virtual void _dispatchContacts( void );
-	virtual void _deallocContacts( void );
 
 protected:
-	virtual QString _getUnique( const QString &pName );
-	virtual bool _removeJointData( b2Joint *pJoint );
+	virtual void _updatePhysics( void );
+	virtual void _update( void );
+	virtual void _flushRemoved( void );
+
+	virtual float _getElapsed( void );
+	virtual void _storeTransforms( void );
 
-	virtual ActorArray::iterator _findActor(const QString &pName);
+	virtual void _startStep( void );
+	virtual void _finishStep( void );
+
+	virtual bool _grabActor(float pX, float pY); // world position
+	virtual void _moveActor(float pX, float pY);
+	virtual void _dropActor(void);
+	virtual void _applyInput( void );
+
+protected:
+	//! Name index lookups, "Base_12" is tried as a unique name as well
+	virtual Actor *_findActor( const QString &pName ) const;
+
+	//! Delete all actors & joint wrappers
+	/*!
+		Leaves every b2Body/b2Joint in place,
+		the caller drops the physics world
+		(or clears it) in one go afterwards.
+	*/
+	virtual void _releaseAll( void );
+
+	//! Take an actor out of its recycle bin (see reviveActor())
+	virtual Actor *_reviveActor( const QString &pName, float pX, float pY, float pRot );
+	//! Delete the recycled actors, with their bodies unless the world goes too
+	virtual void _clearRecycled( bool pDestroyBodies );
+
+	//! Registry maintenance (also used by Actor & ActorJoint)
+	virtual void _registerActor( Actor *pActor );
+	virtual bool _unregisterActor( Actor *pActor );
+	virtual void _renameActor( Actor *pActor, t_name pName );
+	virtual void _renameJoint( ActorJoint *pJoint, t_name pName );
+	virtual void _reorderActor( Actor *pActor, float pZ );
+	//! Forget all actors (after deleting them in bulk)
+	virtual void _clearRegistry( void );
+
+	//! Culling maintenance (also used by Actor)
+	virtual void _invalidateActor( Actor *pActor );
+	virtual void _growCullMargin( float pMargin );
+	virtual void _gridInsert( Actor *pActor );
+	virtual void _gridRemove( Actor *pActor );
+	virtual void _updateGrid( void );
+	virtual void _cullActors( void );
+	virtual void _cullActor( Actor *pActor, bool pTest );
+
+	//! Visible actors into mQueue, sorted where the order is free (see setSorting())
+	virtual void _buildQueue( void );
+	//! Both on the same render layer (see Actor::setRenderLayer())
+	virtual bool _sameRenderLayer( const Actor *pA, const Actor *pB ) const;
+
+	//! Hot block of a registry slot (allocated on demand)
+	virtual Actor::t_hot *_getHot( int pIndex );
+	//! Copy all body transforms into the hot blocks
+	virtual void _pullTransforms( void );
+	//! Current transform of a registered body (unless U_NOUPDATE)
+	void _pullTransform( Actor *pActor, float pX, float pY, float pRot );
+
+	virtual void _registerJoint( ActorJoint *pJoint );
+	virtual void _unregisterJoint( ActorJoint *pJoint );
+
+	friend class Actor;
+	friend class ActorJoint;
+	friend class Scene;
 
 protected:
 	ActorArray mActors;
@@ -198,6 +626,39 @@ protected:
 	float mTimeStep;
 	int mIters;
 
+	//! Fixed Time Step Accumulator
+	/*!
+		Real time (in seconds) not yet consumed
+		by fixed physics steps.
+	*/
+	float mAccumulator;
+	float mAlpha;
+
+	//! Measures real time between two updatePhysics()
+	QTime mClock;
+
+	//! Pipelined PhysX (0 when stepping on the GUI thread)
+	PhysicsThread *mThread;
+	int mPendingSteps;
+	bool mStepping;
+	TransformArray mTransforms;
+
+	//! Timings (ms)
+	float mPhysicsTime;
+	float mUpdateTime;
+	b2Profile mProfile;
+
+	//! Mouse joint input queued while stepping
+	typedef struct s_input
+	{
+		enum { I_MOVE, I_DROP } mType;
+		float mX; // world position
+		float mY;
+	} t_input;
+
+	typedef QList<t_input> InputArray;
+	InputArray mInput;
+
 	//! Z-Order counter
 	/*!
 		Contains the top-level
@@ -216,6 +677,70 @@ protected:
 	Actor *mGround;
 
 	bool mDoSleep;
+
+	//! Camera
+	t_point mCamera;
+	float mZoom;
+
+	//! View rect culling
+	t_rect mViewRect;
+	bool mCulling;
+	int mDrawn;
+
+	SpriteBatch mBatch;
+	bool mBatching;
+	int mDrawCalls;
+	int mStateChanges;
+
+	//! Render queue
+	/*!
+		Sorted by a packed key, from the top bits down:
+		layer (24), blend mode (4), texture (20) and the
+		depth within the layer (16). A layer here is a run
+		of actors whose order is free, every other actor
+		gets a layer of its own.
+	*/
+	typedef struct s_renderItem
+	{
+		quint64 mKey;
+		Actor *mActor;
+
+		bool operator<( const s_renderItem &pOther ) const
+		{
+			return (mKey < pOther.mKey);
+		}
+	} t_renderItem;
+
+	QVector<t_renderItem> mQueue;
+	bool mSorting;
+
+	//! Bumped by every culled render()
+	unsigned int mCullStamp;
+	//! How far sprites stick out of their shapes at most
+	float mCullMargin;
+
+	QVector<b2Shape *> mCullShapes;
+
+	typedef struct s_drawItem
+	{
+		t_drawKey mKey;
+		Actor *mActor;
+
+		bool operator<( const s_drawItem &pOther ) const
+		{
+			return (mKey < pOther.mKey);
+		}
+	} t_drawItem;
+
+	QVector<t_drawItem> mVisible;
+
+	//! Non-physical actors by WORLD_CULL_CELL sized cells
+	typedef QHash<quint32, QVector<Actor *> > CullGrid;
+	CullGrid mGrid;
+	//! Too big for the grid, always tested
+	QVector<Actor *> mGridLarge;
+	//! Moved since the last render()
+	QVector<t_handle> mGridDirty;
 };
 
 /* GL */ }